@@ -15,12 +15,19 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <future>
+#include <memory>
+#include <chrono>
 #include "src/MagnetParser.h"
 #include "src/DHTClient.h"
 #include "src/PeerDiscovery.h"
 #include "src/PeerConnection.h"
 #include "src/DownloadTorrent.h"
 #include "src/TorrentUtilities.h"
+#include "src/HostResolver.h"
+#include "src/PeerCandidatePool.h"
+#include "src/PeerQualityCache.h"
+#include "src/PeerConnectionManager.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -28,6 +35,9 @@
 #include <unistd.h>
 #endif
 
+#define MAX_PEX_CONNECTIONS 8               //!> Connections used for peer exchange.
+#define PEX_WINDOW std::chrono::seconds(15) //!> How long each of them swaps peer lists.
+
 /*!
     \brief URL decodes a given string.
     \param url The URL-encoded string.
@@ -90,35 +100,89 @@ void processMagnetLink(const std::string &magnetLink)
         {
             std::cout << tracker << std::endl;
         }
+        HostResolver::shared().prefetch(metadata.getTrackers()); //* Resolve tracker hosts while the DHT runs
 
         // Step 2: Discover Peers
-        PeerDiscovery peerDiscovery(metadata.getInfoHash());
-        std::vector<std::string> discoveredPeers = peerDiscovery.discoverPeers();
+        PeerDiscovery peerDiscovery(metadata.getInfoHash(), metadata.getTrackers());
+        std::vector<PeerEndpoint> discoveredPeers = peerDiscovery.discoverPeers();
 
         std::cout << "Discovered " << discoveredPeers.size() << " peers for connection." << std::endl;
 
-        int successfulConnections = 0;
-        for (const auto &peer : discoveredPeers)
+        //* Connects run concurrently and the sessions stay open for the downloader. Every session
+        //* swaps peer lists with us (ut_pex) for as long as it lives, into this pool (declared
+        //* before the sessions, so it outlives them); a few get a window to do only that first,
+        //* and what they advertise is connected to in the next round
+        PeerCandidatePool &candidates = peerDiscovery.candidates();
+        PeerQualityCache &quality = PeerQualityCache::shared();
+        size_t pruned = candidates.rank(quality); //* Peers that served us before go first; ones that keep failing are dropped
+        if (pruned > 0)
         {
-            PeerConnection connection(peer, metadata);
-            if (connection.connectToPeer())
+            std::cout << "Skipping " << pruned << " peers that failed on earlier attempts." << std::endl;
+        }
+
+        auto connections = std::make_shared<PeerConnectionManager>(metadata);
+        std::vector<std::future<void>> exchanges;
+        PeerEndpointSet exchanged;
+        size_t successfulConnections = 0;
+        while (true)
+        {
+            successfulConnections += connections->connect(candidates);
+
+            std::vector<std::shared_ptr<PeerConnection>> skipped;
+            while (exchanged.size() < MAX_PEX_CONNECTIONS)
+            {
+                std::shared_ptr<PeerConnection> session = connections->acquire(std::chrono::milliseconds(0));
+                if (!session)
+                {
+                    break;
+                }
+                if (!session->supportsExtensions() || !exchanged.insert(session->endpoint()))
+                {
+                    skipped.push_back(session);
+                    continue;
+                }
+
+                PeerEndpoint peer = session->endpoint();
+                exchanges.push_back(std::async(std::launch::async, [session, peer, &candidates, connections]()
+                                               {
+                    bool healthy = true;
+                    try
+                    {
+                        size_t learned = session->exchangePeers(candidates, PEX_WINDOW);
+                        std::cout << "Peer exchange with " << peer.toString() << " added " << learned << " peers." << std::endl;
+                    }
+                    catch (const std::exception &ex)
+                    {
+                        std::cerr << "Peer exchange with " << peer.toString() << " ended: " << ex.what() << std::endl;
+                        healthy = false;
+                    }
+                    connections->release(session, healthy); }));
+            }
+            for (const auto &session : skipped)
+            {
+                connections->release(session, true);
+            }
+
+            if (exchanges.empty())
             {
-                std::cout << "Connected to peer: " << peer << std::endl;
-                successfulConnections++;
+                break;
             }
-            else
+            for (auto &exchange : exchanges)
             {
-                std::cerr << "Failed to connect to peer: " << peer << std::endl;
+                exchange.wait();
             }
+            exchanges.clear();
+            candidates.rank(quality); //* Order what peer exchange brought in before the next round
         }
 
+        std::cout << "Connected to " << successfulConnections << " peers; " << connections->sessionCount() << " sessions open." << std::endl;
         if (successfulConnections == 0)
         {
             std::cerr << "Warning: No successful peer connections." << std::endl;
         }
 
         // Step 3: Download Torrent
-        DownloadTorrent download(metadata);
+        DownloadTorrent download(metadata, connections);
         download.startDownload();
 
         std::cout << "Download started!" << std::endl;
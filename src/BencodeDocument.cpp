@@ -0,0 +1,318 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeDocument.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 9:12:48
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "BencodeDocument.h"
+#include "BencodeScanner.h"
+#include <stdexcept>
+#include <limits>
+
+/*!
+    \brief Parses bencoded data into a flat tape of nodes that reference the buffer.
+    \param data The bencoded data.
+    \throws std::runtime_error on malformed or truncated input.
+*/
+void BencodeDocument::parse(std::string_view data)
+{
+    source = std::string_view();
+    tape.clear();
+    openContainers.clear();
+    consumed = 0;
+
+    if (data.size() > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Bencoded data too large");
+
+    const char *base = data.data();
+    const size_t size = data.size();
+    size_t index = 0;
+
+    do
+    {
+        if (index >= size)
+            throw std::runtime_error("Unexpected end of bencoded data");
+
+        char c = base[index];
+
+        if (!openContainers.empty())
+        {
+            OpenContainer &parent = openContainers.back();
+            bool inDictionary = tape[parent.tapeIndex].type == BencodeType::Dictionary;
+
+            if (c == 'e')
+            {
+                if (inDictionary && (parent.children % 2) != 0)
+                    throw std::runtime_error("Dictionary key without value");
+
+                BencodeNode &container = tape[parent.tapeIndex];
+                container.length = static_cast<uint32_t>(index + 1 - container.offset);
+                container.next = static_cast<uint32_t>(tape.size());
+                container.count = inDictionary ? parent.children / 2 : parent.children;
+                openContainers.pop_back();
+                index++; //!> Skip 'e'
+                continue;
+            }
+
+            if (inDictionary && (parent.children % 2) == 0 && (c < '0' || c > '9'))
+                throw std::runtime_error("Dictionary key must be a string");
+
+            parent.children++;
+        }
+
+        uint32_t nodeIndex = static_cast<uint32_t>(tape.size());
+
+        if (c >= '0' && c <= '9')
+        {
+            //* Length prefix, then raw bytes
+            size_t digits = BencodeScanner::countDigits(base + index, base + size);
+            if (digits > 19)
+                throw std::runtime_error("String length exceeds data size");
+            if (digits > 1 && c == '0')
+                throw std::runtime_error("Leading zero in string length");
+            uint64_t length = 0;
+            for (size_t end = index + digits; index < end; ++index)
+                length = length * 10 + static_cast<uint64_t>(base[index] - '0');
+            if (index >= size || base[index] != ':')
+                throw std::runtime_error("Malformed bencoded string");
+            index++; //!> Skip ':'
+
+            if (length > size - index)
+                throw std::runtime_error("String length exceeds data size");
+
+            tape.push_back({BencodeType::String, static_cast<uint32_t>(index), static_cast<uint32_t>(length), nodeIndex + 1, 0});
+            index += static_cast<size_t>(length);
+        }
+        else if (c == 'i')
+        {
+            size_t digitsStart = ++index; //!> Skip 'i'
+            if (index < size && base[index] == '-')
+                index++;
+            size_t firstDigit = index;
+            index += BencodeScanner::countDigits(base + index, base + size);
+            if (index >= size || base[index] != 'e')
+                throw std::runtime_error("Integer not properly terminated");
+            if (index == firstDigit || index - firstDigit > 19)
+                throw std::runtime_error("Malformed bencoded integer");
+            if (base[firstDigit] == '0' && (index - firstDigit > 1 || firstDigit != digitsStart))
+                throw std::runtime_error("Non-canonical bencoded integer");
+
+            tape.push_back({BencodeType::Integer, static_cast<uint32_t>(digitsStart), static_cast<uint32_t>(index - digitsStart), nodeIndex + 1, 0});
+            index++; //!> Skip 'e'
+        }
+        else if (c == 'd' || c == 'l')
+        {
+            if (openContainers.size() >= MAX_DEPTH)
+                throw std::runtime_error("Bencoded data nested too deeply");
+
+            BencodeType type = (c == 'd') ? BencodeType::Dictionary : BencodeType::List;
+            tape.push_back({type, static_cast<uint32_t>(index), 0, 0, 0});
+            openContainers.push_back({nodeIndex, 0});
+            index++; //!> Skip 'd' / 'l'
+        }
+        else
+        {
+            throw std::runtime_error("Unsupported bencoded format");
+        }
+    } while (!openContainers.empty());
+
+    source = data.substr(0, index);
+    consumed = index;
+}
+
+/*!
+    \brief Parses only the value at a dictionary key path.
+    \param data The bencoded data.
+    \param path The keys to follow from the top-level dictionary, outermost first.
+    \return False if a key is missing (the document is left empty).
+    \throws std::runtime_error on malformed or truncated input.
+*/
+bool BencodeDocument::parse(std::string_view data, std::initializer_list<std::string_view> path)
+{
+    source = std::string_view();
+    tape.clear();
+    consumed = 0;
+
+    scanner.scan(data);
+    std::string_view value = scanner.find(path);
+    if (value.empty())
+        return false;
+    parse(value);
+    return true;
+}
+
+/*!
+    \brief Get the top-level value.
+    \return The root value, or an invalid handle if nothing has been parsed.
+*/
+BencodeValue BencodeDocument::root() const
+{
+    if (tape.empty())
+        return BencodeValue();
+    return BencodeValue(this, 0);
+}
+
+const BencodeNode &BencodeValue::node() const
+{
+    return document->tape[index];
+}
+
+/*!
+    \brief Get the kind of value the handle points to.
+    \return The value type.
+*/
+BencodeType BencodeValue::type() const
+{
+    return node().type;
+}
+
+/*!
+    \brief Get the bytes of a string node as a view into the source buffer.
+    \return The string bytes, or an empty view if this is not a string.
+*/
+std::string_view BencodeValue::asString() const
+{
+    if (!isString())
+        return std::string_view();
+    const BencodeNode &n = node();
+    return document->source.substr(n.offset, n.length);
+}
+
+/*!
+    \brief Get the value of an integer node.
+    \param fallback The value returned if this is not an integer.
+    \return The integer value.
+*/
+int64_t BencodeValue::asInteger(int64_t fallback) const
+{
+    if (!isInteger())
+        return fallback;
+
+    const BencodeNode &n = node();
+    const char *digits = document->source.data() + n.offset;
+    const char *end = digits + n.length;
+    bool negative = (*digits == '-');
+    if (negative)
+        digits++;
+
+    uint64_t magnitude = 0; //!> At most 19 digits, so this cannot wrap
+    for (; digits < end; ++digits)
+        magnitude = magnitude * 10 + static_cast<uint64_t>(*digits - '0');
+
+    if (negative)
+        return magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1 ? fallback : static_cast<int64_t>(0 - magnitude);
+    return magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) ? fallback : static_cast<int64_t>(magnitude);
+}
+
+/*!
+    \brief Get the full encoded form of this value.
+    \return A view into the source buffer.
+*/
+std::string_view BencodeValue::raw() const
+{
+    if (!isValid())
+        return std::string_view();
+
+    const BencodeNode &n = node();
+    switch (n.type)
+    {
+    case BencodeType::Integer:
+        return document->source.substr(n.offset - 1, n.length + 2); //!> Include 'i' and 'e'
+    case BencodeType::String:
+    {
+        size_t prefix = 1; //!> Length prefixes are canonical, so their width follows from the length
+        for (uint32_t length = n.length; length >= 10; length /= 10)
+            prefix++;
+        size_t start = n.offset - 1 - prefix;
+        return document->source.substr(start, n.offset + n.length - start);
+    }
+    default:
+        return document->source.substr(n.offset, n.length);
+    }
+}
+
+/*!
+    \brief Number of list elements or dictionary pairs.
+    \return The child count, or 0 for scalars.
+*/
+size_t BencodeValue::size() const
+{
+    return isValid() ? node().count : 0;
+}
+
+/*!
+    \brief Look up a key in a dictionary.
+    \param key The key to find.
+    \return The value, or an invalid handle if missing or not a dictionary.
+*/
+BencodeValue BencodeValue::find(std::string_view key) const
+{
+    if (!isDictionary())
+        return BencodeValue();
+
+    const std::vector<BencodeNode> &tape = document->tape;
+    uint32_t end = tape[index].next;
+    uint32_t child = index + 1;
+    while (child < end)
+    {
+        const BencodeNode &keyNode = tape[child];
+        if (keyNode.length == key.size() && document->source.compare(keyNode.offset, keyNode.length, key) == 0)
+            return BencodeValue(document, child + 1);
+        child = tape[child + 1].next;
+    }
+    return BencodeValue();
+}
+
+/*!
+    \brief Get a list element by position.
+    \param position The element index.
+    \return The element, or an invalid handle if out of range or not a list.
+*/
+BencodeValue BencodeValue::at(size_t position) const
+{
+    if (!isList() || position >= node().count)
+        return BencodeValue();
+
+    uint32_t child = index + 1;
+    while (position-- > 0)
+        child = document->tape[child].next;
+    return BencodeValue(document, child);
+}
+
+BencodeValue::Iterator BencodeValue::begin() const
+{
+    if (!isList() && !isDictionary())
+        return end();
+    return Iterator(document, index + 1, isDictionary());
+}
+
+BencodeValue::Iterator BencodeValue::end() const
+{
+    uint32_t last = isValid() && (isList() || isDictionary()) ? node().next : index;
+    return Iterator(document, last, isDictionary());
+}
+
+BencodeValue BencodeValue::Iterator::operator*() const
+{
+    return BencodeValue(document, pairs ? index + 1 : index);
+}
+
+std::string_view BencodeValue::Iterator::key() const
+{
+    if (!pairs)
+        return std::string_view();
+    const BencodeNode &keyNode = document->tape[index];
+    return document->source.substr(keyNode.offset, keyNode.length);
+}
+
+BencodeValue::Iterator &BencodeValue::Iterator::operator++()
+{
+    index = document->tape[pairs ? index + 1 : index].next;
+    return *this;
+}
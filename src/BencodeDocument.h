@@ -0,0 +1,212 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeDocument.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 9:12:40
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef BENCODE_DOCUMENT_H
+#define BENCODE_DOCUMENT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <initializer_list>
+#include <cstdint>
+#include <cstddef>
+#include "BencodeScanner.h"
+
+enum class BencodeType : uint8_t
+{
+    Integer,
+    String,
+    List,
+    Dictionary
+};
+
+/*!
+    \brief A single entry on the document tape.
+    Containers are followed by their children; `next` is the tape index just past the subtree,
+    so a whole value can be skipped in O(1). Dictionary children alternate key, value.
+*/
+struct BencodeNode
+{
+    BencodeType type; //!> Kind of value.
+    uint32_t offset;  //!> Payload start (string bytes, integer digits, or the 'd'/'l' marker).
+    uint32_t length;  //!> Payload length (containers: full encoded length including 'e').
+    uint32_t next;    //!> Tape index just past this node's subtree.
+    uint32_t count;   //!> Number of direct children (dictionary: number of key/value pairs).
+};
+
+class BencodeDocument;
+
+/*!
+    \brief Lightweight handle to a node inside a BencodeDocument.
+    Handles are only valid while the document and its source buffer are alive and unchanged.
+*/
+class BencodeValue
+{
+public:
+    class Iterator;
+
+    BencodeValue() = default;
+
+    /*!
+        \brief Check whether the handle points to a node.
+        \return False for missing keys and out-of-range lookups.
+    */
+    bool isValid() const { return document != nullptr; }
+    explicit operator bool() const { return isValid(); }
+
+    BencodeType type() const;
+    bool isInteger() const { return isValid() && type() == BencodeType::Integer; }
+    bool isString() const { return isValid() && type() == BencodeType::String; }
+    bool isList() const { return isValid() && type() == BencodeType::List; }
+    bool isDictionary() const { return isValid() && type() == BencodeType::Dictionary; }
+
+    /*!
+        \brief Get the bytes of a string node as a view into the source buffer.
+        \return The string bytes, or an empty view if this is not a string.
+    */
+    std::string_view asString() const;
+
+    /*!
+        \brief Get the value of an integer node.
+        \param fallback The value returned if this is not an integer.
+        \return The integer value.
+    */
+    int64_t asInteger(int64_t fallback = 0) const;
+
+    /*!
+        \brief Get the full encoded form of this value (e.g. the raw `info` dictionary for hashing).
+        \return A view into the source buffer.
+    */
+    std::string_view raw() const;
+
+    /*!
+        \brief Number of list elements or dictionary pairs.
+        \return The child count, or 0 for scalars.
+    */
+    size_t size() const;
+
+    /*!
+        \brief Look up a key in a dictionary.
+        \param key The key to find.
+        \return The value, or an invalid handle if missing or not a dictionary.
+    */
+    BencodeValue find(std::string_view key) const;
+    BencodeValue operator[](std::string_view key) const { return find(key); }
+
+    /*!
+        \brief Get a list element by position.
+        \param position The element index.
+        \return The element, or an invalid handle if out of range or not a list.
+    */
+    BencodeValue at(size_t position) const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    friend class BencodeDocument;
+    BencodeValue(const BencodeDocument *document, uint32_t index) : document(document), index(index) {}
+
+    const BencodeNode &node() const;
+
+    const BencodeDocument *document = nullptr; //!> Owning document.
+    uint32_t index = 0;                        //!> Tape index of the node.
+};
+
+/*!
+    \brief Iterates the children of a list, or the pairs of a dictionary.
+    For dictionaries `*it` is the value and `key()` the key.
+*/
+class BencodeValue::Iterator
+{
+public:
+    BencodeValue operator*() const;
+    std::string_view key() const;
+    Iterator &operator++();
+    bool operator==(const Iterator &other) const { return index == other.index; }
+    bool operator!=(const Iterator &other) const { return index != other.index; }
+
+private:
+    friend class BencodeValue;
+    Iterator(const BencodeDocument *document, uint32_t index, bool pairs) : document(document), index(index), pairs(pairs) {}
+
+    const BencodeDocument *document; //!> Owning document.
+    uint32_t index;                  //!> Tape index of the current child (or key).
+    bool pairs;                      //!> True when iterating a dictionary.
+};
+
+class BencodeDocument
+{
+public:
+    /*!
+        \brief Parses bencoded data into a flat tape of nodes that reference the buffer.
+        No string data is copied; the buffer must outlive the document's values.
+        Reusing one document across messages reuses its tape storage.
+        \param data The bencoded data.
+        \throws std::runtime_error on malformed or truncated input.
+    */
+    void parse(std::string_view data);
+
+    /*!
+        \brief Parses only the value at a dictionary key path (e.g. {"info"} of a .torrent).
+        The whole buffer is validated and indexed by BencodeScanner first, so nothing outside
+        the path is put on the tape; root() is then the value found and bytesConsumed() its length.
+        \param data The bencoded data.
+        \param path The keys to follow from the top-level dictionary, outermost first.
+        \return False if a key is missing (the document is left empty).
+        \throws std::runtime_error on malformed or truncated input.
+    */
+    bool parse(std::string_view data, std::initializer_list<std::string_view> path);
+
+    /*!
+        \brief Get the top-level value.
+        \return The root value, or an invalid handle if nothing has been parsed.
+    */
+    BencodeValue root() const;
+
+    /*!
+        \brief Number of bytes the top-level value occupied in the buffer.
+        \return The consumed length; trailing data is not parsed.
+    */
+    size_t bytesConsumed() const { return consumed; }
+
+    /*!
+        \brief Access the parsed tape.
+        \return The node tape in document order.
+    */
+    const std::vector<BencodeNode> &nodes() const { return tape; }
+
+    /*!
+        \brief Get the source buffer the document references.
+        \return The source view.
+    */
+    std::string_view data() const { return source; }
+
+    static constexpr size_t MAX_DEPTH = 256; //!> Nesting limit to bound hostile input.
+
+private:
+    friend class BencodeValue;
+
+    struct OpenContainer
+    {
+        uint32_t tapeIndex; //!> Tape index of the container node.
+        uint32_t children;  //!> Number of child nodes seen so far (keys and values).
+    };
+
+    std::string_view source;                   //!> Buffer the nodes point into.
+    std::vector<BencodeNode> tape;             //!> Flat value tree.
+    std::vector<OpenContainer> openContainers; //!> Parse stack, kept for reuse between messages.
+    BencodeScanner scanner;                    //!> Skip index for path parses, kept for reuse.
+    size_t consumed = 0;                       //!> Bytes consumed by the top-level value.
+};
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeScanner.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 11:58:44
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "BencodeScanner.h"
+#include <stdexcept>
+#include <limits>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define BENCODE_SCANNER_SSE2 1
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define BENCODE_SCANNER_AVX2 1 //!> Built with target("avx2") and picked at run time
+#endif
+
+#define BENCODE_SCANNER_MAX_DEPTH 256
+
+/*!
+    \brief Count leading digits 16 bytes at a time (SSE2), finishing with the scalar loop.
+    \param begin Start of the range.
+    \param end End of the range.
+    \return Number of leading digits.
+*/
+static size_t countDigitsSse2(const char *begin, const char *end)
+{
+    const char *p = begin;
+
+#if defined(BENCODE_SCANNER_SSE2)
+    const __m128i zero16 = _mm_set1_epi8('0');
+    const __m128i nine16 = _mm_set1_epi8(9);
+    while (end - p >= 16)
+    {
+        __m128i shifted = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), zero16);
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(shifted, nine16), shifted); //!> (c - '0') <= 9 unsigned
+        uint32_t notDigit = ~static_cast<uint32_t>(_mm_movemask_epi8(isDigit)) & 0xFFFFu;
+        if (notDigit != 0)
+            return static_cast<size_t>(p - begin) + static_cast<size_t>(__builtin_ctz(notDigit));
+        p += 16;
+    }
+#endif
+
+    while (p < end && *p >= '0' && *p <= '9')
+        p++;
+    return static_cast<size_t>(p - begin);
+}
+
+#if defined(BENCODE_SCANNER_AVX2)
+/*!
+    \brief Count leading digits 32 bytes at a time (AVX2); only called when the CPU supports it.
+    \param begin Start of the range.
+    \param end End of the range.
+    \return Number of leading digits.
+*/
+__attribute__((target("avx2"))) static size_t countDigitsAvx2(const char *begin, const char *end)
+{
+    const char *p = begin;
+    const __m256i zero32 = _mm256_set1_epi8('0');
+    const __m256i nine32 = _mm256_set1_epi8(9);
+    while (end - p >= 32)
+    {
+        __m256i shifted = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), zero32);
+        __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, nine32), shifted);
+        uint32_t notDigit = ~static_cast<uint32_t>(_mm256_movemask_epi8(isDigit));
+        if (notDigit != 0)
+            return static_cast<size_t>(p - begin) + static_cast<size_t>(__builtin_ctz(notDigit));
+        p += 32;
+    }
+    return static_cast<size_t>(p - begin) + countDigitsSse2(p, end);
+}
+#endif
+
+/*!
+    \brief Count the ASCII digits at the start of a range.
+    \param begin Start of the range.
+    \param end End of the range.
+    \return Number of leading digits.
+*/
+size_t BencodeScanner::countDigits(const char *begin, const char *end)
+{
+#if defined(BENCODE_SCANNER_AVX2)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2)
+        return countDigitsAvx2(begin, end);
+#endif
+    return countDigitsSse2(begin, end);
+}
+
+/*!
+    \brief Convert a run of already-classified digits to a number.
+    \param digits The digits.
+    \param count How many digits (at most 19).
+    \return The value.
+*/
+static uint64_t parseDigits(const char *digits, size_t count)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < count; ++i)
+        value = value * 10 + static_cast<uint64_t>(digits[i] - '0');
+    return value;
+}
+
+/*!
+    \brief Validate the data and build the skip index.
+    \param data The bencoded data; must outlive the scanner's lookups.
+    \throws std::runtime_error if the data is not a single well-formed value.
+*/
+void BencodeScanner::scan(std::string_view data)
+{
+    source = std::string_view();
+    spans.clear();
+    openSpans.clear();
+    openCounts.clear();
+
+    if (data.size() > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Bencoded data too large");
+
+    const char *base = data.data();
+    const char *end = base + data.size();
+    const size_t size = data.size();
+    size_t index = 0;
+
+    do
+    {
+        if (index >= size)
+            throw std::runtime_error("Unexpected end of bencoded data");
+
+        char c = base[index];
+
+        if (!openSpans.empty())
+        {
+            ContainerSpan &parent = spans[openSpans.back()];
+            bool inDictionary = base[parent.begin] == 'd';
+            uint32_t &children = openCounts.back();
+
+            if (c == 'e')
+            {
+                if (inDictionary && (children % 2) != 0)
+                    throw std::runtime_error("Dictionary key without value");
+                parent.end = static_cast<uint32_t>(index + 1);
+                parent.nextContainer = static_cast<uint32_t>(spans.size());
+                openSpans.pop_back();
+                openCounts.pop_back();
+                index++; //!> Skip 'e'
+                continue;
+            }
+
+            if (inDictionary && (children % 2) == 0 && (c < '0' || c > '9'))
+                throw std::runtime_error("Dictionary key must be a string");
+            children++;
+        }
+
+        if (c >= '0' && c <= '9')
+        {
+            size_t digits = countDigits(base + index, end);
+            if (digits > 19)
+                throw std::runtime_error("String length exceeds data size");
+            if (digits > 1 && c == '0')
+                throw std::runtime_error("Leading zero in string length");
+            uint64_t length = parseDigits(base + index, digits);
+            index += digits;
+            if (index >= size || base[index] != ':')
+                throw std::runtime_error("Malformed bencoded string");
+            index++; //!> Skip ':'
+            if (length > size - index)
+                throw std::runtime_error("String length exceeds data size");
+            index += static_cast<size_t>(length);
+        }
+        else if (c == 'i')
+        {
+            index++; //!> Skip 'i'
+            bool negative = index < size && base[index] == '-';
+            if (negative)
+                index++;
+            size_t digits = countDigits(base + index, end);
+            if (digits == 0 || digits > 19 || index + digits >= size || base[index + digits] != 'e')
+                throw std::runtime_error("Malformed bencoded integer");
+            if (base[index] == '0' && (digits > 1 || negative))
+                throw std::runtime_error("Non-canonical bencoded integer");
+            index += digits + 1; //!> Digits and 'e'
+        }
+        else if (c == 'd' || c == 'l')
+        {
+            if (openSpans.size() >= BENCODE_SCANNER_MAX_DEPTH)
+                throw std::runtime_error("Bencoded data nested too deeply");
+            openSpans.push_back(static_cast<uint32_t>(spans.size()));
+            openCounts.push_back(0);
+            spans.push_back({static_cast<uint32_t>(index), 0, 0});
+            index++; //!> Skip 'd' / 'l'
+        }
+        else
+        {
+            throw std::runtime_error("Unsupported bencoded format");
+        }
+    } while (!openSpans.empty());
+
+    source = data.substr(0, index);
+}
+
+/*!
+    \brief Check whether data is a single well-formed bencoded value.
+    \param data The data to check.
+    \return True if valid.
+*/
+bool BencodeScanner::isValid(std::string_view data)
+{
+    try
+    {
+        BencodeScanner scanner;
+        scanner.scan(data);
+        return scanner.source.size() == data.size();
+    }
+    catch (const std::runtime_error &)
+    {
+        return false;
+    }
+}
+
+/*!
+    \brief Find where the value at a position ends, using the skip index for containers.
+    \param position Offset of the value's first byte.
+    \param containerCursor Index of the next unvisited container; advanced past skipped containers.
+    \return Offset one past the value.
+*/
+size_t BencodeScanner::valueEnd(size_t position, uint32_t &containerCursor) const
+{
+    const char *base = source.data();
+    char c = base[position];
+
+    if (c >= '0' && c <= '9')
+    {
+        size_t digits = countDigits(base + position, base + source.size());
+        return position + digits + 1 + static_cast<size_t>(parseDigits(base + position, digits));
+    }
+    if (c == 'i')
+    {
+        const void *terminator = std::memchr(base + position, 'e', source.size() - position);
+        return static_cast<size_t>(static_cast<const char *>(terminator) - base) + 1;
+    }
+
+    const ContainerSpan &span = spans[containerCursor];
+    containerCursor = span.nextContainer;
+    return span.end;
+}
+
+/*!
+    \brief Find a value by following dictionary keys from the root.
+    \param path The keys to follow, outermost first.
+    \return The raw encoded value, or an empty view if any key is missing.
+*/
+std::string_view BencodeScanner::find(std::initializer_list<std::string_view> path) const
+{
+    if (source.empty())
+        return std::string_view();
+
+    const char *base = source.data();
+    size_t position = 0;
+    uint32_t cursor = 0; //!> Index of the container at `position`, if it is one
+
+    for (std::string_view key : path)
+    {
+        if (base[position] != 'd')
+            return std::string_view();
+
+        uint32_t childCursor = cursor + 1;
+        size_t current = position + 1;
+        bool found = false;
+
+        while (base[current] != 'e')
+        {
+            size_t digits = countDigits(base + current, base + source.size());
+            size_t length = static_cast<size_t>(parseDigits(base + current, digits));
+            std::string_view candidate = source.substr(current + digits + 1, length);
+            current += digits + 1 + length;
+
+            if (candidate == key)
+            {
+                position = current;
+                cursor = childCursor;
+                found = true;
+                break;
+            }
+            current = valueEnd(current, childCursor);
+        }
+
+        if (!found)
+            return std::string_view();
+    }
+
+    uint32_t last = cursor;
+    return source.substr(position, valueEnd(position, last) - position);
+}
@@ -0,0 +1,83 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeScanner.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 11:58:27
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef BENCODE_SCANNER_H
+#define BENCODE_SCANNER_H
+
+#include <string_view>
+#include <vector>
+#include <initializer_list>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief Validates bencoded data and builds a skip index over its containers.
+    Only containers are indexed; strings and integers are skipped through their length
+    prefix or terminator. Digit runs are classified with AVX2 when the CPU has it (checked
+    once at run time), SSE2 on other x86-64 CPUs and a scalar loop elsewhere.
+    Lookups such as {"info", "pieces"} then touch only the siblings along the path.
+*/
+class BencodeScanner
+{
+public:
+    struct ContainerSpan
+    {
+        uint32_t begin;         //!> Offset of the 'd' or 'l'.
+        uint32_t end;           //!> Offset one past the closing 'e'.
+        uint32_t nextContainer; //!> Index of the first container after this subtree.
+    };
+
+    /*!
+        \brief Validate the data and build the skip index.
+        \param data The bencoded data; must outlive the scanner's lookups.
+        \throws std::runtime_error if the data is not a single well-formed value.
+    */
+    void scan(std::string_view data);
+
+    /*!
+        \brief Find a value by following dictionary keys from the root.
+        \param path The keys to follow, outermost first.
+        \return The raw encoded value, or an empty view if any key is missing.
+    */
+    std::string_view find(std::initializer_list<std::string_view> path) const;
+
+    /*!
+        \brief Get the container index built by scan().
+        \return Containers in document order.
+    */
+    const std::vector<ContainerSpan> &containers() const { return spans; }
+
+    /*!
+        \brief Check whether data is a single well-formed bencoded value.
+        \param data The data to check.
+        \return True if valid.
+    */
+    static bool isValid(std::string_view data);
+
+    /*!
+        \brief Count the ASCII digits at the start of a range.
+        \param begin Start of the range.
+        \param end End of the range.
+        \return Number of leading digits.
+    */
+    static size_t countDigits(const char *begin, const char *end);
+
+private:
+    std::string_view source;          //!> Scanned data.
+    std::vector<ContainerSpan> spans; //!> Skip index.
+    std::vector<uint32_t> openSpans;  //!> Scan stack, kept for reuse.
+    std::vector<uint32_t> openCounts; //!> Children seen per open container.
+
+    size_t valueEnd(size_t position, uint32_t &containerCursor) const;
+};
+
+#endif
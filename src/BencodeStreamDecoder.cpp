@@ -0,0 +1,273 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeStreamDecoder.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 10:02:31
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "BencodeStreamDecoder.h"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+/*!
+    \brief Creates a decoder that reports to the given handler.
+    \param handler Receives events; must outlive the decoder.
+*/
+BencodeStreamDecoder::BencodeStreamDecoder(BencodeEventHandler &handler) : handler(handler) {}
+
+/*!
+    \brief Watch a key of the top-level dictionary (e.g. "info").
+    \param key The key to watch; empty disables watching.
+*/
+void BencodeStreamDecoder::watchKey(std::string key)
+{
+    watchedKey = std::move(key);
+    keyBuffer.reserve(watchedKey.size() + 1);
+}
+
+/*!
+    \brief Prepare to decode a new top-level value. The watched key is kept.
+*/
+void BencodeStreamDecoder::reset()
+{
+    state = State::Value;
+    frames.clear();
+    streamOffset = 0;
+    number = 0;
+    digits = 0;
+    negative = false;
+    currentIsKey = false;
+    remaining = 0;
+    keyBuffer.clear();
+    keyMatches = false;
+    capturing = false;
+    watched = BencodeCheckpoint();
+}
+
+/*!
+    \brief Check whether the next value in the innermost container is a dictionary key.
+    \return True if a key is expected.
+*/
+bool BencodeStreamDecoder::isKeyPosition() const
+{
+    return !frames.empty() && frames.back().dictionary && (frames.back().children % 2) == 0;
+}
+
+/*!
+    \brief Handle the first byte of a value.
+    \param c The byte.
+*/
+void BencodeStreamDecoder::beginValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        currentIsKey = isKeyPosition();
+        number = static_cast<uint64_t>(c - '0');
+        digits = 1;
+        state = State::StringLength;
+        return;
+    }
+
+    if (isKeyPosition())
+        throw std::runtime_error("Dictionary key must be a string");
+
+    if (c == 'i')
+    {
+        number = 0;
+        digits = 0;
+        negative = false;
+        state = State::Integer;
+    }
+    else if (c == 'd' || c == 'l')
+    {
+        if (frames.size() >= MAX_DEPTH)
+            throw std::runtime_error("Bencoded data nested too deeply");
+
+        frames.push_back({c == 'd', 0});
+        if (c == 'd')
+            handler.onDictionaryBegin();
+        else
+            handler.onListBegin();
+        state = State::Value;
+    }
+    else
+    {
+        throw std::runtime_error("Unsupported bencoded format");
+    }
+}
+
+/*!
+    \brief Account for a finished value in its parent and track the watched key.
+*/
+void BencodeStreamDecoder::valueCompleted()
+{
+    if (frames.empty())
+    {
+        state = State::Done;
+        return;
+    }
+
+    state = State::Value;
+    Frame &parent = frames.back();
+    parent.children++;
+
+    if (frames.size() != 1 || !parent.dictionary)
+        return;
+
+    if (parent.children % 2 == 1)
+    {
+        //* A top-level key just completed
+        keyMatches = !watched.found && !watchedKey.empty() && keyBuffer == watchedKey;
+        keyBuffer.clear();
+    }
+    else
+    {
+        if (capturing)
+        {
+            capturing = false;
+            watched.end = streamOffset;
+            watched.found = true;
+        }
+        keyMatches = false;
+    }
+}
+
+/*!
+    \brief Feed the next chunk of data. Parse state is kept between calls.
+    \param chunk The bytes that arrived.
+    \return Bytes consumed; less than the chunk size only if the top-level value completed inside it.
+    \throws std::runtime_error on malformed input.
+*/
+size_t BencodeStreamDecoder::feed(std::string_view chunk)
+{
+    const size_t size = chunk.size();
+    size_t index = 0;
+    size_t captureStart = 0; //!> Start of the watched value's bytes within this chunk
+
+    while (index < size && state != State::Done)
+    {
+        bool wasCapturing = capturing;
+        char c = chunk[index];
+
+        switch (state)
+        {
+        case State::Value:
+            index++;
+            streamOffset++;
+            if (c == 'e' && !frames.empty())
+            {
+                if (frames.back().dictionary && (frames.back().children % 2) != 0)
+                    throw std::runtime_error("Dictionary key without value");
+                frames.pop_back();
+                handler.onContainerEnd();
+                valueCompleted();
+                break;
+            }
+            if (keyMatches && frames.size() == 1 && !isKeyPosition())
+            {
+                capturing = true;
+                captureStart = index - 1;
+                watched.begin = streamOffset - 1;
+            }
+            beginValue(c);
+            break;
+
+        case State::StringLength:
+            index++;
+            streamOffset++;
+            if (c >= '0' && c <= '9')
+            {
+                if (number == 0)
+                    throw std::runtime_error("Leading zero in string length");
+                if (number > (std::numeric_limits<uint64_t>::max() - 9) / 10)
+                    throw std::runtime_error("String length too large");
+                number = number * 10 + static_cast<uint64_t>(c - '0');
+                digits++;
+            }
+            else if (c == ':')
+            {
+                remaining = number;
+                handler.onStringBegin(number, currentIsKey);
+                if (remaining == 0)
+                {
+                    handler.onStringEnd();
+                    valueCompleted();
+                }
+                else
+                {
+                    state = State::StringData;
+                }
+            }
+            else
+            {
+                throw std::runtime_error("Malformed bencoded string");
+            }
+            break;
+
+        case State::StringData:
+        {
+            size_t take = static_cast<size_t>(std::min<uint64_t>(remaining, size - index));
+            std::string_view data = chunk.substr(index, take);
+            if (currentIsKey && frames.size() == 1 && keyBuffer.size() <= watchedKey.size())
+                keyBuffer.append(data.substr(0, watchedKey.size() + 1 - keyBuffer.size()));
+
+            handler.onStringData(data);
+            index += take;
+            streamOffset += take;
+            remaining -= take;
+            if (remaining == 0)
+            {
+                handler.onStringEnd();
+                valueCompleted();
+            }
+            break;
+        }
+
+        case State::Integer:
+            index++;
+            streamOffset++;
+            if (c == '-' && digits == 0 && !negative)
+            {
+                negative = true;
+            }
+            else if (c >= '0' && c <= '9')
+            {
+                if (digits > 0 && number == 0)
+                    throw std::runtime_error("Non-canonical bencoded integer");
+                if (++digits > 19)
+                    throw std::runtime_error("Malformed bencoded integer");
+                number = number * 10 + static_cast<uint64_t>(c - '0');
+            }
+            else if (c == 'e')
+            {
+                uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+                if (digits == 0 || number > limit || (negative && number == 0))
+                    throw std::runtime_error("Malformed bencoded integer");
+                handler.onInteger(negative ? static_cast<int64_t>(0 - number) : static_cast<int64_t>(number));
+                valueCompleted();
+            }
+            else
+            {
+                throw std::runtime_error("Integer not properly terminated");
+            }
+            break;
+
+        case State::Done:
+            break;
+        }
+
+        if (wasCapturing && !capturing)
+            handler.onCheckpointData(chunk.substr(captureStart, index - captureStart));
+    }
+
+    if (capturing && index > captureStart)
+        handler.onCheckpointData(chunk.substr(captureStart, index - captureStart));
+
+    return index;
+}
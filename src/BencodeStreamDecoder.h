@@ -0,0 +1,138 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeStreamDecoder.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 10:02:15
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef BENCODE_STREAM_DECODER_H
+#define BENCODE_STREAM_DECODER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief Receives events from a BencodeStreamDecoder as values complete.
+    All methods have empty defaults so handlers only override what they need.
+*/
+class BencodeEventHandler
+{
+public:
+    virtual ~BencodeEventHandler() = default;
+
+    virtual void onDictionaryBegin() {}                        //!> A 'd' was read.
+    virtual void onListBegin() {}                              //!> An 'l' was read.
+    virtual void onContainerEnd() {}                           //!> The innermost container closed.
+    virtual void onInteger(int64_t /*value*/) {}               //!> A complete integer was read.
+    virtual void onStringBegin(uint64_t /*length*/, bool /*isKey*/) {} //!> A string header was read.
+    virtual void onStringData(std::string_view /*chunk*/) {}   //!> Part of the current string's bytes.
+    virtual void onStringEnd() {}                              //!> The current string is complete.
+    virtual void onCheckpointData(std::string_view /*chunk*/) {} //!> Raw bytes of the watched value, in order.
+};
+
+/*!
+    \brief Byte range of a watched top-level value within the stream.
+*/
+struct BencodeCheckpoint
+{
+    bool found = false;  //!> True once the watched value has been fully read.
+    uint64_t begin = 0;  //!> Stream offset of the value's first byte.
+    uint64_t end = 0;    //!> Stream offset one past the value's last byte.
+};
+
+class BencodeStreamDecoder
+{
+public:
+    /*!
+        \brief Creates a decoder that reports to the given handler.
+        \param handler Receives events; must outlive the decoder.
+    */
+    explicit BencodeStreamDecoder(BencodeEventHandler &handler);
+
+    /*!
+        \brief Watch a key of the top-level dictionary (e.g. "info").
+        Its raw bytes are streamed to onCheckpointData and its span recorded in checkpoint().
+        \param key The key to watch; empty disables watching.
+    */
+    void watchKey(std::string key);
+
+    /*!
+        \brief Feed the next chunk of data. Parse state is kept between calls.
+        \param chunk The bytes that arrived.
+        \return Bytes consumed; less than the chunk size only if the top-level value completed inside it.
+        \throws std::runtime_error on malformed input.
+    */
+    size_t feed(std::string_view chunk);
+
+    /*!
+        \brief Check whether a full top-level value has been read.
+        \return True when complete.
+    */
+    bool isComplete() const { return state == State::Done; }
+
+    /*!
+        \brief Total number of bytes consumed so far.
+        \return The stream offset of the next byte to be read.
+    */
+    uint64_t position() const { return streamOffset; }
+
+    /*!
+        \brief Get the span of the watched key's value.
+        \return The checkpoint; `found` is false until the value completes.
+    */
+    const BencodeCheckpoint &checkpoint() const { return watched; }
+
+    /*!
+        \brief Prepare to decode a new top-level value. The watched key is kept.
+    */
+    void reset();
+
+    static constexpr size_t MAX_DEPTH = 256; //!> Nesting limit to bound hostile input.
+
+private:
+    enum class State
+    {
+        Value,
+        StringLength,
+        StringData,
+        Integer,
+        Done
+    };
+
+    struct Frame
+    {
+        bool dictionary;   //!> True for dictionaries, false for lists.
+        uint64_t children; //!> Child values seen so far (keys and values).
+    };
+
+    BencodeEventHandler &handler;  //!> Event sink.
+    State state = State::Value;    //!> Current parser state.
+    std::vector<Frame> frames;     //!> Open containers.
+    uint64_t streamOffset = 0;     //!> Bytes consumed since reset.
+
+    uint64_t number = 0;           //!> String length or integer magnitude being accumulated.
+    uint32_t digits = 0;           //!> Digits seen for the current number.
+    bool negative = false;         //!> Sign of the integer being read.
+    bool currentIsKey = false;     //!> True while reading a dictionary key.
+    uint64_t remaining = 0;        //!> String bytes still to read.
+
+    std::string watchedKey;        //!> Top-level key to checkpoint.
+    std::string keyBuffer;         //!> Bytes of the current top-level key (only up to watchedKey's size).
+    bool keyMatches = false;       //!> The last completed top-level key equals watchedKey.
+    bool capturing = false;        //!> Currently inside the watched value.
+    BencodeCheckpoint watched;     //!> Span of the watched value.
+
+    bool isKeyPosition() const;
+    void beginValue(char c);
+    void valueCompleted();
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeWriter.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 10:48:19
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "BencodeWriter.h"
+#include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+
+/*!
+    \brief Creates a writer over a caller-owned buffer.
+    \param buffer The output buffer.
+    \param capacity The size of the buffer in bytes.
+*/
+BencodeWriter::BencodeWriter(char *buffer, size_t capacity) : buffer(buffer), capacity(capacity) {}
+
+/*!
+    \brief Start over, reusing the same buffer.
+*/
+void BencodeWriter::reset()
+{
+    length = 0;
+    overflowed = false;
+    depth = 0;
+}
+
+void BencodeWriter::put(char c)
+{
+    if (length >= capacity)
+    {
+        overflowed = true;
+        return;
+    }
+    buffer[length++] = c;
+}
+
+void BencodeWriter::put(const char *data, size_t size)
+{
+    if (size > capacity - length)
+    {
+        overflowed = true;
+        length = capacity;
+        return;
+    }
+    std::memcpy(buffer + length, data, size);
+    length += size;
+}
+
+void BencodeWriter::putLength(uint64_t value)
+{
+    char digits[20];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    put(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+/*!
+    \brief Check that a key or value is allowed at the current position.
+    \param isKey True if a dictionary key is being written.
+*/
+void BencodeWriter::beforeValue(bool isKey)
+{
+    if (depth == 0)
+        return;
+
+    Frame &frame = frames[depth - 1];
+    if (!frame.dictionary)
+    {
+        if (isKey)
+            throw std::runtime_error("Dictionary key written inside a list");
+        return;
+    }
+    if (frame.expectingKey != isKey)
+        throw std::runtime_error(isKey ? "Dictionary key written where a value was expected" : "Dictionary value written without a key");
+    frame.expectingKey = !isKey;
+}
+
+/*!
+    \brief Write 'd'.
+*/
+void BencodeWriter::beginDictionary()
+{
+    beforeValue(false);
+    if (depth >= MAX_DEPTH)
+        throw std::runtime_error("Bencode writer nested too deeply");
+    frames[depth++] = {true, true, 0, SIZE_MAX};
+    put('d');
+}
+
+/*!
+    \brief Write 'l'.
+*/
+void BencodeWriter::beginList()
+{
+    beforeValue(false);
+    if (depth >= MAX_DEPTH)
+        throw std::runtime_error("Bencode writer nested too deeply");
+    frames[depth++] = {false, false, 0, SIZE_MAX};
+    put('l');
+}
+
+/*!
+    \brief Close the innermost container.
+*/
+void BencodeWriter::end()
+{
+    if (depth == 0)
+        throw std::runtime_error("No open container to end");
+    if (frames[depth - 1].dictionary && !frames[depth - 1].expectingKey)
+        throw std::runtime_error("Dictionary key without value");
+    depth--;
+    put('e');
+}
+
+/*!
+    \brief Write a dictionary key. Keys must be unique and in ascending byte order.
+    \param key The key.
+*/
+void BencodeWriter::key(std::string_view key)
+{
+    beforeValue(true);
+
+    Frame &frame = frames[depth - 1];
+    if (frame.lastKeyLen != SIZE_MAX && !overflowed)
+    {
+        std::string_view previous(buffer + frame.lastKey, frame.lastKeyLen);
+        if (!(previous < key))
+            throw std::runtime_error("Dictionary keys must be written in sorted order");
+    }
+
+    putLength(key.size());
+    put(':');
+    frame.lastKey = length;
+    frame.lastKeyLen = key.size();
+    put(key.data(), key.size());
+}
+
+/*!
+    \brief Write a byte string.
+    \param value The bytes.
+*/
+void BencodeWriter::string(std::string_view value)
+{
+    beforeValue(false);
+    putLength(value.size());
+    put(':');
+    put(value.data(), value.size());
+}
+
+/*!
+    \brief Write an integer.
+    \param value The value.
+*/
+void BencodeWriter::integer(int64_t value)
+{
+    beforeValue(false);
+    char digits[21];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    put('i');
+    put(digits, static_cast<size_t>(result.ptr - digits));
+    put('e');
+}
+
+/*!
+    \brief Write a dictionary from unordered pairs of string values, sorting them in place.
+    \param items The key/value pairs.
+    \param count The number of pairs.
+*/
+void BencodeWriter::dictionary(std::pair<std::string_view, std::string_view> *items, size_t count)
+{
+    std::sort(items, items + count, [](const auto &a, const auto &b)
+              { return a.first < b.first; });
+
+    beginDictionary();
+    for (size_t i = 0; i < count; ++i)
+    {
+        key(items[i].first);
+        string(items[i].second);
+    }
+    end();
+}
+
+/*!
+    \brief Number of bytes the encoded form of a string takes.
+    \param length The string length.
+    \return Length prefix, ':' and the bytes.
+*/
+size_t BencodeWriter::encodedStringSize(size_t length)
+{
+    size_t digits = 1;
+    for (size_t value = length; value >= 10; value /= 10)
+        digits++;
+    return digits + 1 + length;
+}
@@ -0,0 +1,105 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\BencodeWriter.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 10:48:03
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef BENCODE_WRITER_H
+#define BENCODE_WRITER_H
+
+#include <string_view>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief Writes canonical bencode into a caller-owned buffer without allocating.
+    Dictionary keys must be written in ascending byte order; the writer checks this
+    against the keys already in the buffer. If the buffer is too small the writer
+    stops writing and ok() returns false.
+*/
+class BencodeWriter
+{
+public:
+    /*!
+        \brief Creates a writer over a caller-owned buffer.
+        \param buffer The output buffer.
+        \param capacity The size of the buffer in bytes.
+    */
+    BencodeWriter(char *buffer, size_t capacity);
+
+    void beginDictionary();                //!> Write 'd'.
+    void beginList();                      //!> Write 'l'.
+    void end();                            //!> Close the innermost container.
+    void key(std::string_view key);        //!> Write a dictionary key (must sort after the previous key).
+    void string(std::string_view value);   //!> Write a byte string.
+    void integer(int64_t value);           //!> Write an integer.
+
+    /*!
+        \brief Write a dictionary from unordered pairs of string values, sorting them in place.
+        \param items The key/value pairs.
+        \param count The number of pairs.
+    */
+    void dictionary(std::pair<std::string_view, std::string_view> *items, size_t count);
+
+    /*!
+        \brief Check that everything fit in the buffer.
+        \return False if the buffer overflowed.
+    */
+    bool ok() const { return !overflowed; }
+
+    /*!
+        \brief Number of bytes written so far.
+        \return The encoded length.
+    */
+    size_t size() const { return length; }
+
+    /*!
+        \brief View of the encoded bytes.
+        \return The encoded data.
+    */
+    std::string_view view() const { return std::string_view(buffer, length); }
+
+    /*!
+        \brief Start over, reusing the same buffer.
+    */
+    void reset();
+
+    /*!
+        \brief Number of bytes the encoded form of a string takes.
+        \param length The string length.
+        \return Length prefix, ':' and the bytes.
+    */
+    static size_t encodedStringSize(size_t length);
+
+    static constexpr size_t MAX_DEPTH = 32; //!> Deepest nesting the writer tracks.
+
+private:
+    struct Frame
+    {
+        bool dictionary;   //!> True for dictionaries.
+        bool expectingKey; //!> Next item in the dictionary must be a key.
+        size_t lastKey;    //!> Offset of the previous key's bytes in the buffer.
+        size_t lastKeyLen; //!> Length of the previous key (SIZE_MAX if none).
+    };
+
+    char *buffer;               //!> Output buffer.
+    size_t capacity;            //!> Output buffer size.
+    size_t length = 0;          //!> Bytes written.
+    bool overflowed = false;    //!> Set once a write did not fit.
+    Frame frames[MAX_DEPTH];    //!> Open containers.
+    size_t depth = 0;           //!> Number of open containers.
+
+    void put(char c);
+    void put(const char *data, size_t size);
+    void putLength(uint64_t value);
+    void beforeValue(bool isKey);
+};
+
+#endif
@@ -12,13 +12,13 @@
 
 #include "DHTClient.h"
 #include "TorrentUtilities.h"
+#include "KrpcEncoder.h"
+#include "DHTLookup.h"
 #include <iostream>
 #include <stdexcept>
-#include <sstream>
+#include <chrono>
 #include <cstring>
-#include <random>
 #include <array>
-#include <unordered_map>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -28,24 +28,17 @@
 #include <unistd.h>
 #endif
 #include <cstdint>
-#include <iomanip>
 
 #define DHT_PORT 6881
-#define BUFFER_SIZE 1024
 
 /*!
     \brief Constructor for DHTClient.
     \param infoHash The info hash of the torrent file.
+    \param node The DHT node to run lookups on.
 */
-DHTClient::DHTClient(const std::string &infoHash) : infoHash(infoHash)
+DHTClient::DHTClient(const std::string &infoHash, DHTNode &node)
+    : infoHash(infoHash), infoHashBytes(TorrentUtilities::infoHashToBytes(infoHash)), node(node)
 {
-#ifdef _WIN32
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
-    {
-        throw std::runtime_error("WSAStartup failed");
-    }
-#endif
 }
 
 /*!
@@ -53,231 +46,130 @@ DHTClient::DHTClient(const std::string &infoHash) : infoHash(infoHash)
 */
 DHTClient::~DHTClient()
 {
-#ifdef _WIN32
-    WSACleanup();
-#endif
 }
 
 /*!
-    \brief Creates a UDP socket for DHT communication.
-    \return The socket file descriptor.
+    \brief Builds a get_peers query to send to DHT nodes.
+    \param transactionId The two-byte transaction ID to embed.
+    \return The bencoded query string.
 */
-int DHTClient::createSocket()
+std::string DHTClient::buildGetPeersQuery(std::string_view transactionId)
 {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0)
-    {
-        throw std::runtime_error("Failed to create UDP socket");
-    }
-    return sock;
+    char query[KrpcEncoder::GET_PEERS_SIZE];
+    size_t length = KrpcEncoder::encodeGetPeers(query, transactionId, node.id(), infoHashBytes);
+    return std::string(query, length);
 }
 
 /*!
-    \brief Generates a random 20-byte node ID.
-    \return A 20-byte array containing the node ID.
+    \brief Sends a get_peers query through the node's engine; `peers` is fulfilled when the reply arrives.
+    Runs on the node thread.
+    \param engine The node's engine.
+    \param address The node to query.
+    \param peers Receives the peers from the reply (empty on timeout).
+    \return False if the query could not be sent.
 */
-std::array<uint8_t, 20> DHTClient::generateNodeID()
+bool DHTClient::sendGetPeers(DHTEngine &engine, const sockaddr_in &address, PeersPromise peers)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 255);
-
-    std::array<uint8_t, 20> nodeID;
-    for (uint8_t &byte : nodeID)
-    {
-        byte = static_cast<uint8_t>(dis(gen));
-    }
-
-    return nodeID;
-}
-
-/*!
-    \brief Builds a get_peers query to send to DHT nodes.
-    \return The bencoded query string.
-*/
-std::string DHTClient::buildGetPeersQuery()
-{
-    std::array<uint8_t, 20> nodeID = generateNodeID();
-    std::string nodeIDStr;
-
-    for (auto byte : nodeID)
-    {
-        std::stringstream ss;
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)byte;
-        nodeIDStr += ss.str();
-    }
-
-    std::cout << "Node ID (Hex): " << nodeIDStr << std::endl;
-
-    std::unordered_map<std::string, std::string> args;
-    args["id"] = nodeIDStr;
-    args["info_hash"] = infoHash;
-
-    std::unordered_map<std::string, std::string> query;
-    query["t"] = "aa";                                       //!> Transaction ID
-    query["y"] = "q";                                        //!> Query type
-    query["q"] = "get_peers";                                //!> Query method
-    query["a"] = TorrentUtilities::encodeBencodedData(args); //!> Encoded arguments
-
-    std::string fullQuery = TorrentUtilities::encodeBencodedData(query);
+    return engine.sendQuery(
+        address,
+        [this](char *buffer, std::string_view transactionId)
+        { return KrpcEncoder::encodeGetPeers(buffer, transactionId, node.id(), infoHashBytes); },
+        [this, peers](const DHTReply &reply)
+        {
+            char from[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &reply.from.sin_addr, from, sizeof(from));
 
-    std::cout << "Full Query: " << fullQuery << std::endl;
+            if (reply.timedOut)
+            {
+                std::cerr << "No reply from node " << from << " within " << reply.rtt.count() << " ms" << std::endl;
+                peers->set_value({});
+                return;
+            }
 
-    return fullQuery;
+            std::vector<PeerEndpoint> nodePeers = parseResponse(reply.message);
+            std::cout << "Received " << nodePeers.size() << " peers from node " << from
+                      << " in " << reply.rtt.count() << " ms" << std::endl;
+            peers->set_value(std::move(nodePeers));
+        });
 }
 
 /*!
-    \brief Get a list of peers for the torrent file from multiple bootstrap nodes.
-    \return A vector of strings containing peer information.
+    \brief Get a list of peers for the torrent file with an iterative lookup.
+    The lookup runs on the shared node alongside every other torrent's lookups and
+    blocks until it converges.
+    \return The peers, deduplicated.
 */
-std::vector<std::string> DHTClient::getPeers()
+std::vector<PeerEndpoint> DHTClient::getPeers()
 {
-    std::vector<std::string> allPeers;
-    std::vector<std::string> bootstrapNodes = {
-        "67.215.246.10",
-        "router.bittorrent.com",
-        "dht.transmissionbt.com"};
-
     std::cout << "Starting to discover peers..." << std::endl;
+    auto started = std::chrono::steady_clock::now();
 
-    std::string query = buildGetPeersQuery();
+    DHTLookupResult result = node.findPeers(infoHashBytes).get();
 
-    for (const auto &node : bootstrapNodes)
-    {
-        std::cout << "Attempting to fetch peers from node: " << node << std::endl;
-
-        try
-        {
-            std::vector<std::string> peers = getPeersFromNode(node, query);
-            std::cout << "Received " << peers.size() << " peers from node: " << node << std::endl;
-            allPeers.insert(allPeers.end(), peers.begin(), peers.end());
-        }
-        catch (const std::runtime_error &e)
-        {
-            std::cerr << "Error fetching peers from node " << node << ": " << e.what() << std::endl;
-        }
-    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    std::cout << "Total peers discovered: " << result.peers.size() << " (" << result.queries << " queries, "
+              << elapsed.count() << " ms)" << std::endl;
 
-    std::cout << "Total peers discovered: " << allPeers.size() << std::endl;
-
-    return allPeers;
+    return result.peers;
 }
 
 /*!
     \brief Get a list of peers from a specific DHT node.
-    \param node The DHT node address.
-    \param query The get_peers query to send to the node.
-    \return A vector of strings containing peer information.
+    \param address The DHT node address ("ip" or "ip:port").
+    \return The peers, deduplicated.
 */
-std::vector<std::string> DHTClient::getPeersFromNode(const std::string &node, const std::string &query)
+std::vector<PeerEndpoint> DHTClient::getPeersFromNode(const std::string &address)
 {
-    int sock = createSocket();
-
-    struct sockaddr_in dhtNode{};
-    dhtNode.sin_family = AF_INET;
-    dhtNode.sin_port = htons(DHT_PORT);
-
-    if (inet_pton(AF_INET, node.c_str(), &dhtNode.sin_addr) <= 0)
+    std::string host;
+    uint16_t port = DHT_PORT;
+    if (!HostResolver::splitHostPort(address, host, port))
     {
-#ifdef _WIN32
-        if (closesocket(sock) != 0)
-        {
-            std::cerr << "Failed to close socket" << std::endl;
-        }
-#else
-        if (close(sock) < 0)
-        {
-            std::cerr << "Failed to close socket" << std::endl;
-        }
-#endif
         throw std::runtime_error("Invalid DHT node address");
     }
 
-    if (sendto(sock, query.c_str(), query.size(), 0, (struct sockaddr *)&dhtNode, sizeof(dhtNode)) < 0)
-    {
-#ifdef _WIN32
-        if (closesocket(sock) != 0)
-        {
-            std::cerr << "Failed to close socket" << std::endl;
-        }
-#else
-        if (close(sock) < 0)
-        {
-            std::cerr << "Failed to close socket" << std::endl;
-        }
-#endif
-        throw std::runtime_error("Failed to send get_peers request");
-    }
-
-    char buffer[BUFFER_SIZE];
-    socklen_t addrLen = sizeof(dhtNode);
-    int recvLen = recvfrom(sock, buffer, BUFFER_SIZE, 0, (struct sockaddr *)&dhtNode, &addrLen);
-
-    std::vector<std::string> peers;
-    if (recvLen > 0)
-    {
-        std::string response(buffer, recvLen);
-        peers = parseResponse(response);
-    }
-
-#ifdef _WIN32
-    if (closesocket(sock) != 0)
+    ResolvedHost resolved = HostResolver::shared().resolve(host).get();
+    if (resolved.addresses.empty())
     {
-        std::cerr << "Failed to close socket" << std::endl;
+        throw std::runtime_error("Could not resolve DHT node " + host);
     }
-#else
-    if (close(sock) < 0)
-    {
-        std::cerr << "Failed to close socket" << std::endl;
-    }
-#endif
+    sockaddr_in nodeAddress = resolved.addresses.front();
+    nodeAddress.sin_port = htons(port);
+
+    PeersPromise peers = std::make_shared<std::promise<std::vector<PeerEndpoint>>>();
+    std::future<std::vector<PeerEndpoint>> result = peers->get_future();
+    node.post([this, nodeAddress, peers](DHTEngine &engine)
+              {
+        if (!sendGetPeers(engine, nodeAddress, peers))
+        {
+            peers->set_exception(std::make_exception_ptr(std::runtime_error("Failed to send get_peers request")));
+        } });
 
-    return peers;
+    return result.get();
 }
 
 /*!
     \brief Parses DHT response to extract peer info.
-    \param response The response from the DHT node.
-    \return A vector of strings containing peer information.
+    \param response The decoded response from the DHT node.
+    \return The peers, deduplicated.
 */
-std::vector<std::string> DHTClient::parseResponse(const std::string &response)
+std::vector<PeerEndpoint> DHTClient::parseResponse(const BencodeValue &response)
 {
-    std::vector<std::string> peers;
+    std::vector<PeerEndpoint> peers;
 
-    auto decoded = TorrentUtilities::decodeBencodedData(response);
-    if (decoded.find("r") == decoded.end())
+    BencodeValue values = response.find("r").find("values");
+    if (!values.isList())
     {
         return peers;
     }
 
-    size_t index = 0;
-    auto result = TorrentUtilities::decodeBencodedData(decoded["r"], index);
-
-    if (result.find("values") != result.end())
+    peers.reserve(values.size());
+    PeerEndpointSet seen(values.size());
+    for (BencodeValue value : values)
     {
-        auto peerList = TorrentUtilities::decodeBencodedList(result["values"], index);
-
-        for (const std::string &peerData : peerList)
+        PeerEndpoint peer = PeerEndpoint::fromCompact(value.asString());
+        if (seen.insert(peer))
         {
-            if (peerData.size() != 6)
-            {
-                continue;
-            }
-
-            uint8_t ip1 = static_cast<uint8_t>(peerData[0]);
-            uint8_t ip2 = static_cast<uint8_t>(peerData[1]);
-            uint8_t ip3 = static_cast<uint8_t>(peerData[2]);
-            uint8_t ip4 = static_cast<uint8_t>(peerData[3]);
-            uint16_t port = (static_cast<uint8_t>(peerData[4]) << 8) | static_cast<uint8_t>(peerData[5]);
-
-            std::ostringstream peerAddress;
-            peerAddress << static_cast<int>(ip1) << "."
-                        << static_cast<int>(ip2) << "."
-                        << static_cast<int>(ip3) << "."
-                        << static_cast<int>(ip4) << ":"
-                        << port;
-
-            peers.push_back(peerAddress.str());
+            peers.push_back(peer);
         }
     }
 
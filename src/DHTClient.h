@@ -14,9 +14,12 @@
 #define DHT_CLIENT_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <array>
 #include <cstdint>
+#include "BencodeDocument.h"
+#include "DHTNode.h"
 
 class DHTClient
 {
@@ -24,8 +27,9 @@ public:
     /*!
         \brief Constructor for DHTClient.
         \param infoHash The info hash of the torrent file.
+        \param node The DHT node to run lookups on; by default the one shared by the whole process.
     */
-    explicit DHTClient(const std::string &infoHash);
+    explicit DHTClient(const std::string &infoHash, DHTNode &node = DHTNode::shared());
 
     /*!
         \brief Destructor for DHTClient.
@@ -33,30 +37,33 @@ public:
     ~DHTClient();
 
     /*!
-        \brief Get a list of peers for the torrent file.
-        \return A vector of strings containing peer information.
+        \brief Get a list of peers for the torrent file with an iterative Kademlia lookup.
+        \return The peers, deduplicated.
     */
-    std::vector<std::string> getPeers();
+    std::vector<PeerEndpoint> getPeers();
 
     /*!
-        \brief Get a list of peers for the torrent file from multiple bootstrap nodes.
-        \return A vector of strings containing peer information.
+        \brief Build a get_peers query for this torrent.
+        \param transactionId The two-byte transaction ID to embed.
+        \return The bencoded query string.
     */
-    std::string buildGetPeersQuery();
+    std::string buildGetPeersQuery(std::string_view transactionId);
 
     /*!
-        \brief Fetch peers from a specific DHT node with a custom query.
-        \param node The DHT node address.
-        \param query The get_peers query to send to the node.
-        \return A vector of strings containing peer information.
+        \brief Fetch peers from a specific DHT node.
+        \param address The DHT node address ("host" or "host:port"); hostnames are resolved first.
+        \return The peers, deduplicated.
     */
-    std::vector<std::string> getPeersFromNode(const std::string &node, const std::string &query);
+    std::vector<PeerEndpoint> getPeersFromNode(const std::string &address);
 
 private:
-    std::string infoHash;                                                //!> The info hash of the torrent file.
-    int createSocket();                                                  //!> Creates a UDP socket for DHT communication.
-    std::vector<std::string> parseResponse(const std::string &response); //!> Parses DHT response to extract peer info.
-    std::array<uint8_t, 20> generateNodeID();                            //!> Generates a random 20-byte node ID
+    using PeersPromise = std::shared_ptr<std::promise<std::vector<PeerEndpoint>>>;
+
+    std::string infoHash;                                                                 //!> The info hash of the torrent file.
+    std::array<uint8_t, 20> infoHashBytes;                                                //!> Raw 20-byte info hash sent in queries.
+    DHTNode &node;                                                                        //!> Shared node that owns the socket and routing table.
+    bool sendGetPeers(DHTEngine &engine, const sockaddr_in &address, PeersPromise peers); //!> Queues a get_peers query on the node's engine.
+    std::vector<PeerEndpoint> parseResponse(const BencodeValue &response);                //!> Parses DHT response to extract peer info.
 };
 
 #endif
@@ -0,0 +1,567 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTEngine.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 12:41:30
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "DHTEngine.h"
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <random>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#define SEND_ROOM_WAIT 100 //!> Milliseconds to wait for the socket when the send pool is full and blocked
+
+/*!
+    \brief Check whether the last socket call failed only because it would have blocked.
+    \return True for EWOULDBLOCK/EAGAIN (or the Winsock equivalent).
+*/
+static bool wouldBlock()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EWOULDBLOCK || errno == EAGAIN;
+#endif
+}
+
+/*!
+    \brief Creates the engine and binds its UDP socket.
+    \param port Local port to bind; 0 picks an ephemeral port.
+    \throws std::runtime_error if the socket cannot be created or bound.
+*/
+DHTEngine::DHTEngine(uint16_t port)
+    : sendPool(SEND_BATCH * MAX_DATAGRAM), receivePool(RECEIVE_BATCH * MAX_DATAGRAM), receiveAddresses(RECEIVE_BATCH)
+{
+    sendQueue.reserve(SEND_BATCH);
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        throw std::runtime_error("WSAStartup failed");
+    }
+#endif
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+#ifdef _WIN32
+    if (sock == INVALID_SOCKET)
+    {
+        WSACleanup();
+        throw std::runtime_error("Failed to create UDP socket");
+    }
+    u_long nonBlocking = 1;
+    ioctlsocket(sock, FIONBIO, &nonBlocking);
+#else
+    if (sock < 0)
+    {
+        throw std::runtime_error("Failed to create UDP socket");
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (bind(sock, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0)
+    {
+        closeSocket();
+        throw std::runtime_error("Failed to bind DHT socket");
+    }
+
+    socklen_t localLen = sizeof(local);
+    if (getsockname(sock, reinterpret_cast<sockaddr *>(&local), &localLen) == 0)
+    {
+        boundPort = ntohs(local.sin_port);
+    }
+
+#ifdef __linux__
+    pollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (pollFd < 0)
+    {
+        closeSocket();
+        throw std::runtime_error("Failed to create epoll instance");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = sock;
+    epoll_ctl(pollFd, EPOLL_CTL_ADD, sock, &event);
+#endif
+
+    std::random_device rd;
+    nextTransaction = static_cast<uint16_t>(rd()); //!> Start somewhere unpredictable
+}
+
+/*!
+    \brief Closes the socket. Pending queries are dropped without calling their handlers.
+*/
+DHTEngine::~DHTEngine()
+{
+    closeSocket();
+}
+
+/*!
+    \brief Closes the socket and the poller.
+*/
+void DHTEngine::closeSocket()
+{
+#ifdef __linux__
+    if (pollFd >= 0)
+    {
+        close(pollFd);
+        pollFd = -1;
+    }
+#endif
+#ifdef _WIN32
+    if (sock != INVALID_SOCKET)
+    {
+        closesocket(sock);
+        WSACleanup();
+        sock = INVALID_SOCKET;
+    }
+#else
+    if (sock >= 0)
+    {
+        close(sock);
+        sock = -1;
+    }
+#endif
+}
+
+/*!
+    \brief Pick a transaction ID that is not in flight.
+    \param out Receives the two ID bytes.
+    \return The ID.
+*/
+uint16_t DHTEngine::allocateTransaction(char *out)
+{
+    if (pending.size() >= 0xFFFF)
+    {
+        throw std::runtime_error("Too many DHT queries in flight");
+    }
+
+    while (pending.count(nextTransaction) != 0)
+    {
+        nextTransaction++;
+    }
+
+    uint16_t id = nextTransaction++;
+    out[0] = static_cast<char>(id >> 8);
+    out[1] = static_cast<char>(id & 0xFF);
+    return id;
+}
+
+/*!
+    \brief Queue an encoded query and register it as pending.
+    \param to The node to query.
+    \param transaction The transaction ID written into the message.
+    \param length The encoded message size in the next free send pool slot.
+    \param onReply Completion handler.
+    \param timeout How long to wait for the reply.
+    \return False if the encoder produced nothing usable.
+*/
+bool DHTEngine::dispatch(const sockaddr_in &to, uint16_t transaction, size_t length, ReplyHandler onReply, std::chrono::milliseconds timeout)
+{
+    if (length == 0 || length > MAX_DATAGRAM)
+    {
+        return false;
+    }
+
+    sendQueue.push_back({to, transaction, length, false});
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point deadline = now + timeout;
+    pending[transaction] = PendingQuery{to, now, deadline, std::move(onReply)};
+    deadlines.push({deadline, transaction});
+    return true;
+}
+
+/*!
+    \brief Send every queued query, batching them into as few syscalls as possible.
+*/
+void DHTEngine::flush()
+{
+    size_t sent = 0;
+
+#ifdef __linux__
+    mmsghdr headers[SEND_BATCH];
+    iovec vectors[SEND_BATCH];
+    while (sent < sendQueue.size())
+    {
+        size_t count = sendQueue.size() - sent;
+        for (size_t i = 0; i < count; ++i)
+        {
+            OutgoingDatagram &datagram = sendQueue[sent + i];
+            vectors[i].iov_base = sendPool.data() + (sent + i) * MAX_DATAGRAM;
+            vectors[i].iov_len = datagram.length;
+            headers[i] = mmsghdr{};
+            headers[i].msg_hdr.msg_name = &datagram.to;
+            headers[i].msg_hdr.msg_namelen = sizeof(datagram.to);
+            headers[i].msg_hdr.msg_iov = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int result = sendmmsg(sock, headers, static_cast<unsigned int>(count), 0);
+        stats.sendCalls++;
+        if (result <= 0)
+        {
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result < 0 && wouldBlock())
+            {
+                break; //!> Socket buffer full; the rest goes out when it drains
+            }
+            if (!sendQueue[sent].isReply)
+            {
+                failQuery(sendQueue[sent].transaction); //!> The first datagram was refused; skip it and carry on
+            }
+            sent++;
+            continue;
+        }
+        stats.datagramsSent += static_cast<uint64_t>(result);
+        sent += static_cast<size_t>(result);
+    }
+#else
+    for (; sent < sendQueue.size(); ++sent)
+    {
+        const OutgoingDatagram &datagram = sendQueue[sent];
+        int result = sendto(sock, sendPool.data() + sent * MAX_DATAGRAM, static_cast<int>(datagram.length), 0,
+                            reinterpret_cast<const sockaddr *>(&datagram.to), sizeof(datagram.to));
+        stats.sendCalls++;
+        if (result < 0)
+        {
+            if (wouldBlock())
+            {
+                break; //!> Socket buffer full; the rest goes out when it drains
+            }
+            if (!datagram.isReply)
+            {
+                failQuery(datagram.transaction);
+            }
+            continue;
+        }
+        stats.datagramsSent++;
+    }
+#endif
+
+    keepUnsent(sent);
+}
+
+/*!
+    \brief Drop the datagrams that went out, moving the unsent ones to the front of the send pool.
+    \param sent How many datagrams at the head of the queue went out.
+*/
+void DHTEngine::keepUnsent(size_t sent)
+{
+    if (sent == sendQueue.size())
+    {
+        sendQueue.clear();
+        return;
+    }
+    for (size_t i = sent; i < sendQueue.size(); ++i)
+    {
+        std::memmove(sendPool.data() + (i - sent) * MAX_DATAGRAM, sendPool.data() + i * MAX_DATAGRAM, sendQueue[i].length);
+    }
+    sendQueue.erase(sendQueue.begin(), sendQueue.begin() + static_cast<std::ptrdiff_t>(sent));
+}
+
+/*!
+    \brief Free a send pool slot before queueing another datagram.
+    Flushes; if the socket still has no room, waits up to SEND_ROOM_WAIT for it, and failing
+    that gives up on the oldest datagram (its query times out).
+*/
+void DHTEngine::makeRoom()
+{
+    flush();
+    if (sendQueue.size() < SEND_BATCH)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    WSAPOLLFD entry{};
+    entry.fd = sock;
+    entry.events = POLLWRNORM;
+    WSAPoll(&entry, 1, SEND_ROOM_WAIT);
+#else
+    pollfd entry{};
+    entry.fd = sock;
+    entry.events = POLLOUT;
+    ::poll(&entry, 1, SEND_ROOM_WAIT);
+#endif
+    flush();
+    if (sendQueue.size() == SEND_BATCH)
+    {
+        if (!sendQueue.front().isReply)
+        {
+            failQuery(sendQueue.front().transaction);
+        }
+        keepUnsent(1);
+    }
+}
+
+/*!
+    \brief Make a query time out on the next expiry pass (used when its datagram could not be sent).
+    \param transaction The query's transaction ID.
+*/
+void DHTEngine::failQuery(uint16_t transaction)
+{
+    auto it = pending.find(transaction);
+    if (it != pending.end())
+    {
+        it->second.deadline = Clock::now();
+        deadlines.push({it->second.deadline, transaction});
+    }
+}
+
+/*!
+    \brief Wait for socket activity and process replies and expired queries.
+    Queued queries are flushed before waiting, and again afterwards so that follow-up
+    queries issued by the handlers go out in the same batch.
+    \param maxWait Upper bound on how long to block.
+    \return Number of handlers called.
+*/
+size_t DHTEngine::poll(std::chrono::milliseconds maxWait)
+{
+    flush();
+
+    //* Never sleep past the earliest deadline
+    while (!deadlines.empty() && pending.count(deadlines.top().transaction) == 0)
+    {
+        deadlines.pop();
+    }
+    if (!deadlines.empty())
+    {
+        auto untilDeadline = std::chrono::duration_cast<std::chrono::milliseconds>(deadlines.top().when - Clock::now());
+        if (untilDeadline < maxWait)
+        {
+            maxWait = untilDeadline < std::chrono::milliseconds(0) ? std::chrono::milliseconds(0) : untilDeadline + std::chrono::milliseconds(1);
+        }
+    }
+
+    int waitMs = static_cast<int>(maxWait.count());
+    bool readable = false;
+
+    //* Datagrams left queued by a full socket buffer go out as soon as it is writable again
+    bool blocked = !sendQueue.empty();
+#ifdef __linux__
+    if (blocked != watchingWrites)
+    {
+        epoll_event interest{};
+        interest.events = blocked ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        interest.data.fd = sock;
+        epoll_ctl(pollFd, EPOLL_CTL_MOD, sock, &interest);
+        watchingWrites = blocked;
+    }
+    epoll_event event;
+    int ready = epoll_wait(pollFd, &event, 1, waitMs);
+    readable = ready > 0 && event.events != EPOLLOUT;
+#elif defined(_WIN32)
+    WSAPOLLFD entry{};
+    entry.fd = sock;
+    entry.events = blocked ? POLLRDNORM | POLLWRNORM : POLLRDNORM;
+    readable = WSAPoll(&entry, 1, waitMs) > 0 && entry.revents != POLLWRNORM;
+#else
+    pollfd entry{};
+    entry.fd = sock;
+    entry.events = blocked ? POLLIN | POLLOUT : POLLIN;
+    readable = ::poll(&entry, 1, waitMs) > 0 && entry.revents != POLLOUT;
+#endif
+
+    size_t handled = 0;
+    if (readable)
+    {
+        handled += drainSocket();
+    }
+    handled += expireQueries();
+    flush();
+    return handled;
+}
+
+/*!
+    \brief Keep polling until every outstanding query has been answered or has timed out.
+*/
+void DHTEngine::runUntilIdle()
+{
+    while (!pending.empty())
+    {
+        poll(DEFAULT_TIMEOUT);
+    }
+}
+
+/*!
+    \brief Read every queued datagram without blocking, RECEIVE_BATCH at a time where the platform allows.
+    \return Number of handlers called.
+*/
+size_t DHTEngine::drainSocket()
+{
+    size_t handled = 0;
+
+#ifdef __linux__
+    mmsghdr headers[RECEIVE_BATCH];
+    iovec vectors[RECEIVE_BATCH];
+    while (true)
+    {
+        for (size_t i = 0; i < RECEIVE_BATCH; ++i)
+        {
+            vectors[i].iov_base = receivePool.data() + i * MAX_DATAGRAM;
+            vectors[i].iov_len = MAX_DATAGRAM;
+            headers[i] = mmsghdr{};
+            headers[i].msg_hdr.msg_name = &receiveAddresses[i];
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            headers[i].msg_hdr.msg_iov = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int received = recvmmsg(sock, headers, RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+        stats.receiveCalls++;
+        if (received <= 0)
+        {
+            break; //!> Would block; the queue is empty
+        }
+        stats.datagramsReceived += static_cast<uint64_t>(received);
+
+        for (int i = 0; i < received; ++i)
+        {
+            handled += handleDatagram(std::string_view(receivePool.data() + i * MAX_DATAGRAM, headers[i].msg_len), receiveAddresses[i]);
+        }
+
+        if (static_cast<size_t>(received) < RECEIVE_BATCH)
+        {
+            break; //!> Short batch: nothing else was queued
+        }
+    }
+#else
+    while (true)
+    {
+        sockaddr_in &from = receiveAddresses[0];
+        socklen_t fromLen = sizeof(from);
+        int received = recvfrom(sock, receivePool.data(), static_cast<int>(MAX_DATAGRAM), 0, reinterpret_cast<sockaddr *>(&from), &fromLen);
+        stats.receiveCalls++;
+        if (received < 0)
+        {
+            break; //!> Would block (or a transient ICMP error); either way the queue is empty
+        }
+        stats.datagramsReceived++;
+        handled += handleDatagram(std::string_view(receivePool.data(), static_cast<size_t>(received)), from);
+    }
+#endif
+
+    return handled;
+}
+
+/*!
+    \brief Decode one datagram and route it to its pending query, or to the query handler.
+    \param datagram The received bytes.
+    \param from The sender.
+    \return 1 if a reply handler was called, else 0.
+*/
+size_t DHTEngine::handleDatagram(std::string_view datagram, const sockaddr_in &from)
+{
+    try
+    {
+        replyDocument.parse(datagram);
+    }
+    catch (const std::runtime_error &)
+    {
+        return 0; //!> Not bencode; ignore
+    }
+
+    BencodeValue message = replyDocument.root();
+    std::string_view type = message.find("y").asString();
+    std::string_view transactionId = message.find("t").asString();
+    if (type == "q")
+    {
+        if (queryHandler)
+        {
+            if (sendQueue.size() == SEND_BATCH)
+            {
+                makeRoom();
+            }
+            size_t length = queryHandler(message, from, sendPool.data() + sendQueue.size() * MAX_DATAGRAM, MAX_DATAGRAM);
+            if (length > 0 && length <= MAX_DATAGRAM)
+            {
+                sendQueue.push_back({from, 0, length, true});
+            }
+        }
+        return 0;
+    }
+
+    if ((type != "r" && type != "e") || transactionId.size() != KrpcEncoder::TRANSACTION_ID_SIZE)
+    {
+        return 0; //!> Not a reply to anything we sent
+    }
+
+    uint16_t transaction = static_cast<uint16_t>((static_cast<uint8_t>(transactionId[0]) << 8) | static_cast<uint8_t>(transactionId[1]));
+    auto it = pending.find(transaction);
+    if (it == pending.end() ||
+        it->second.to.sin_addr.s_addr != from.sin_addr.s_addr ||
+        it->second.to.sin_port != from.sin_port)
+    {
+        return 0; //!> Late, duplicate or spoofed reply
+    }
+
+    PendingQuery query = std::move(it->second);
+    pending.erase(it);
+
+    DHTReply reply{false, message, query.to, std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - query.sentAt)};
+    query.onReply(reply);
+    return 1;
+}
+
+/*!
+    \brief Time out every query whose deadline has passed.
+    \return Number of handlers called.
+*/
+size_t DHTEngine::expireQueries()
+{
+    size_t expired = 0;
+    Clock::time_point now = Clock::now();
+
+    while (!deadlines.empty() && deadlines.top().when <= now)
+    {
+        Deadline top = deadlines.top();
+        deadlines.pop();
+
+        auto it = pending.find(top.transaction);
+        if (it == pending.end() || it->second.deadline != top.when)
+        {
+            continue; //!> Already answered (or the ID was reused)
+        }
+
+        PendingQuery query = std::move(it->second);
+        pending.erase(it);
+
+        DHTReply reply{true, BencodeValue(), query.to, std::chrono::duration_cast<std::chrono::milliseconds>(query.deadline - query.sentAt)};
+        query.onReply(reply);
+        expired++;
+    }
+
+    return expired;
+}
@@ -0,0 +1,212 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTEngine.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 12:41:09
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef DHT_ENGINE_H
+#define DHT_ENGINE_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+#include <string_view>
+#include <unordered_map>
+#include <queue>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "BencodeDocument.h"
+#include "KrpcEncoder.h"
+
+/*!
+    \brief Outcome of a query, delivered to its reply handler exactly once.
+*/
+struct DHTReply
+{
+    bool timedOut;                 //!> True if no reply arrived before the deadline.
+    BencodeValue message;          //!> The decoded reply (invalid on timeout); only valid during the callback.
+    sockaddr_in from;              //!> The node the query was sent to.
+    std::chrono::milliseconds rtt; //!> Round-trip time (the timeout on timeout).
+};
+
+/*!
+    \brief Socket I/O counters; datagrams per call shows how well batching is working.
+*/
+struct DHTIOStats
+{
+    uint64_t datagramsSent = 0;     //!> Datagrams handed to the kernel.
+    uint64_t sendCalls = 0;         //!> Send syscalls made.
+    uint64_t datagramsReceived = 0; //!> Datagrams read from the socket.
+    uint64_t receiveCalls = 0;      //!> Receive syscalls made.
+
+    double sentPerCall() const { return sendCalls == 0 ? 0.0 : static_cast<double>(datagramsSent) / sendCalls; }
+    double receivedPerCall() const { return receiveCalls == 0 ? 0.0 : static_cast<double>(datagramsReceived) / receiveCalls; }
+};
+
+class DHTEngine
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using ReplyHandler = std::function<void(const DHTReply &reply)>;
+    using QueryHandler = std::function<size_t(const BencodeValue &query, const sockaddr_in &from, char *reply, size_t capacity)>;
+
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+#else
+    using SocketHandle = int;
+#endif
+
+    /*!
+        \brief Creates the engine and binds its UDP socket.
+        \param port Local port to bind; 0 picks an ephemeral port.
+        \throws std::runtime_error if the socket cannot be created or bound.
+    */
+    explicit DHTEngine(uint16_t port = 0);
+
+    /*!
+        \brief Closes the socket. Pending queries are dropped without calling their handlers.
+    */
+    ~DHTEngine();
+
+    DHTEngine(const DHTEngine &) = delete;
+    DHTEngine &operator=(const DHTEngine &) = delete;
+
+    /*!
+        \brief Queue a query with a freshly assigned transaction ID.
+        Queries are encoded straight into the send pool and go out in one batch on the next
+        flush() or poll(), or as soon as the pool fills up. A query the kernel refuses, or
+        still has no room for once the pool is full, is reported to its handler as a timeout.
+        \param to The node to query.
+        \param encode Called as encode(char *buffer, std::string_view transactionId) and returns the message size.
+        \param onReply Called with the matching reply, or on timeout.
+        \param timeout How long to wait for the reply.
+        \return False if the message could not be encoded (the handler is not called).
+    */
+    template <typename Encoder>
+    bool sendQuery(const sockaddr_in &to, Encoder &&encode, ReplyHandler onReply,
+                   std::chrono::milliseconds timeout = DEFAULT_TIMEOUT)
+    {
+        if (sendQueue.size() == SEND_BATCH)
+        {
+            makeRoom();
+        }
+        char transactionId[KrpcEncoder::TRANSACTION_ID_SIZE];
+        uint16_t id = allocateTransaction(transactionId);
+        size_t length = encode(sendPool.data() + sendQueue.size() * MAX_DATAGRAM, std::string_view(transactionId, sizeof(transactionId)));
+        return dispatch(to, id, length, std::move(onReply), timeout);
+    }
+
+    /*!
+        \brief Send every queued query, batching them into as few syscalls as possible.
+        Datagrams the socket has no buffer space for stay queued; poll() waits for it to
+        become writable and sends them then.
+    */
+    void flush();
+
+    /*!
+        \brief Answer incoming queries (y = "q"); without a handler they are ignored.
+        The handler writes its reply into the given buffer and returns the size (0 sends nothing).
+        Replies are queued and sent with the next batch.
+        \param handler The responder.
+    */
+    void setQueryHandler(QueryHandler handler) { queryHandler = std::move(handler); }
+
+    /*!
+        \brief Wait for socket activity and process replies and expired queries.
+        \param maxWait Upper bound on how long to block.
+        \return Number of handlers called.
+    */
+    size_t poll(std::chrono::milliseconds maxWait);
+
+    /*!
+        \brief Keep polling until every outstanding query has been answered or has timed out.
+    */
+    void runUntilIdle();
+
+    /*!
+        \brief Number of queries awaiting a reply.
+        \return The in-flight count.
+    */
+    size_t pendingCount() const { return pending.size(); }
+
+    /*!
+        \brief Get the port the socket is bound to.
+        \return The local port in host order.
+    */
+    uint16_t localPort() const { return boundPort; }
+
+    /*!
+        \brief Get the socket I/O counters.
+        \return Datagram and syscall totals since construction.
+    */
+    const DHTIOStats &ioStats() const { return stats; }
+
+    static constexpr std::chrono::milliseconds DEFAULT_TIMEOUT{2000}; //!> Default per-query timeout.
+    static constexpr size_t MAX_DATAGRAM = 4096;                      //!> Largest datagram read or written.
+    static constexpr size_t SEND_BATCH = 64;                          //!> Queries queued before a forced flush.
+    static constexpr size_t RECEIVE_BATCH = 32;                       //!> Datagrams read per receive call.
+
+private:
+    struct PendingQuery
+    {
+        sockaddr_in to;             //!> Destination, checked against the reply's source.
+        Clock::time_point sentAt;   //!> When the query was sent.
+        Clock::time_point deadline; //!> When the query times out.
+        ReplyHandler onReply;       //!> Completion handler.
+    };
+
+    struct OutgoingDatagram
+    {
+        sockaddr_in to;       //!> Destination.
+        uint16_t transaction; //!> Transaction ID, to fail the query if the send is refused.
+        size_t length;        //!> Encoded size in its send pool slot.
+        bool isReply;         //!> Our reply to an incoming query (nothing to fail).
+    };
+
+    struct Deadline
+    {
+        Clock::time_point when; //!> Expiry time.
+        uint16_t transaction;   //!> Transaction it belongs to.
+        bool operator>(const Deadline &other) const { return when > other.when; }
+    };
+
+    SocketHandle sock;                                                                      //!> The one UDP socket.
+    int pollFd = -1;                                                                        //!> epoll instance (Linux only).
+    uint16_t boundPort = 0;                                                                 //!> Local port.
+    uint16_t nextTransaction = 0;                                                           //!> Next transaction ID to try.
+    std::unordered_map<uint16_t, PendingQuery> pending;                                     //!> In-flight queries by transaction ID.
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines; //!> Expiry order (lazily pruned).
+    BencodeDocument replyDocument;                                                          //!> Reused to decode every datagram.
+    std::vector<char> sendPool;                                                             //!> SEND_BATCH slots of MAX_DATAGRAM bytes; slot i holds sendQueue[i].
+    std::vector<OutgoingDatagram> sendQueue;                                                //!> Queries and replies encoded but not yet sent.
+    std::vector<char> receivePool;                                                          //!> RECEIVE_BATCH slots of MAX_DATAGRAM bytes.
+    std::vector<sockaddr_in> receiveAddresses;                                              //!> Sender of each receive slot.
+    QueryHandler queryHandler;                                                              //!> Responder for incoming queries.
+    DHTIOStats stats;                                                                       //!> Socket I/O counters.
+    bool watchingWrites = false;                                                            //!> Waiting for the socket to take the queued datagrams (Linux only).
+
+    uint16_t allocateTransaction(char *out);
+    bool dispatch(const sockaddr_in &to, uint16_t transaction, size_t length, ReplyHandler onReply, std::chrono::milliseconds timeout);
+    size_t drainSocket();
+    void makeRoom();
+    void keepUnsent(size_t sent);
+    size_t handleDatagram(std::string_view datagram, const sockaddr_in &from);
+    size_t expireQueries();
+    void failQuery(uint16_t transaction);
+    void closeSocket();
+};
+
+#endif
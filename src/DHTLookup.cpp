@@ -0,0 +1,288 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTLookup.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 13:44:20
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "DHTLookup.h"
+#include "KrpcEncoder.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#define MAX_CANDIDATES (RoutingTable::K * 8)
+
+/*!
+    \brief Pack an IPv4 address and port into one key.
+    \param address The address.
+    \return The key.
+*/
+uint64_t DHTUnresponsiveNodes::addressKey(const sockaddr_in &address)
+{
+    return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+/*!
+    \brief Record that a node did not answer.
+    \param address The node's address.
+*/
+void DHTUnresponsiveNodes::add(const sockaddr_in &address)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (skipUntil.size() >= MAX_ENTRIES)
+    {
+        for (auto it = skipUntil.begin(); it != skipUntil.end();)
+        {
+            it = it->second <= now ? skipUntil.erase(it) : std::next(it);
+        }
+    }
+    if (skipUntil.size() < MAX_ENTRIES)
+    {
+        skipUntil[addressKey(address)] = now + QUARANTINE;
+    }
+}
+
+/*!
+    \brief Check whether a node timed out within the quarantine period.
+    \param address The node's address.
+    \return True if it should be skipped.
+*/
+bool DHTUnresponsiveNodes::contains(const sockaddr_in &address) const
+{
+    auto it = skipUntil.find(addressKey(address));
+    return it != skipUntil.end() && it->second > std::chrono::steady_clock::now();
+}
+
+/*!
+    \brief Creates a lookup for an info hash.
+    \param engine Engine to send queries through.
+    \param table Routing table used for seeds and updated with responders.
+    \param target The info hash to find peers for.
+*/
+DHTLookup::DHTLookup(DHTEngine &engine, RoutingTable &table, const NodeId &target)
+    : engine(engine), table(table), target(target) {}
+
+/*!
+    \brief Add a node with no known ID (e.g. a bootstrap router); it is queried first.
+    \param address The node's address.
+*/
+void DHTLookup::addBootstrapNode(const sockaddr_in &address)
+{
+    if (findCandidate(address) == nullptr)
+    {
+        candidates.insert(candidates.begin(), Candidate{NodeId{}, false, address, CandidateState::Fresh});
+    }
+}
+
+/*!
+    \brief Seed from the routing table and send the first queries.
+*/
+void DHTLookup::start()
+{
+    for (const RoutingEntry &entry : table.closest(target, RoutingTable::K * 2))
+    {
+        addCandidate(entry.id, entry.address);
+    }
+    sortCandidates();
+    pump();
+}
+
+/*!
+    \brief Number of nodes that answered.
+    \return The responder count.
+*/
+size_t DHTLookup::respondersCount() const
+{
+    return static_cast<size_t>(std::count_if(candidates.begin(), candidates.end(), [](const Candidate &candidate)
+                                             { return candidate.state == CandidateState::Responded; }));
+}
+
+/*!
+    \brief Find a candidate by address.
+    \param address The address to match.
+    \return The candidate, or nullptr.
+*/
+DHTLookup::Candidate *DHTLookup::findCandidate(const sockaddr_in &address)
+{
+    for (Candidate &candidate : candidates)
+    {
+        if (candidate.address.sin_addr.s_addr == address.sin_addr.s_addr && candidate.address.sin_port == address.sin_port)
+        {
+            return &candidate;
+        }
+    }
+    return nullptr;
+}
+
+/*!
+    \brief Add a node learned from a reply to the shortlist.
+    \param id The node's ID.
+    \param address The node's address.
+*/
+void DHTLookup::addCandidate(const NodeId &id, const sockaddr_in &address)
+{
+    if (id == table.self() || address.sin_port == 0 || findCandidate(address) != nullptr)
+    {
+        return;
+    }
+    for (const Candidate &candidate : candidates)
+    {
+        if (candidate.hasId && candidate.id == id)
+        {
+            return;
+        }
+    }
+    candidates.push_back(Candidate{id, true, address, CandidateState::Fresh});
+}
+
+/*!
+    \brief Order the shortlist: ID-less bootstrap nodes first, then by distance to the target.
+    Far-away candidates that were never queried are trimmed.
+*/
+void DHTLookup::sortCandidates()
+{
+    std::stable_sort(candidates.begin(), candidates.end(), [this](const Candidate &a, const Candidate &b)
+                     {
+        if (a.hasId != b.hasId)
+            return !a.hasId;
+        return a.hasId && RoutingTable::closer(target, a.id, b.id); });
+
+    while (candidates.size() > MAX_CANDIDATES && candidates.back().state == CandidateState::Fresh)
+    {
+        candidates.pop_back();
+    }
+}
+
+/*!
+    \brief Send queries to the closest unqueried candidates, up to ALPHA in flight.
+    Marks the lookup done when the K closest live candidates have all answered.
+*/
+void DHTLookup::pump()
+{
+    if (done)
+    {
+        return;
+    }
+
+    size_t live = 0;
+    for (Candidate &candidate : candidates)
+    {
+        if (inFlight >= ALPHA || sent >= MAX_QUERIES)
+        {
+            break;
+        }
+        if (candidate.state == CandidateState::Failed)
+        {
+            continue;
+        }
+        if (candidate.hasId && ++live > RoutingTable::K)
+        {
+            break;
+        }
+        if (candidate.state != CandidateState::Fresh)
+        {
+            continue;
+        }
+        if (unresponsive != nullptr && unresponsive->contains(candidate.address))
+        {
+            candidate.state = CandidateState::Failed;
+            continue;
+        }
+
+        candidate.state = CandidateState::InFlight;
+        bool queued = engine.sendQuery(
+            candidate.address,
+            [this](char *buffer, std::string_view transactionId)
+            { return KrpcEncoder::encodeGetPeers(buffer, transactionId, table.self(), target); },
+            [this](const DHTReply &reply)
+            { onReply(reply); },
+            QUERY_TIMEOUT);
+
+        if (queued)
+        {
+            inFlight++;
+            sent++;
+        }
+        else
+        {
+            candidate.state = CandidateState::Failed;
+        }
+    }
+
+    if (inFlight == 0)
+    {
+        done = true;
+    }
+}
+
+/*!
+    \brief Handle a get_peers reply or timeout.
+    \param reply The reply from the engine.
+*/
+void DHTLookup::onReply(const DHTReply &reply)
+{
+    inFlight--;
+    Candidate *candidate = findCandidate(reply.from);
+
+    if (reply.timedOut || reply.message.find("y").asString() != "r")
+    {
+        if (candidate != nullptr)
+        {
+            candidate->state = CandidateState::Failed;
+        }
+        table.markFailed(reply.from);
+        if (reply.timedOut && unresponsive != nullptr)
+        {
+            unresponsive->add(reply.from);
+        }
+        pump();
+        return;
+    }
+
+    BencodeValue response = reply.message.find("r");
+    std::string_view responderId = response.find("id").asString();
+
+    if (candidate != nullptr)
+    {
+        candidate->state = CandidateState::Responded;
+        if (responderId.size() == 20)
+        {
+            std::memcpy(candidate->id.data(), responderId.data(), 20);
+            candidate->hasId = true;
+        }
+    }
+
+    if (responderId.size() == 20)
+    {
+        NodeId id;
+        std::memcpy(id.data(), responderId.data(), 20);
+        table.insert(id, reply.from);
+    }
+
+    for (BencodeValue value : response.find("values"))
+    {
+        PeerEndpoint peer = PeerEndpoint::fromCompact(value.asString());
+        if (seenPeers.insert(peer))
+        {
+            peers.push_back(peer);
+        }
+    }
+
+    std::string_view nodes = response.find("nodes").asString();
+    for (size_t offset = 0; offset + RoutingTable::COMPACT_NODE_SIZE <= nodes.size(); offset += RoutingTable::COMPACT_NODE_SIZE)
+    {
+        NodeId id;
+        sockaddr_in address;
+        RoutingTable::decodeCompactNode(nodes.data() + offset, id, address);
+        addCandidate(id, address);
+    }
+
+    sortCandidates();
+    pump();
+}
@@ -0,0 +1,151 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTLookup.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 13:44:02
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef DHT_LOOKUP_H
+#define DHT_LOOKUP_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include "DHTEngine.h"
+#include "RoutingTable.h"
+#include "PeerEndpoint.h"
+
+/*!
+    \brief Remote nodes that recently timed out, shared by concurrent lookups so that a dead
+    node costs one timeout rather than one per lookup.
+*/
+class DHTUnresponsiveNodes
+{
+public:
+    static constexpr std::chrono::seconds QUARANTINE{60}; //!> How long a silent node is skipped.
+    static constexpr size_t MAX_ENTRIES = 4096;           //!> Entries kept before expired ones are pruned.
+
+    /*!
+        \brief Record that a node did not answer.
+        \param address The node's address.
+    */
+    void add(const sockaddr_in &address);
+
+    /*!
+        \brief Check whether a node timed out within the quarantine period.
+        \param address The node's address.
+        \return True if it should be skipped.
+    */
+    bool contains(const sockaddr_in &address) const;
+
+private:
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> skipUntil; //!> Quarantine end by address key.
+
+    static uint64_t addressKey(const sockaddr_in &address);
+};
+
+/*!
+    \brief Iterative Kademlia get_peers lookup.
+    Keeps ALPHA queries in flight, always querying the closest unqueried candidates,
+    and finishes once the K closest live candidates have all answered. Replies feed the
+    routing table. The lookup must outlive its in-flight queries (run the engine until idle).
+*/
+class DHTLookup
+{
+public:
+    static constexpr size_t ALPHA = 3;                              //!> Parallel queries.
+    static constexpr size_t MAX_QUERIES = 256;                      //!> Hard cap on queries per lookup.
+    static constexpr std::chrono::milliseconds QUERY_TIMEOUT{1500}; //!> Per-query timeout.
+
+    /*!
+        \brief Creates a lookup for an info hash.
+        \param engine Engine to send queries through.
+        \param table Routing table used for seeds and updated with responders.
+        \param target The info hash to find peers for.
+    */
+    DHTLookup(DHTEngine &engine, RoutingTable &table, const NodeId &target);
+
+    /*!
+        \brief Add a node with no known ID (e.g. a bootstrap router); it is queried first.
+        \param address The node's address.
+    */
+    void addBootstrapNode(const sockaddr_in &address);
+
+    /*!
+        \brief Share timeout knowledge with other lookups; quarantined nodes are not queried.
+        \param nodes The shared set (must outlive the lookup), or nullptr.
+    */
+    void setUnresponsiveNodes(DHTUnresponsiveNodes *nodes) { unresponsive = nodes; }
+
+    /*!
+        \brief Seed from the routing table and send the first queries.
+    */
+    void start();
+
+    /*!
+        \brief Check whether the lookup has converged.
+        \return True when nothing is in flight and nothing useful is left to query.
+    */
+    bool isDone() const { return done; }
+
+    /*!
+        \brief Peers collected from `values`, deduplicated.
+        \return The peer list.
+    */
+    const std::vector<PeerEndpoint> &getPeers() const { return peers; }
+
+    /*!
+        \brief Number of queries sent.
+        \return The query count.
+    */
+    size_t queriesSent() const { return sent; }
+
+    /*!
+        \brief Number of nodes that answered.
+        \return The responder count.
+    */
+    size_t respondersCount() const;
+
+private:
+    enum class CandidateState : uint8_t
+    {
+        Fresh,
+        InFlight,
+        Responded,
+        Failed
+    };
+
+    struct Candidate
+    {
+        NodeId id;            //!> Node ID (meaningless until known).
+        bool hasId;           //!> False for bootstrap nodes until they answer.
+        sockaddr_in address;  //!> Where to send queries.
+        CandidateState state; //!> Progress of this candidate.
+    };
+
+    DHTEngine &engine;                            //!> Query transport.
+    RoutingTable &table;                          //!> Shared routing table.
+    NodeId target;                                //!> Info hash being looked up.
+    std::vector<Candidate> candidates;            //!> Shortlist: bootstrap nodes first, then nearest first.
+    PeerEndpointSet seenPeers;                    //!> Peers already collected.
+    std::vector<PeerEndpoint> peers;              //!> Collected peers.
+    DHTUnresponsiveNodes *unresponsive = nullptr; //!> Shared quarantine, if any.
+    size_t inFlight = 0;                          //!> Queries awaiting replies.
+    size_t sent = 0;                              //!> Queries sent.
+    bool done = false;                            //!> Lookup finished.
+
+    void addCandidate(const NodeId &id, const sockaddr_in &address);
+    void pump();
+    void onReply(const DHTReply &reply);
+    void sortCandidates();
+    Candidate *findCandidate(const sockaddr_in &address);
+};
+
+#endif
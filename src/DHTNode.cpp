@@ -0,0 +1,342 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTNode.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 15:27:12
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "DHTNode.h"
+#include <iostream>
+#include <stdexcept>
+#include <random>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+#define DHT_PORT 6881
+#define DHT_STATE_FILE "dht_state.dat"
+
+/*!
+    \brief Loads the saved node ID and routing table (if any) and starts the node thread.
+    \param port Local UDP port; 0 picks an ephemeral port.
+    \param stateFile Where the routing table is persisted between runs.
+*/
+DHTNode::DHTNode(uint16_t port, const std::string &stateFile)
+    : stateFile(stateFile), nodeID(generateNodeID()), engine(port), routingTable(nodeID), server(routingTable)
+{
+    //* Warm start: reuse our node ID and the nodes that answered us last time
+    std::vector<RoutingEntry> savedNodes;
+    NodeId savedID;
+    if (RoutingTable::load(stateFile, savedID, savedNodes))
+    {
+        nodeID = savedID;
+        routingTable = RoutingTable(nodeID);
+        for (const RoutingEntry &node : savedNodes)
+        {
+            routingTable.insert(node.id, node.address);
+        }
+        std::cout << "Loaded " << routingTable.size() << " DHT nodes from " << stateFile << std::endl;
+    }
+
+    std::vector<std::string> routers = {
+        "67.215.246.10",
+        "router.bittorrent.com",
+        "dht.transmissionbt.com"};
+
+    //* Resolve every router in parallel; lookups wait for them only while the table is cold
+    for (const auto &node : routers)
+    {
+        std::string host;
+        uint16_t port = DHT_PORT;
+        if (!HostResolver::splitHostPort(node, host, port))
+        {
+            std::cerr << "Skipping bootstrap node " << node << ": Invalid DHT node address" << std::endl;
+            continue;
+        }
+        pendingRouters.push_back({node, HostResolver::shared().resolve(host), port});
+    }
+    routersDeadline = std::chrono::steady_clock::now() + BOOTSTRAP_RESOLVE_TIMEOUT;
+
+    engine.setQueryHandler([this](const BencodeValue &query, const sockaddr_in &from, char *reply, size_t capacity)
+                           { return server.respond(query, from, reply, capacity); });
+
+    worker = std::thread(&DHTNode::run, this);
+}
+
+/*!
+    \brief Stops the node thread and saves the routing table.
+*/
+DHTNode::~DHTNode()
+{
+    stopping = true;
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+
+    if (routingTable.size() > 0 && !routingTable.save(stateFile))
+    {
+        std::cerr << "Failed to save DHT state to " << stateFile << std::endl;
+    }
+}
+
+/*!
+    \brief The process-wide node, created on first use.
+    \return The shared node.
+*/
+DHTNode &DHTNode::shared()
+{
+    static DHTNode node(0, DHT_STATE_FILE);
+    return node;
+}
+
+/*!
+    \brief Generates a random 20-byte node ID.
+    \return The node ID.
+*/
+NodeId DHTNode::generateNodeID()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 255);
+
+    NodeId id;
+    for (uint8_t &byte : id)
+    {
+        byte = static_cast<uint8_t>(dis(gen));
+    }
+    return id;
+}
+
+/*!
+    \brief Move routers whose names have resolved into bootstrapNodes.
+    \return True once no router is worth waiting for any longer.
+*/
+bool DHTNode::collectRouters()
+{
+    for (auto it = pendingRouters.begin(); it != pendingRouters.end();)
+    {
+        if (it->resolved.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        const ResolvedHost &resolved = it->resolved.get();
+        if (resolved.addresses.empty())
+        {
+            std::cerr << "Skipping bootstrap node " << it->name << ": Could not resolve host" << std::endl;
+        }
+        for (sockaddr_in address : resolved.addresses)
+        {
+            address.sin_port = htons(it->port);
+            bootstrapNodes.push_back(address);
+        }
+        it = pendingRouters.erase(it);
+    }
+
+    return pendingRouters.empty() || std::chrono::steady_clock::now() >= routersDeadline;
+}
+
+/*!
+    \brief Look up peers for an info hash.
+    \param infoHash The torrent's info hash.
+    \param callback Called on the node thread when the lookup finishes.
+*/
+void DHTNode::findPeers(const NodeId &infoHash, LookupCallback callback)
+{
+    post([this, infoHash, callback = std::move(callback)](DHTEngine &) mutable
+         { queueLookup(infoHash, std::move(callback)); });
+}
+
+/*!
+    \brief Look up peers for an info hash.
+    \param infoHash The torrent's info hash.
+    \return Becomes ready when the lookup finishes.
+*/
+std::future<DHTLookupResult> DHTNode::findPeers(const NodeId &infoHash)
+{
+    auto promise = std::make_shared<std::promise<DHTLookupResult>>();
+    std::future<DHTLookupResult> result = promise->get_future();
+    findPeers(infoHash, [promise](const DHTLookupResult &lookupResult)
+              { promise->set_value(lookupResult); });
+    return result;
+}
+
+/*!
+    \brief Run a function on the node thread with access to the engine.
+    \param task The function.
+*/
+void DHTNode::post(Task task)
+{
+    std::lock_guard<std::mutex> lock(taskMutex);
+    tasks.push_back(std::move(task));
+}
+
+/*!
+    \brief Node thread: pick up requests, drive the engine and deliver finished lookups.
+*/
+void DHTNode::run()
+{
+    while (!stopping)
+    {
+        try
+        {
+            runTasks();
+            startLookups();
+            engine.poll(TASK_POLL_INTERVAL);
+            finishLookups();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "DHT node error: " << e.what() << std::endl;
+        }
+    }
+}
+
+/*!
+    \brief Run everything posted since the last pass.
+*/
+void DHTNode::runTasks()
+{
+    std::vector<Task> ready;
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        ready.swap(tasks);
+    }
+    for (Task &task : ready)
+    {
+        task(engine);
+    }
+}
+
+/*!
+    \brief Attach a request to a running or queued lookup for the same info hash, or queue a new one.
+    \param infoHash The torrent's info hash.
+    \param callback Completion callback.
+*/
+void DHTNode::queueLookup(const NodeId &infoHash, LookupCallback callback)
+{
+    auto running = active.find(infoHash);
+    if (running != active.end())
+    {
+        running->second.callbacks.push_back(std::move(callback));
+        return;
+    }
+
+    auto queued = waiting.find(infoHash);
+    if (queued != waiting.end())
+    {
+        queued->second.callbacks.push_back(std::move(callback));
+        return;
+    }
+
+    waiting[infoHash].callbacks.push_back(std::move(callback));
+    waitingOrder.push_back(infoHash);
+}
+
+/*!
+    \brief Start queued lookups while there is room.
+    Each starts from the shared routing table, so later lookups benefit from the nodes
+    earlier ones discovered; the bootstrap routers are only used while the table is cold
+    (fewer than K nodes that closest() would return).
+*/
+void DHTNode::startLookups()
+{
+    bool routersReady = collectRouters();
+    if (routingTable.healthySize() < RoutingTable::K && !routersReady && !waitingOrder.empty())
+    {
+        return; //* Cold table: give the router names a moment to resolve
+    }
+
+    while (active.size() < MAX_ACTIVE_LOOKUPS && !waitingOrder.empty())
+    {
+        NodeId infoHash = waitingOrder.front();
+        waitingOrder.pop_front();
+
+        auto queued = waiting.find(infoHash);
+        Lookup entry = std::move(queued->second);
+        waiting.erase(queued);
+
+        DHTLookup &lookup = launch(infoHash, entry, routingTable.healthySize() < RoutingTable::K);
+        active.emplace(infoHash, std::move(entry));
+        lookup.start();
+    }
+}
+
+/*!
+    \brief Create the lookup for a queued entry.
+    \param infoHash The info hash.
+    \param entry The entry; receives the lookup.
+    \param bootstrap True to seed it with the bootstrap routers as well as the routing table.
+    \return The lookup (not started yet).
+*/
+DHTLookup &DHTNode::launch(const NodeId &infoHash, Lookup &entry, bool bootstrap)
+{
+    entry.lookup = std::make_unique<DHTLookup>(engine, routingTable, infoHash);
+    entry.lookup->setUnresponsiveNodes(&unresponsive);
+    if (bootstrap)
+    {
+        for (const sockaddr_in &address : bootstrapNodes)
+        {
+            entry.lookup->addBootstrapNode(address);
+        }
+        entry.bootstrapped = !bootstrapNodes.empty();
+    }
+    return *entry.lookup;
+}
+
+/*!
+    \brief Deliver every lookup that has converged and free its slot.
+*/
+void DHTNode::finishLookups()
+{
+    for (auto it = active.begin(); it != active.end();)
+    {
+        DHTLookup &lookup = *it->second.lookup;
+        if (!lookup.isDone())
+        {
+            ++it;
+            continue;
+        }
+        if (lookup.respondersCount() == 0 && !it->second.bootstrapped)
+        {
+            collectRouters();
+            if (!bootstrapNodes.empty())
+            {
+                //* Nobody in the table answered (a stale snapshot, say): try again from the routers
+                launch(it->first, it->second, true).start();
+                ++it;
+                continue;
+            }
+        }
+
+        DHTLookupResult result{lookup.getPeers(), lookup.queriesSent()};
+        std::vector<LookupCallback> callbacks = std::move(it->second.callbacks);
+        it = active.erase(it);
+
+        const DHTIOStats &io = engine.ioStats();
+        const DHTServerStats &served = server.stats();
+        std::cout << "DHT lookup finished: " << result.peers.size() << " peers (" << result.queries << " queries, "
+                  << routingTable.size() << " nodes known, " << active.size() << " lookups still running)" << std::endl;
+        std::cout << "DHT socket: " << io.datagramsSent << " sent in " << io.sendCalls << " calls ("
+                  << io.sentPerCall() << "/call), " << io.datagramsReceived << " received in " << io.receiveCalls
+                  << " calls (" << io.receivedPerCall() << "/call)" << std::endl;
+        std::cout << "DHT server: answered " << served.answered << " queries (" << served.rateLimited << " rate limited, "
+                  << served.announces << " announces, " << server.peerStore().peerCount() << " peers stored)" << std::endl;
+
+        for (LookupCallback &callback : callbacks)
+        {
+            callback(result);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTNode.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 15:26:38
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef DHT_NODE_H
+#define DHT_NODE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "DHTEngine.h"
+#include "RoutingTable.h"
+#include "DHTLookup.h"
+#include "DHTServer.h"
+#include "HostResolver.h"
+
+/*!
+    \brief Outcome of one get_peers lookup.
+*/
+struct DHTLookupResult
+{
+    std::vector<PeerEndpoint> peers; //!> Peers found.
+    size_t queries;                  //!> Queries the lookup sent.
+};
+
+/*!
+    \brief One DHT node shared by every torrent in the process.
+    Owns the node ID, the UDP engine, the routing table and the responder, and runs them on
+    a single background thread. Any thread may request lookups; up to MAX_ACTIVE_LOOKUPS run
+    concurrently on the shared engine and the rest wait their turn. Requests for an info hash
+    that is already being looked up join that lookup instead of starting another, and nodes that
+    time out are quarantined for all lookups. Results are delivered on the node thread.
+*/
+class DHTNode
+{
+public:
+    using LookupCallback = std::function<void(const DHTLookupResult &result)>;
+    using Task = std::function<void(DHTEngine &engine)>;
+
+    static constexpr size_t MAX_ACTIVE_LOOKUPS = 16;                    //!> Lookups running at once.
+    static constexpr std::chrono::milliseconds TASK_POLL_INTERVAL{50};  //!> Longest a posted request waits to be picked up.
+    static constexpr std::chrono::seconds BOOTSTRAP_RESOLVE_TIMEOUT{5}; //!> Longest a cold lookup waits for router names.
+
+    /*!
+        \brief Loads the saved node ID and routing table (if any) and starts the node thread.
+        \param port Local UDP port; 0 picks an ephemeral port.
+        \param stateFile Where the routing table is persisted between runs.
+        \throws std::runtime_error if the socket cannot be created.
+    */
+    DHTNode(uint16_t port, const std::string &stateFile);
+
+    /*!
+        \brief Stops the node thread and saves the routing table. Unfinished lookups are dropped.
+    */
+    ~DHTNode();
+
+    DHTNode(const DHTNode &) = delete;
+    DHTNode &operator=(const DHTNode &) = delete;
+
+    /*!
+        \brief The process-wide node, created on first use.
+        \return The shared node.
+    */
+    static DHTNode &shared();
+
+    /*!
+        \brief Look up peers for an info hash.
+        \param infoHash The torrent's info hash.
+        \param callback Called on the node thread when the lookup finishes.
+    */
+    void findPeers(const NodeId &infoHash, LookupCallback callback);
+
+    /*!
+        \brief Look up peers for an info hash.
+        \param infoHash The torrent's info hash.
+        \return Becomes ready when the lookup finishes.
+    */
+    std::future<DHTLookupResult> findPeers(const NodeId &infoHash);
+
+    /*!
+        \brief Run a function on the node thread with access to the engine.
+        \param task The function; it must not block.
+    */
+    void post(Task task);
+
+    /*!
+        \brief Get our node ID.
+        \return The ID.
+    */
+    const NodeId &id() const { return nodeID; }
+
+private:
+    struct PendingRouter
+    {
+        std::string name;                          //!> Router as configured, for logging.
+        std::shared_future<ResolvedHost> resolved; //!> In-flight name resolution.
+        uint16_t port;                             //!> Router port.
+    };
+
+    struct Lookup
+    {
+        std::unique_ptr<DHTLookup> lookup;     //!> The running lookup (null while queued).
+        std::vector<LookupCallback> callbacks; //!> Everyone waiting for this info hash.
+        bool bootstrapped = false;             //!> The bootstrap routers were among its seeds.
+    };
+
+    std::string stateFile;                                 //!> Routing table snapshot path.
+    NodeId nodeID;                                         //!> Our node ID.
+    DHTEngine engine;                                      //!> Single UDP socket shared by every lookup.
+    RoutingTable routingTable;                             //!> k-buckets around nodeID.
+    DHTServer server;                                      //!> Answers other nodes' queries.
+    DHTUnresponsiveNodes unresponsive;                     //!> Quarantine shared by all lookups.
+    std::map<NodeId, Lookup> active;                       //!> Running lookups by info hash.
+    std::map<NodeId, Lookup> waiting;                      //!> Queued lookups by info hash.
+    std::deque<NodeId> waitingOrder;                       //!> Queue order for waiting.
+    std::vector<sockaddr_in> bootstrapNodes;               //!> Routers used while the table is cold.
+    std::vector<PendingRouter> pendingRouters;             //!> Routers whose names are still resolving.
+    std::chrono::steady_clock::time_point routersDeadline; //!> Stop waiting for pendingRouters after this.
+    std::mutex taskMutex;                                  //!> Guards tasks.
+    std::vector<Task> tasks;                               //!> Work posted from other threads.
+    std::atomic<bool> stopping{false};                     //!> Tells the node thread to exit.
+    std::thread worker;                                    //!> The node thread.
+
+    void run();
+    void runTasks();
+    void queueLookup(const NodeId &infoHash, LookupCallback callback);
+    bool collectRouters();
+    void startLookups();
+    void finishLookups();
+    DHTLookup &launch(const NodeId &infoHash, Lookup &entry, bool bootstrap);
+
+    static NodeId generateNodeID();
+};
+
+#endif
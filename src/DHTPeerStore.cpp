@@ -0,0 +1,146 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTPeerStore.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 14:32:41
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "DHTPeerStore.h"
+#include <algorithm>
+#include <cstring>
+
+/*!
+    \brief Creates an empty store.
+*/
+DHTPeerStore::DHTPeerStore() : epoch(std::chrono::steady_clock::now()), random(std::random_device{}()) {}
+
+/*!
+    \brief Hash an info hash; its bytes are already uniformly distributed.
+    \param id The info hash.
+    \return The hash value.
+*/
+size_t DHTPeerStore::InfoHashHasher::operator()(const NodeId &id) const
+{
+    size_t value;
+    std::memcpy(&value, id.data(), sizeof(value));
+    return value;
+}
+
+/*!
+    \brief Current time in seconds since the store was created.
+    \return The time.
+*/
+uint32_t DHTPeerStore::now() const
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+/*!
+    \brief Record an announce, refreshing the peer if it is already stored.
+    \param infoHash The torrent.
+    \param compactPeer The peer's 6-byte compact endpoint.
+    \return False if the store had no room.
+*/
+bool DHTPeerStore::announce(const NodeId &infoHash, const char *compactPeer)
+{
+    uint32_t expiresAt = now() + static_cast<uint32_t>(PEER_TTL.count());
+
+    auto it = torrents.find(infoHash);
+    if (it == torrents.end())
+    {
+        if (torrents.size() >= MAX_TORRENTS)
+        {
+            return false; //!> No sweep here: remote nodes pick the info hashes, so each would cost O(store)
+        }
+        it = torrents.emplace(infoHash, std::vector<StoredPeer>()).first;
+    }
+
+    std::vector<StoredPeer> &peers = it->second;
+    for (StoredPeer &peer : peers)
+    {
+        if (std::memcmp(peer.endpoint.data(), compactPeer, COMPACT_PEER_SIZE) == 0)
+        {
+            peer.expiresAt = expiresAt;
+            return true;
+        }
+    }
+
+    StoredPeer fresh{expiresAt, {}};
+    std::memcpy(fresh.endpoint.data(), compactPeer, COMPACT_PEER_SIZE);
+
+    if (peers.size() < MAX_PEERS_PER_TORRENT)
+    {
+        peers.push_back(fresh);
+        totalPeers++;
+    }
+    else
+    {
+        auto stalest = std::min_element(peers.begin(), peers.end(), [](const StoredPeer &a, const StoredPeer &b)
+                                        { return a.expiresAt < b.expiresAt; });
+        *stalest = fresh;
+    }
+    return true;
+}
+
+/*!
+    \brief Get live peers for a torrent, starting at a random offset.
+    \param infoHash The torrent.
+    \param max Maximum number of peers to return.
+    \param out Receives 6-byte compact endpoints.
+    \return Number of peers added to out.
+*/
+size_t DHTPeerStore::getPeers(const NodeId &infoHash, size_t max, std::vector<std::string_view> &out)
+{
+    auto it = torrents.find(infoHash);
+    if (it == torrents.end() || it->second.empty())
+    {
+        return 0;
+    }
+
+    const std::vector<StoredPeer> &peers = it->second;
+    uint32_t current = now();
+    size_t start = random() % peers.size();
+    size_t added = 0;
+
+    for (size_t i = 0; i < peers.size() && added < max; ++i)
+    {
+        const StoredPeer &peer = peers[(start + i) % peers.size()];
+        if (peer.expiresAt > current)
+        {
+            out.emplace_back(peer.endpoint.data(), COMPACT_PEER_SIZE);
+            added++;
+        }
+    }
+    return added;
+}
+
+/*!
+    \brief Drop expired peers and torrents left without peers.
+*/
+void DHTPeerStore::expire()
+{
+    uint32_t current = now();
+    for (auto it = torrents.begin(); it != torrents.end();)
+    {
+        std::vector<StoredPeer> &peers = it->second;
+        size_t before = peers.size();
+        peers.erase(std::remove_if(peers.begin(), peers.end(), [current](const StoredPeer &peer)
+                                   { return peer.expiresAt <= current; }),
+                    peers.end());
+        totalPeers -= before - peers.size();
+
+        if (peers.empty())
+        {
+            it = torrents.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
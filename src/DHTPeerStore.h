@@ -0,0 +1,99 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTPeerStore.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 14:32:10
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef DHT_PEER_STORE_H
+#define DHT_PEER_STORE_H
+
+#include <array>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+#include "RoutingTable.h"
+
+/*!
+    \brief Peers announced to us through announce_peer, keyed by info hash.
+    Memory is bounded: at most MAX_TORRENTS info hashes with MAX_PEERS_PER_TORRENT peers each,
+    stored as 6-byte compact endpoints with a 32-bit expiry. Peers expire after PEER_TTL
+    unless they announce again.
+*/
+class DHTPeerStore
+{
+public:
+    static constexpr size_t MAX_TORRENTS = 4096;             //!> Info hashes tracked at once.
+    static constexpr size_t MAX_PEERS_PER_TORRENT = 128;     //!> Peers kept per info hash.
+    static constexpr std::chrono::seconds PEER_TTL{30 * 60}; //!> How long an announce stays valid.
+    static constexpr size_t COMPACT_PEER_SIZE = 6;           //!> 4-byte IPv4, 2-byte port.
+
+    DHTPeerStore();
+
+    /*!
+        \brief Record an announce, refreshing the peer if it is already stored.
+        A full torrent replaces its stalest peer; a new torrent is refused while the store is
+        full. Torrents whose peers all expired only make room again at the next expire().
+        \param infoHash The torrent.
+        \param compactPeer The peer's 6-byte compact endpoint.
+        \return False if the store had no room.
+    */
+    bool announce(const NodeId &infoHash, const char *compactPeer);
+
+    /*!
+        \brief Get live peers for a torrent, starting at a random offset so repeated queries see different peers.
+        \param infoHash The torrent.
+        \param max Maximum number of peers to return.
+        \param out Receives 6-byte compact endpoints (valid until the next announce or expire).
+        \return Number of peers added to out.
+    */
+    size_t getPeers(const NodeId &infoHash, size_t max, std::vector<std::string_view> &out);
+
+    /*!
+        \brief Drop expired peers and torrents left without peers.
+        Walks the whole store; run it on a timer (DHTServer does on every secret rotation).
+    */
+    void expire();
+
+    /*!
+        \brief Number of info hashes with stored peers.
+        \return The torrent count.
+    */
+    size_t torrentCount() const { return torrents.size(); }
+
+    /*!
+        \brief Number of stored peers across all torrents.
+        \return The peer count.
+    */
+    size_t peerCount() const { return totalPeers; }
+
+private:
+    struct StoredPeer
+    {
+        uint32_t expiresAt;                           //!> Seconds since the store was created.
+        std::array<char, COMPACT_PEER_SIZE> endpoint; //!> Compact IPv4 endpoint.
+    };
+
+    struct InfoHashHasher
+    {
+        size_t operator()(const NodeId &id) const;
+    };
+
+    std::chrono::steady_clock::time_point epoch;                                  //!> Zero point for expiry times.
+    std::unordered_map<NodeId, std::vector<StoredPeer>, InfoHashHasher> torrents; //!> Peers by info hash.
+    size_t totalPeers = 0;                                                        //!> Sum of all peer lists.
+    std::minstd_rand random;                                                      //!> Picks the starting offset for getPeers.
+
+    uint32_t now() const;
+};
+
+#endif
@@ -0,0 +1,323 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTServer.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 14:52:03
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "DHTServer.h"
+#include "BencodeWriter.h"
+#include <openssl/sha.h>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <cstring>
+
+#define KRPC_GENERIC_ERROR 201
+#define KRPC_PROTOCOL_ERROR 203
+#define KRPC_METHOD_UNKNOWN 204
+
+/*!
+    \brief Creates a responder answering on behalf of a routing table's node.
+    \param table Our routing table.
+*/
+DHTServer::DHTServer(RoutingTable &table)
+    : table(table), currentSecret(randomSecret()), previousSecret(randomSecret()), secretRotatedAt(Clock::now()) {}
+
+/*!
+    \brief Generate a fresh token secret.
+    \return 16 random bytes.
+*/
+DHTServer::Secret DHTServer::randomSecret()
+{
+    std::random_device rd;
+    Secret secret;
+    for (uint8_t &byte : secret)
+    {
+        byte = static_cast<uint8_t>(rd());
+    }
+    return secret;
+}
+
+/*!
+    \brief Rotate the token secret (and expire announced peers) once per SECRET_LIFETIME.
+    \param now The current time.
+*/
+void DHTServer::rotateSecrets(Clock::time_point now)
+{
+    if (now - secretRotatedAt < SECRET_LIFETIME)
+    {
+        return;
+    }
+    previousSecret = currentSecret;
+    currentSecret = randomSecret();
+    secretRotatedAt = now;
+    store.expire();
+}
+
+/*!
+    \brief Token bucket check for a source IP.
+    \param ip The IPv4 address (network order).
+    \param now The current time.
+    \return True if the query may be answered.
+*/
+bool DHTServer::allowQuery(uint32_t ip, Clock::time_point now)
+{
+    auto found = rateBuckets.find(ip);
+    if (found == rateBuckets.end() && rateBuckets.size() >= MAX_TRACKED_IPS)
+    {
+        //* Forget the IP seen longest ago if its bucket has refilled; it behaves like a new one anyway
+        auto refillTime = std::chrono::duration<double>(QUERY_BURST / QUERIES_PER_SECOND);
+        auto oldest = rateBuckets.find(rateOrder.back());
+        if (now - oldest->second.refilled < refillTime)
+        {
+            return false; //!> Flooded from many addresses; shed new ones
+        }
+        rateOrder.pop_back();
+        rateBuckets.erase(oldest);
+    }
+
+    if (found == rateBuckets.end())
+    {
+        rateOrder.push_front(ip);
+        found = rateBuckets.emplace(ip, RateBucket{QUERY_BURST, now, rateOrder.begin()}).first;
+    }
+    RateBucket &bucket = found->second;
+    if (bucket.seen != rateOrder.begin())
+    {
+        rateOrder.splice(rateOrder.begin(), rateOrder, bucket.seen); //!> Iterators stay valid
+    }
+    double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+    bucket.tokens = std::min(QUERY_BURST, bucket.tokens + elapsed * QUERIES_PER_SECOND);
+    bucket.refilled = now;
+
+    if (bucket.tokens < 1.0)
+    {
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+/*!
+    \brief Compute the write token for an address under a secret.
+    \param from The querier.
+    \param secret The secret.
+    \return The token.
+*/
+DHTServer::Token DHTServer::makeToken(const sockaddr_in &from, const Secret &secret) const
+{
+    unsigned char input[4 + sizeof(Secret)];
+    std::memcpy(input, &from.sin_addr, 4);
+    std::memcpy(input + 4, secret.data(), secret.size());
+
+    unsigned char hash[SHA_DIGEST_LENGTH];
+    SHA1(input, sizeof(input), hash);
+
+    Token token;
+    std::memcpy(token.data(), hash, token.size());
+    return token;
+}
+
+/*!
+    \brief Check a token presented in announce_peer.
+    \param token The presented token.
+    \param from The announcer.
+    \return True if it was issued to this IP under the current or previous secret.
+*/
+bool DHTServer::checkToken(std::string_view token, const sockaddr_in &from) const
+{
+    if (token.size() != TOKEN_SIZE)
+    {
+        return false;
+    }
+    Token current = makeToken(from, currentSecret);
+    Token previous = makeToken(from, previousSecret);
+    return std::memcmp(token.data(), current.data(), TOKEN_SIZE) == 0 ||
+           std::memcmp(token.data(), previous.data(), TOKEN_SIZE) == 0;
+}
+
+/*!
+    \brief Encode a KRPC error reply.
+    \param out Buffer for the reply.
+    \param capacity Size of the buffer.
+    \param transactionId The query's transaction ID.
+    \param code KRPC error code.
+    \param message Error text.
+    \return Reply size, or 0 if it did not fit.
+*/
+size_t DHTServer::encodeError(char *out, size_t capacity, std::string_view transactionId, int code, std::string_view message)
+{
+    BencodeWriter writer(out, capacity);
+    writer.beginDictionary();
+    writer.key("e");
+    writer.beginList();
+    writer.integer(code);
+    writer.string(message);
+    writer.end();
+    writer.key("t");
+    writer.string(transactionId);
+    writer.key("y");
+    writer.string("e");
+    writer.end();
+
+    counters.answered++;
+    counters.errors++;
+    return writer.ok() ? writer.size() : 0;
+}
+
+/*!
+    \brief Build the reply to an incoming query.
+    \param query The decoded query message.
+    \param from The sender.
+    \param out Buffer for the reply.
+    \param capacity Size of the buffer.
+    \return Reply size, or 0 to send nothing.
+*/
+size_t DHTServer::respond(const BencodeValue &query, const sockaddr_in &from, char *out, size_t capacity)
+{
+    Clock::time_point now = Clock::now();
+    rotateSecrets(now);
+
+    if (!allowQuery(from.sin_addr.s_addr, now))
+    {
+        counters.rateLimited++;
+        return 0;
+    }
+
+    std::string_view transactionId = query.find("t").asString();
+    if (transactionId.empty() || from.sin_port == 0)
+    {
+        return 0; //!> Nothing we could address a reply to
+    }
+
+    std::string_view method = query.find("q").asString();
+    BencodeValue arguments = query.find("a");
+    std::string_view querierId = arguments.find("id").asString();
+    if (querierId.size() != 20)
+    {
+        return encodeError(out, capacity, transactionId, KRPC_PROTOCOL_ERROR, "Missing or invalid id");
+    }
+
+    auto bytes = [](const NodeId &value)
+    { return std::string_view(reinterpret_cast<const char *>(value.data()), value.size()); };
+    auto readId = [](std::string_view value, NodeId &id)
+    {
+        if (value.size() != id.size())
+            return false;
+        std::memcpy(id.data(), value.data(), id.size());
+        return true;
+    };
+
+    char nodes[RoutingTable::K * RoutingTable::COMPACT_NODE_SIZE];
+    auto closestNodes = [this, &nodes](const NodeId &target)
+    {
+        size_t length = 0;
+        for (const RoutingEntry &entry : table.closest(target, RoutingTable::K))
+        {
+            RoutingTable::encodeCompactNode(entry.id, entry.address, nodes + length);
+            length += RoutingTable::COMPACT_NODE_SIZE;
+        }
+        return std::string_view(nodes, length);
+    };
+
+    BencodeWriter writer(out, capacity);
+    writer.beginDictionary();
+    writer.key("r");
+    writer.beginDictionary();
+    writer.key("id");
+    writer.string(bytes(table.self()));
+
+    if (method == "find_node")
+    {
+        NodeId target;
+        if (!readId(arguments.find("target").asString(), target))
+        {
+            return encodeError(out, capacity, transactionId, KRPC_PROTOCOL_ERROR, "Missing or invalid target");
+        }
+        writer.key("nodes");
+        writer.string(closestNodes(target));
+    }
+    else if (method == "get_peers")
+    {
+        NodeId infoHash;
+        if (!readId(arguments.find("info_hash").asString(), infoHash))
+        {
+            return encodeError(out, capacity, transactionId, KRPC_PROTOCOL_ERROR, "Missing or invalid info_hash");
+        }
+        Token token = makeToken(from, currentSecret);
+        std::vector<std::string_view> values;
+        store.getPeers(infoHash, MAX_VALUES, values);
+
+        writer.key("nodes");
+        writer.string(closestNodes(infoHash));
+        writer.key("token");
+        writer.string(std::string_view(token.data(), token.size()));
+        if (!values.empty())
+        {
+            writer.key("values");
+            writer.beginList();
+            for (std::string_view value : values)
+            {
+                writer.string(value);
+            }
+            writer.end();
+        }
+    }
+    else if (method == "announce_peer")
+    {
+        NodeId infoHash;
+        if (!readId(arguments.find("info_hash").asString(), infoHash))
+        {
+            return encodeError(out, capacity, transactionId, KRPC_PROTOCOL_ERROR, "Missing or invalid info_hash");
+        }
+        if (!checkToken(arguments.find("token").asString(), from))
+        {
+            return encodeError(out, capacity, transactionId, KRPC_PROTOCOL_ERROR, "Bad token");
+        }
+
+        int64_t port = arguments.find("implied_port").asInteger(0) != 0 ? ntohs(from.sin_port) : arguments.find("port").asInteger(0);
+        if (port <= 0 || port > 0xFFFF)
+        {
+            return encodeError(out, capacity, transactionId, KRPC_PROTOCOL_ERROR, "Invalid port");
+        }
+
+        char compactPeer[DHTPeerStore::COMPACT_PEER_SIZE];
+        std::memcpy(compactPeer, &from.sin_addr, 4);
+        compactPeer[4] = static_cast<char>(port >> 8);
+        compactPeer[5] = static_cast<char>(port & 0xFF);
+        if (!store.announce(infoHash, compactPeer))
+        {
+            return encodeError(out, capacity, transactionId, KRPC_GENERIC_ERROR, "Peer store full");
+        }
+        counters.announces++;
+    }
+    else if (method != "ping")
+    {
+        return encodeError(out, capacity, transactionId, KRPC_METHOD_UNKNOWN, "Method Unknown");
+    }
+
+    writer.end();
+    writer.key("t");
+    writer.string(transactionId);
+    writer.key("y");
+    writer.string("r");
+    writer.end();
+
+    //* A node that queries us is alive; read-only nodes (BEP 43) ask not to be stored
+    if (query.find("ro").asInteger(0) == 0)
+    {
+        NodeId id;
+        readId(querierId, id);
+        table.insert(id, from);
+    }
+
+    counters.answered++;
+    return writer.ok() ? writer.size() : 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\DHTServer.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 14:51:27
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef DHT_SERVER_H
+#define DHT_SERVER_H
+
+#include <array>
+#include <string_view>
+#include <unordered_map>
+#include <list>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include "BencodeDocument.h"
+#include "RoutingTable.h"
+#include "DHTPeerStore.h"
+
+/*!
+    \brief Counters for the responder side.
+*/
+struct DHTServerStats
+{
+    uint64_t answered = 0;    //!> Queries answered (including errors).
+    uint64_t rateLimited = 0; //!> Queries dropped by the per-IP limiter.
+    uint64_t announces = 0;   //!> announce_peer requests stored.
+    uint64_t errors = 0;      //!> Error replies sent.
+};
+
+/*!
+    \brief Answers incoming KRPC queries: ping, find_node, get_peers and announce_peer.
+    Write tokens are a truncated SHA-1 of the querier's IP and a secret that rotates every
+    SECRET_LIFETIME; the previous secret is still accepted, so a token stays valid for
+    between one and two lifetimes. Each source IP gets a token bucket of QUERY_BURST queries
+    refilled at QUERIES_PER_SECOND; queries over the limit are dropped without a reply.
+*/
+class DHTServer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t TOKEN_SIZE = 8;                   //!> Bytes of SHA-1 handed out as a token.
+    static constexpr size_t MAX_VALUES = 50;                  //!> Peers per get_peers reply (about 700 bytes with the nodes; fits one packet).
+    static constexpr std::chrono::minutes SECRET_LIFETIME{5}; //!> Token secret rotation period.
+    static constexpr double QUERIES_PER_SECOND = 5.0;         //!> Sustained per-IP query rate.
+    static constexpr double QUERY_BURST = 20.0;               //!> Per-IP burst allowance.
+    static constexpr size_t MAX_TRACKED_IPS = 8192;           //!> Rate limiter entries; the least recently seen is reused once refilled.
+
+    /*!
+        \brief Creates a responder answering on behalf of a routing table's node.
+        \param table Our routing table; supplies our ID and find_node results, and learns about queriers.
+    */
+    explicit DHTServer(RoutingTable &table);
+
+    /*!
+        \brief Build the reply to an incoming query.
+        \param query The decoded query message (y = "q").
+        \param from The sender.
+        \param out Buffer for the reply.
+        \param capacity Size of the buffer.
+        \return Reply size, or 0 to send nothing (rate limited or unusable message).
+    */
+    size_t respond(const BencodeValue &query, const sockaddr_in &from, char *out, size_t capacity);
+
+    /*!
+        \brief Get the responder counters.
+        \return The counters.
+    */
+    const DHTServerStats &stats() const { return counters; }
+
+    /*!
+        \brief Get the announced peer store.
+        \return The store.
+    */
+    const DHTPeerStore &peerStore() const { return store; }
+
+private:
+    using Secret = std::array<uint8_t, 16>;
+    using Token = std::array<char, TOKEN_SIZE>;
+
+    struct RateBucket
+    {
+        double tokens;                      //!> Queries left in the burst.
+        Clock::time_point refilled;         //!> Last refill time.
+        std::list<uint32_t>::iterator seen; //!> Position in rateOrder.
+    };
+
+    RoutingTable &table;                                  //!> Our routing table.
+    DHTPeerStore store;                                   //!> Peers announced to us.
+    Secret currentSecret;                                 //!> Secret for new tokens.
+    Secret previousSecret;                                //!> Secret still accepted for old tokens.
+    Clock::time_point secretRotatedAt;                    //!> When currentSecret was made.
+    std::unordered_map<uint32_t, RateBucket> rateBuckets; //!> Limiter state by IPv4 address.
+    std::list<uint32_t> rateOrder;                        //!> Limited IPs, most recently seen first.
+    DHTServerStats counters;                              //!> Responder counters.
+
+    bool allowQuery(uint32_t ip, Clock::time_point now);
+    void rotateSecrets(Clock::time_point now);
+    Token makeToken(const sockaddr_in &from, const Secret &secret) const;
+    bool checkToken(std::string_view token, const sockaddr_in &from) const;
+    size_t encodeError(char *out, size_t capacity, std::string_view transactionId, int code, std::string_view message);
+
+    static Secret randomSecret();
+};
+
+#endif
@@ -12,108 +12,555 @@
 
 #include "DownloadTorrent.h"
 #include <iostream>
-#include <filesystem>
 #include <stdexcept>
-#include <thread>
+#include <algorithm>
 #include <chrono>
 #include <openssl/sha.h>
 #include "PeerDiscovery.h"
+#include "PeerQualityCache.h"
+
+#define DOWNLOAD_DIRECTORY "downloads"                //!> Where the torrent's files are written
+#define STALL_TIMEOUT std::chrono::seconds(30)        //!> Give up once no peer has sent a block for this long
+#define REJECT_BACKOFF std::chrono::seconds(2)        //!> Pause before asking a peer again after it rejects a request
+#define ENDGAME_CHECK std::chrono::milliseconds(1000) //!> Longest wait between endgame cancel sweeps
+
+/*!
+    \brief One borrowed session and what it is receiving.
+    Piece data is read straight into the picker's piece buffers; rejected requests and completed
+    pieces are collected for settle().
+*/
+struct DownloadTorrent::Transfer : PeerWireHandler
+{
+    std::shared_ptr<PeerConnection> session;        //!> The borrowed session.
+    PiecePicker &picker;                            //!> Where blocks are stored.
+    std::vector<BlockRequest> refused;              //!> Requests the peer rejected since the last settle().
+    std::vector<uint32_t> completed;                //!> Pieces completed since the last settle().
+    uint64_t bytes = 0;                             //!> Block bytes received over this session.
+    bool progressed = false;                        //!> A block arrived since the loop last looked.
+    bool healthy = true;                            //!> False once the connection has failed.
+    RequestPipeline::Clock::time_point started;     //!> When the session was borrowed.
+    RequestPipeline::Clock::time_point pausedUntil; //!> No new requests before this (after a reject).
+
+    Transfer(std::shared_ptr<PeerConnection> session, PiecePicker &picker)
+        : session(std::move(session)), picker(picker), started(RequestPipeline::Clock::now()) {}
+
+    char *blockBuffer(uint32_t index, uint32_t begin, uint32_t length) override
+    {
+        return session->requests().isOutstanding({index, begin, length}) ? picker.claim(session->endpoint(), {index, begin, length}) : nullptr;
+    }
+    void onPiece(uint32_t index, uint32_t begin, uint32_t length, bool stored) override
+    {
+        BlockRequest block{index, begin, length};
+        if (!session->requests().onReceived(block, RequestPipeline::Clock::now()))
+        {
+            return;
+        }
+        if (!stored)
+        {
+            picker.release(session->endpoint(), block); //!> Endgame: another peer's copy won
+            return;
+        }
+        bytes += length;
+        progressed = true;
+        if (picker.onReceived(session->endpoint(), block))
+        {
+            completed.push_back(index);
+        }
+    }
+    void onReject(uint32_t index, uint32_t begin, uint32_t length) override
+    {
+        if (session->requests().onRejected({index, begin, length}))
+        {
+            refused.push_back({index, begin, length});
+        }
+    }
+};
+
+/*!
+    \brief Piece size from the metadata.
+    \param metadata The metadata of the torrent.
+    \return The piece size (one block if the metadata does not say).
+*/
+static uint32_t pieceSizeOf(const MagnetMetadata &metadata)
+{
+    return metadata.getPieceSize() != 0 ? metadata.getPieceSize() : RequestPipeline::BLOCK_SIZE;
+}
+
+/*!
+    \brief File layout from the metadata.
+    The files must end inside the last piece: a length from the magnet link (xl) is only the
+    sender's word, and one that is too short would leave trailing pieces with no blocks.
+    \param metadata The metadata of the torrent.
+    \return Its files, or one file named after the torrent covering every piece if they are not
+    known or do not fit the piece count.
+*/
+static std::vector<TorrentFile> filesOf(const MagnetMetadata &metadata)
+{
+    uint64_t pieces = metadata.getPieceHashes().size();
+    uint64_t pieceSize = pieceSizeOf(metadata);
+    uint64_t span = pieces * pieceSize;
+    if (!metadata.getFiles().empty())
+    {
+        uint64_t total = metadata.getTotalSize();
+        if (total <= span && total + pieceSize > span)
+        {
+            return metadata.getFiles();
+        }
+        std::cerr << "Ignoring the file layout: " << total << " bytes do not fit " << pieces << " pieces of " << pieceSize << " bytes." << std::endl;
+    }
+    std::string name = metadata.getName().empty() ? metadata.getInfoHash() : metadata.getName();
+    return {{name, span}};
+}
 
 /*!
     \brief Creates a DownloadTorrent object with the given metadata.
     \param metadata The metadata of the torrent.
 */
 DownloadTorrent::DownloadTorrent(const MagnetMetadata &metadata)
-    : metadata(metadata), downloadDirectory("downloads") {}
+    : DownloadTorrent(metadata, std::make_shared<PeerConnectionManager>(metadata)) {}
+
+/*!
+    \brief Creates a DownloadTorrent object that downloads over sessions that are already open.
+    \param metadata The metadata of the torrent.
+    \param connections Established peer sessions to reuse (more are opened if it has none).
+*/
+DownloadTorrent::DownloadTorrent(const MagnetMetadata &metadata, std::shared_ptr<PeerConnectionManager> connections)
+    : metadata(metadata), connections(std::move(connections)),
+      storage(DOWNLOAD_DIRECTORY, filesOf(metadata), pieceSizeOf(metadata)),
+      picker(metadata.getPieceHashes().size(), pieceSizeOf(metadata), storage.totalSize()) {}
 
 /*!
     \brief Starts the download process.
 */
 void DownloadTorrent::startDownload()
 {
-    createDownloadDirectory();
+    allocateFiles();
 
-    PeerDiscovery peerDiscovery(metadata.getInfoHash());
-    peers = peerDiscovery.discoverPeers();
-    if (peers.empty())
+    std::unique_ptr<PeerDiscovery> peerDiscovery; //* Only when we find peers ourselves; the sessions share peers through its pool
+    if (connections->sessionCount() == 0)
+    {
+        peerDiscovery = std::make_unique<PeerDiscovery>(metadata.getInfoHash(), metadata.getTrackers());
+        peerDiscovery->discoverPeers();
+        size_t pruned = peerDiscovery->candidates().rank(PeerQualityCache::shared()); //* Best peers first; ones that keep failing are skipped
+        if (pruned > 0)
+        {
+            std::cout << "Skipping " << pruned << " peers that failed on earlier attempts." << std::endl;
+        }
+        connections->connect(peerDiscovery->candidates());
+    }
+    if (connections->sessionCount() == 0)
     {
         std::cerr << "No peers found!" << std::endl;
         return;
     }
 
     requestPieces();
+    storage.closeAll();
+    if (peerDiscovery)
+    {
+        connections->closeIdle(); //!> The sessions must not outlive the pool they trade peers with
+    }
+}
+
+/*!
+    \brief Create the torrent's files at full size, so every piece can be written in place.
+*/
+void DownloadTorrent::allocateFiles()
+{
+    storage.allocate(sparseFiles);
+    std::cout << (sparseFiles ? "Created " : "Allocated ") << storage.files().size() << " files, "
+              << storage.totalSize() << " bytes." << std::endl;
+}
+
+/*!
+    \brief Download every piece over the pooled sessions.
+    One thread serves every session: it keeps each unchoked peer's pipeline full with blocks
+    from the picker, waits on all the sockets at once, and reads whatever arrives straight into
+    the picker's piece buffers. Completed pieces go to the worker pool to be hashed and saved,
+    so the thread count follows the cores rather than the torrent. Gives up once no peer has
+    sent anything for STALL_TIMEOUT. The peer quality cache is saved at the end.
+*/
+void DownloadTorrent::requestPieces()
+{
+    SocketPoller poller;
+    std::vector<std::unique_ptr<Transfer>> transfers;
+    std::vector<PeerConnection::SocketHandle> ready;
+    std::vector<PeerConnection::SocketHandle> writable;
+    auto lastProgress = RequestPipeline::Clock::now();
+
+    adoptSessions(transfers, poller);
+    while (!picker.isComplete() && !transfers.empty())
+    {
+        auto now = RequestPipeline::Clock::now();
+        auto wake = now + ENDGAME_CHECK;
+        for (auto &transfer : transfers)
+        {
+            sharePeers(*transfer);
+            requestBlocks(*transfer, now);
+            const RequestPipeline &pipeline = transfer->session->requests();
+            if (pipeline.outstanding() > 0)
+            {
+                wake = std::min(wake, pipeline.nextDeadline());
+            }
+            if (transfer->pausedUntil > now)
+            {
+                wake = std::min(wake, transfer->pausedUntil);
+            }
+            poller.watchWrites(transfer->session->socketHandle(), transfer->session->queuedSendBytes() > 0);
+        }
+
+        poller.wait(std::chrono::ceil<std::chrono::milliseconds>(wake - now), ready, writable);
+        for (PeerConnection::SocketHandle socket : writable)
+        {
+            auto it = std::find_if(transfers.begin(), transfers.end(), [socket](const std::unique_ptr<Transfer> &transfer)
+                                   { return transfer->session->socketHandle() == socket; });
+            if (it == transfers.end() || !(*it)->healthy)
+            {
+                continue;
+            }
+            try
+            {
+                (*it)->session->flushSends();
+            }
+            catch (const std::exception &ex)
+            {
+                std::cerr << "Transfer from " << (*it)->session->endpoint().toString() << " failed: " << ex.what() << std::endl;
+                (*it)->healthy = false;
+            }
+        }
+        for (PeerConnection::SocketHandle socket : ready)
+        {
+            auto it = std::find_if(transfers.begin(), transfers.end(), [socket](const std::unique_ptr<Transfer> &transfer)
+                                   { return transfer->session->socketHandle() == socket; });
+            if (it == transfers.end() || !(*it)->healthy)
+            {
+                continue;
+            }
+            try
+            {
+                (*it)->session->drain(**it);
+            }
+            catch (const std::exception &ex)
+            {
+                std::cerr << "Transfer from " << (*it)->session->endpoint().toString() << " failed: " << ex.what() << std::endl;
+                (*it)->healthy = false;
+            }
+        }
+
+        now = RequestPipeline::Clock::now();
+        for (size_t i = 0; i < transfers.size();)
+        {
+            Transfer &transfer = *transfers[i];
+            settle(transfer, now);
+            if (transfer.progressed)
+            {
+                transfer.progressed = false;
+                lastProgress = now;
+            }
+            if (transfer.healthy)
+            {
+                ++i;
+                continue;
+            }
+            retire(transfer, poller);
+            transfers.erase(transfers.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+
+        adoptSessions(transfers, poller); //* Sessions other users of the pool have handed back
+        if (now - lastProgress > STALL_TIMEOUT)
+        {
+            std::cerr << "No peer has sent anything for " << std::chrono::duration_cast<std::chrono::seconds>(STALL_TIMEOUT).count() << " seconds; giving up." << std::endl;
+            break;
+        }
+    }
+
+    for (auto &transfer : transfers)
+    {
+        retire(*transfer, poller);
+    }
+    workers.wait();
+    PeerQualityCache::shared().save(); //* Keep what this download taught us even if the process dies later
+
+    WorkerPoolStats stats = workers.stats();
+    std::cout << "Worker pool: " << stats.threads << " threads, " << stats.executed << " pieces checked, peak queue "
+              << stats.peakQueued << ", " << stats.stolen << " stolen, " << stats.blockedSubmits << " waits for room." << std::endl;
+
+    if (!picker.isComplete())
+    {
+        std::cerr << "Failed to download " << picker.piecesLeft() << " pieces!" << std::endl;
+    }
 }
 
 /*!
-    \brief Ensure the download directory exists.
+    \brief Borrow every idle session and start watching it.
+    Anything the session already buffered is processed straight away, since the poller only
+    reports data that is still on the socket. Its sends are queued from here on, so a peer that
+    stops reading cannot stall the loop; the queue is flushed when the poller reports room.
+    \param transfers The sessions being served.
+    \param poller The network loop's poller.
 */
-void DownloadTorrent::createDownloadDirectory()
+void DownloadTorrent::adoptSessions(std::vector<std::unique_ptr<Transfer>> &transfers, SocketPoller &poller)
 {
-    if (!std::filesystem::exists(downloadDirectory))
+    while (std::shared_ptr<PeerConnection> session = connections->acquire(std::chrono::milliseconds(0)))
     {
-        std::filesystem::create_directory(downloadDirectory);
+        transfers.push_back(std::make_unique<Transfer>(session, picker));
+        poller.add(session->socketHandle());
+        try
+        {
+            session->setDeferredSends(true);
+            session->setInterested(true);
+            session->drain(*transfers.back());
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "Transfer from " << session->endpoint().toString() << " failed: " << ex.what() << std::endl;
+            transfers.back()->healthy = false;
+        }
     }
 }
 
 /*!
-    \brief Request pieces from peers.
+    \brief Keep trading peer lists with a session's peer (ut_pex) while it serves blocks.
+    \param transfer The session.
 */
-void DownloadTorrent::requestPieces()
+void DownloadTorrent::sharePeers(Transfer &transfer)
+{
+    if (!transfer.healthy)
+    {
+        return;
+    }
+    try
+    {
+        transfer.session->sharePeers();
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Transfer from " << transfer.session->endpoint().toString() << " failed: " << ex.what() << std::endl;
+        transfer.healthy = false;
+    }
+}
+
+/*!
+    \brief Fill a session's pipeline with blocks from the picker.
+    Nothing is requested while the peer chokes us or for REJECT_BACKOFF after it rejects a request.
+    \param transfer The session.
+    \param now Current time.
+*/
+void DownloadTorrent::requestBlocks(Transfer &transfer, RequestPipeline::Clock::time_point now)
+{
+    PeerConnection &session = *transfer.session;
+    if (!transfer.healthy || session.state().peerChoking || transfer.pausedUntil > now)
+    {
+        return;
+    }
+
+    RequestPipeline &pipeline = session.requests();
+    std::vector<BlockRequest> requests;
+    picker.pick(session.endpoint(), session.peerPieces(), connections->pieceAvailability(), pipeline.room(), requests);
+    try
+    {
+        for (const BlockRequest &block : requests)
+        {
+            session.sendRequest(block.piece, block.begin, block.length);
+            pipeline.onSent(block, now);
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Transfer from " << session.endpoint().toString() << " failed: " << ex.what() << std::endl;
+        transfer.healthy = false;
+        for (const BlockRequest &block : requests)
+        {
+            if (!pipeline.isOutstanding(block))
+            {
+                picker.release(session.endpoint(), block); //!> Never sent; retire() releases the rest
+            }
+        }
+    }
+}
+
+/*!
+    \brief Act on what a session received.
+    Requests that timed out are cancelled and go back to the picker for another peer; a choke
+    drops every outstanding request (the peer discards them); a reject pauses the session. In
+    endgame, requests for blocks another peer delivered first are cancelled. Completed pieces
+    go to the workers.
+    \param transfer The session.
+    \param now Current time.
+*/
+void DownloadTorrent::settle(Transfer &transfer, RequestPipeline::Clock::time_point now)
 {
-    std::vector<std::thread> downloadThreads;
+    PeerConnection &session = *transfer.session;
+    RequestPipeline &pipeline = session.requests();
+    std::vector<BlockRequest> abandoned;
 
-    for (uint32_t pieceIndex = 0; pieceIndex < metadata.getPieceHashes().size(); ++pieceIndex)
+    if (transfer.healthy)
     {
-        downloadThreads.push_back(std::thread([this, pieceIndex]()
-                                              {
-            for (const auto &peer : peers)
+        try
+        {
+            if (pipeline.expire(now, abandoned) > 0)
+            {
+                for (const BlockRequest &block : abandoned)
+                {
+                    session.sendCancel(block.piece, block.begin, block.length);
+                }
+            }
+            if (session.state().peerChoking && pipeline.outstanding() > 0)
+            {
+                pipeline.clear(abandoned);
+            }
+            if (picker.inEndgame())
             {
-                PeerConnection peerConnection(peer, metadata);
-                if (peerConnection.connectToPeer())
+                size_t first = abandoned.size();
+                pipeline.withdrawIf([this](const BlockRequest &block)
+                                    { return !picker.isWanted(block); },
+                                    abandoned);
+                for (size_t i = first; i < abandoned.size(); ++i)
                 {
-                    peerConnection.performHandshake();
-                    peerConnection.sendRequest(pieceIndex, 0, 16384);
-                    std::vector<char> pieceData = peerConnection.receiveData();
-
-                    if (verifyPiece(pieceIndex, pieceData))
-                    {
-                        savePiece(pieceIndex, pieceData);
-                        updatePieceStatus(pieceIndex, true);
-                        return;
-                    }
-                    else
-                    {
-                        retryPieceDownload(pieceIndex);
-                    }
+                    session.sendCancel(abandoned[i].piece, abandoned[i].begin, abandoned[i].length);
                 }
-            } }));
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "Transfer from " << session.endpoint().toString() << " failed: " << ex.what() << std::endl;
+            transfer.healthy = false;
+        }
     }
 
-    for (auto &t : downloadThreads)
+    for (const BlockRequest &block : abandoned)
+    {
+        session.abandonBlock(block); //!> Once released, another peer may complete the piece and free its buffer
+        picker.release(session.endpoint(), block);
+    }
+    if (!transfer.refused.empty())
+    {
+        for (const BlockRequest &block : transfer.refused)
+        {
+            session.abandonBlock(block);
+            picker.release(session.endpoint(), block);
+        }
+        transfer.refused.clear();
+        transfer.pausedUntil = now + REJECT_BACKOFF;
+    }
+    for (uint32_t piece : transfer.completed)
     {
-        t.join();
+        completePiece(piece);
     }
+    transfer.completed.clear();
 }
 
 /*!
-    \brief Save the downloaded piece.
+    \brief Cancel a session's requests and return it to the connection manager.
+    \param transfer The session.
+    \param poller The network loop's poller.
+*/
+void DownloadTorrent::retire(Transfer &transfer, SocketPoller &poller)
+{
+    PeerConnection &session = *transfer.session;
+    std::vector<BlockRequest> abandoned;
+    poller.remove(session.socketHandle());
+    session.requests().clear(abandoned);
+    if (session.abandonBlock())
+    {
+        transfer.healthy = false; //!> Its stream is mid-message; close it rather than pool it
+    }
+
+    if (transfer.healthy)
+    {
+        try
+        {
+            for (const BlockRequest &block : abandoned)
+            {
+                session.sendCancel(block.piece, block.begin, block.length);
+            }
+            transfer.healthy = session.flushSends(); //!> A peer still not reading is closed, not pooled
+            if (transfer.healthy)
+            {
+                session.setDeferredSends(false);
+            }
+        }
+        catch (const std::exception &)
+        {
+            transfer.healthy = false;
+        }
+    }
+    transfer.refused.insert(transfer.refused.end(), abandoned.begin(), abandoned.end());
+    for (const BlockRequest &block : transfer.refused)
+    {
+        picker.release(session.endpoint(), block);
+    }
+    for (uint32_t piece : transfer.completed)
+    {
+        completePiece(piece);
+    }
+
+    PeerQualityCache::shared().recordTransfer(session.endpoint(), transfer.bytes,
+                                              std::chrono::duration_cast<std::chrono::milliseconds>(RequestPipeline::Clock::now() - transfer.started));
+    connections->release(transfer.session, transfer.healthy);
+}
+
+/*!
+    \brief Hand a piece the picker has assembled to the workers to verify and save.
+    Blocks while the workers' queue is full, which holds the network loop back to the disk's pace.
+    \param pieceIndex The index of the piece.
+*/
+void DownloadTorrent::completePiece(uint32_t pieceIndex)
+{
+    std::vector<char> pieceData;
+    std::vector<PeerEndpoint> contributors;
+    if (!picker.takePiece(pieceIndex, pieceData, contributors))
+    {
+        return;
+    }
+    workers.submit([this, pieceIndex, pieceData = std::move(pieceData), contributors = std::move(contributors)]()
+                   { verifyAndSave(pieceIndex, pieceData, contributors); });
+}
+
+/*!
+    \brief Verify and save a piece taken from the picker (runs on a worker).
+    A piece that fails its hash check goes back to the picker, and every peer that sent part of
+    it is marked in the peer quality cache.
     \param pieceIndex The index of the piece.
     \param pieceData The data of the piece.
+    \param contributors Every peer that sent part of it.
 */
-void DownloadTorrent::savePiece(uint32_t pieceIndex, const std::vector<char> &pieceData)
+void DownloadTorrent::verifyAndSave(uint32_t pieceIndex, const std::vector<char> &pieceData, const std::vector<PeerEndpoint> &contributors)
 {
-    std::string filename = downloadDirectory + "/piece" + std::to_string(pieceIndex) + ".dat";
-    std::ofstream
-        file(filename, std::ios::out | std::ios::binary);
-    if (!file)
+    if (!verifyPiece(pieceIndex, pieceData))
+    {
+        for (const PeerEndpoint &peer : contributors)
+        {
+            PeerQualityCache::shared().recordHashFailure(peer);
+        }
+        picker.onVerified(pieceIndex, false);
+        updatePieceStatus(pieceIndex, false);
+        return;
+    }
+    try
     {
-        throw std::runtime_error("Failed to open file for writing: " + filename);
+        savePiece(pieceIndex, pieceData);
     }
-    file.write(pieceData.data(), pieceData.size());
+    catch (const std::exception &)
+    {
+        picker.onVerified(pieceIndex, false); //!> Download it again rather than lose it
+        throw;
+    }
+    picker.onVerified(pieceIndex, true);
+    updatePieceStatus(pieceIndex, true);
+}
 
-    std::cout << "Piece " << pieceIndex << " downloaded and saved." << std::endl;
+/*!
+    \brief Save the downloaded piece.
+    Written straight to its place in the torrent's files.
+    \param pieceIndex The index of the piece.
+    \param pieceData The data of the piece.
+*/
+void DownloadTorrent::savePiece(uint32_t pieceIndex, const std::vector<char> &pieceData)
+{
+    storage.write(pieceIndex, 0, std::string_view(pieceData.data(), pieceData.size()));
 
-    file.close();
+    std::cout << "Piece " << pieceIndex << " downloaded and saved." << std::endl;
 }
 
 /*!
@@ -143,41 +590,6 @@ bool DownloadTorrent::verifyPiece(uint32_t pieceIndex, const std::vector<char> &
     return true;
 }
 
-/*!
-    \brief Retry downloading a piece if it fails.
-    \param pieceIndex The index of the piece.
-*/
-void DownloadTorrent::retryPieceDownload(uint32_t pieceIndex)
-{
-    std::cout << "Retrying download of piece " << pieceIndex << "..." << std::endl;
-
-    for (int retries = 0; retries < 3; ++retries)
-    {
-        std::this_thread::sleep_for(std::chrono::seconds(2));
-
-        for (const auto &peer : peers)
-        {
-            PeerConnection peerConnection(peer, metadata);
-            if (peerConnection.connectToPeer())
-            {
-                peerConnection.performHandshake();
-
-                peerConnection.sendRequest(pieceIndex, 0, 16384);
-                std::vector<char> pieceData = peerConnection.receiveData();
-
-                if (verifyPiece(pieceIndex, pieceData))
-                {
-                    savePiece(pieceIndex, pieceData);
-                    updatePieceStatus(pieceIndex, true);
-                    return;
-                }
-            }
-        }
-    }
-
-    std::cerr << "Failed to download piece " << pieceIndex << " after 3 retries!" << std::endl;
-}
-
 /*!
     \brief Calculate the SHA-1 hash of the piece data.
     \param data The data of the piece.
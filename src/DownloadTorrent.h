@@ -15,9 +15,16 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <memory>
 #include "PeerConnection.h"
+#include "PeerConnectionManager.h"
+#include "RequestPipeline.h"
+#include "PiecePicker.h"
+#include "WorkerPool.h"
+#include "SocketPoller.h"
+#include "TorrentStorage.h"
 #include "MagnetMetadata.h"
+#include "PeerEndpoint.h"
 
 class DownloadTorrent
 {
@@ -28,23 +35,85 @@ public:
     */
     explicit DownloadTorrent(const MagnetMetadata &metadata);
 
+    /*!
+        \brief Creates a DownloadTorrent object that downloads over sessions that are already open.
+        \param metadata The metadata of the torrent.
+        \param connections Established peer sessions to reuse (more are opened if it has none).
+    */
+    DownloadTorrent(const MagnetMetadata &metadata, std::shared_ptr<PeerConnectionManager> connections);
+
     /*!
         \brief Starts the download process.
     */
     void startDownload();
 
+    /*!
+        \brief Choose how the files are created before the download starts.
+        \param sparse True to only size them (unwritten ranges stay holes); false (the default)
+        to reserve all their space up front.
+    */
+    void setSparseFiles(bool sparse) { sparseFiles = sparse; }
+
 private:
-    MagnetMetadata metadata;        //!> The metadata of the torrent.
-    std::vector<std::string> peers; //!> The list of peers to connect to.
-    std::string downloadDirectory;  //!> The directory to save the downloaded files.
+    struct Transfer; //!> One borrowed session and what it is receiving (defined in DownloadTorrent.cpp).
+
+    MagnetMetadata metadata;                            //!> The metadata of the torrent.
+    std::shared_ptr<PeerConnectionManager> connections; //!> Peer sessions the network loop serves.
+    TorrentStorage storage;                             //!> The torrent's files on disk.
+    PiecePicker picker;                                 //!> What to request next, and the pieces in progress.
+    WorkerPool workers;                                 //!> Hashes and saves completed pieces off the network loop.
+    bool sparseFiles = false;                           //!> Leave unwritten ranges as holes instead of reserving space.
 
     void requestPieces();                                                      //!> Request pieces from peers.
+    void completePiece(uint32_t pieceIndex);                                   //!> Hand an assembled piece to the workers.
     void savePiece(uint32_t pieceIndex, const std::vector<char> &pieceData);   //!> Save the downloaded piece.
-    void createDownloadDirectory();                                            //!> Ensure the download directory exists.
+    void allocateFiles();                                                      //!> Create the torrent's files at full size.
     void updatePieceStatus(uint32_t pieceIndex, bool isDownloaded);            //!> Track the status of pieces.
     bool verifyPiece(uint32_t pieceIndex, const std::vector<char> &pieceData); //!> Verify piece integrity.
-    void retryPieceDownload(uint32_t pieceIndex);                              //!> Retry downloading a piece if it fails.
     std::string calculateSHA1(const std::vector<char> &data);                  //!> Calculate the SHA-1 hash of the piece data.
+
+    /*!
+        \brief Borrow every idle session and start watching it.
+        \param transfers The sessions being served.
+        \param poller The network loop's poller.
+    */
+    void adoptSessions(std::vector<std::unique_ptr<Transfer>> &transfers, SocketPoller &poller);
+
+    /*!
+        \brief Send a session's peer its PEX message when due (what it sends us is taken in as it arrives).
+        \param transfer The session.
+    */
+    void sharePeers(Transfer &transfer);
+
+    /*!
+        \brief Fill a session's pipeline with blocks from the picker.
+        \param transfer The session.
+        \param now Current time.
+    */
+    void requestBlocks(Transfer &transfer, RequestPipeline::Clock::time_point now);
+
+    /*!
+        \brief Act on what a session received: give up expired, rejected and choked requests,
+        cancel endgame duplicates and hand completed pieces to the workers.
+        \param transfer The session.
+        \param now Current time.
+    */
+    void settle(Transfer &transfer, RequestPipeline::Clock::time_point now);
+
+    /*!
+        \brief Cancel a session's requests and return it to the connection manager.
+        \param transfer The session.
+        \param poller The network loop's poller.
+    */
+    void retire(Transfer &transfer, SocketPoller &poller);
+
+    /*!
+        \brief Verify and save a piece taken from the picker (runs on a worker).
+        \param pieceIndex The index of the piece.
+        \param pieceData The data of the piece.
+        \param contributors Every peer that sent part of it.
+    */
+    void verifyAndSave(uint32_t pieceIndex, const std::vector<char> &pieceData, const std::vector<PeerEndpoint> &contributors);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,303 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\HostResolver.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 16:03:19
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "HostResolver.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+#ifndef _WIN32
+#include <netdb.h>
+#endif
+
+/*!
+    \brief Lower-case a hostname for use as a cache key.
+    \param host The hostname.
+    \return The lower-case name.
+*/
+static std::string normalizeHost(const std::string &host)
+{
+    std::string name = host;
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    return name;
+}
+
+/*!
+    \brief Initializes Winsock on Windows (getaddrinfo needs it).
+*/
+SystemResolverBackend::SystemResolverBackend()
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        throw std::runtime_error("WSAStartup failed");
+    }
+#endif
+}
+
+/*!
+    \brief Releases Winsock on Windows.
+*/
+SystemResolverBackend::~SystemResolverBackend()
+{
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+/*!
+    \brief Resolve a hostname with getaddrinfo.
+    \param host The hostname.
+    \return The IPv4 addresses, deduplicated.
+*/
+std::vector<sockaddr_in> SystemResolverBackend::resolve(const std::string &host)
+{
+    std::vector<sockaddr_in> addresses;
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo *results = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &results) != 0)
+    {
+        return addresses;
+    }
+
+    for (addrinfo *entry = results; entry != nullptr; entry = entry->ai_next)
+    {
+        if (entry->ai_family != AF_INET)
+        {
+            continue;
+        }
+        sockaddr_in address = *reinterpret_cast<sockaddr_in *>(entry->ai_addr);
+        address.sin_port = 0;
+        bool seen = std::any_of(addresses.begin(), addresses.end(), [&address](const sockaddr_in &other)
+                                { return other.sin_addr.s_addr == address.sin_addr.s_addr; });
+        if (!seen)
+        {
+            addresses.push_back(address);
+        }
+    }
+
+    freeaddrinfo(results);
+    return addresses;
+}
+
+/*!
+    \brief Loads a hosts-format file.
+    \param path Path to the hosts file.
+    \throws std::runtime_error if the file cannot be opened.
+*/
+HostsFileResolverBackend::HostsFileResolverBackend(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open hosts file: " + path);
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+
+        std::string addressText;
+        if (!(fields >> addressText))
+        {
+            continue;
+        }
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        if (inet_pton(AF_INET, addressText.c_str(), &address.sin_addr) <= 0)
+        {
+            continue; //!> IPv6 or malformed
+        }
+
+        std::string name;
+        while (fields >> name)
+        {
+            entries[normalizeHost(name)].push_back(address);
+        }
+    }
+}
+
+/*!
+    \brief Look a name up in the loaded file.
+    \param host The hostname.
+    \return The addresses listed for it.
+*/
+std::vector<sockaddr_in> HostsFileResolverBackend::resolve(const std::string &host)
+{
+    auto it = entries.find(normalizeHost(host));
+    return it == entries.end() ? std::vector<sockaddr_in>() : it->second;
+}
+
+/*!
+    \brief Creates a resolver.
+    \param backend The name lookup to use.
+*/
+HostResolver::HostResolver(std::shared_ptr<ResolverBackend> backend) : backend(std::move(backend)) {}
+
+/*!
+    \brief The process-wide resolver, created on first use.
+    \return The shared resolver.
+*/
+HostResolver &HostResolver::shared()
+{
+    static HostResolver resolver;
+    return resolver;
+}
+
+/*!
+    \brief Replace the backend; cached results are dropped.
+    \param newBackend The new name lookup.
+*/
+void HostResolver::setBackend(std::shared_ptr<ResolverBackend> newBackend)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    backend = std::move(newBackend);
+    cache.clear();
+}
+
+/*!
+    \brief Start resolving a hostname (or return the cached or in-flight result).
+    \param host Hostname or numeric IPv4 address.
+    \return Becomes ready when the name is resolved.
+*/
+std::shared_future<ResolvedHost> HostResolver::resolve(const std::string &host)
+{
+    sockaddr_in numeric{};
+    numeric.sin_family = AF_INET;
+    if (inet_pton(AF_INET, host.c_str(), &numeric.sin_addr) > 0)
+    {
+        std::promise<ResolvedHost> ready;
+        ready.set_value(ResolvedHost{{numeric}, std::chrono::steady_clock::time_point::max()});
+        return ready.get_future().share();
+    }
+
+    std::string name = normalizeHost(host);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = cache.find(name);
+    if (it != cache.end())
+    {
+        const std::shared_future<ResolvedHost> &cached = it->second;
+        if (cached.wait_for(std::chrono::seconds(0)) != std::future_status::ready ||
+            cached.get().expires > std::chrono::steady_clock::now())
+        {
+            return cached; //!> Still resolving, or fresh
+        }
+    }
+
+    std::shared_ptr<ResolverBackend> lookup = backend;
+    auto job = [lookup, name]()
+    {
+        ResolvedHost resolved;
+        resolved.addresses = lookup->resolve(name);
+        resolved.expires = std::chrono::steady_clock::now() + (resolved.addresses.empty() ? NEGATIVE_TTL : POSITIVE_TTL);
+        return resolved;
+    };
+
+    std::shared_future<ResolvedHost> result = std::async(std::launch::async, job).share();
+    cache[name] = result;
+    return result;
+}
+
+/*!
+    \brief Start resolving the hosts of a list of URLs so they are cached before use.
+    \param urls The URLs.
+*/
+void HostResolver::prefetch(const std::vector<std::string> &urls)
+{
+    for (const std::string &url : urls)
+    {
+        std::string host;
+        uint16_t port;
+        if (splitUrl(url, host, port))
+        {
+            resolve(host);
+        }
+    }
+}
+
+/*!
+    \brief Split "host" or "host:port".
+    \param text The address.
+    \param host Receives the host.
+    \param port Receives the port (unchanged if none is given).
+    \return False if the port is not a number in range.
+*/
+bool HostResolver::splitHostPort(const std::string &text, std::string &host, uint16_t &port)
+{
+    size_t colonPos = text.rfind(':');
+    if (colonPos == std::string::npos)
+    {
+        host = text;
+        return !host.empty();
+    }
+
+    host = text.substr(0, colonPos);
+    std::string portText = text.substr(colonPos + 1);
+    if (host.empty() || portText.empty() || portText.size() > 5 ||
+        !std::all_of(portText.begin(), portText.end(), [](unsigned char c)
+                     { return std::isdigit(c) != 0; }))
+    {
+        return false;
+    }
+
+    unsigned long value = std::stoul(portText);
+    if (value == 0 || value > 0xFFFF)
+    {
+        return false;
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+/*!
+    \brief Extract the host and port from a URL.
+    \param url The URL.
+    \param host Receives the host.
+    \param port Receives the port.
+    \return False if the URL has no host or no usable port.
+*/
+bool HostResolver::splitUrl(const std::string &url, std::string &host, uint16_t &port)
+{
+    size_t schemeEnd = url.find("://");
+    if (schemeEnd == std::string::npos)
+    {
+        return false;
+    }
+
+    std::string scheme = normalizeHost(url.substr(0, schemeEnd));
+    size_t authorityStart = schemeEnd + 3;
+    size_t authorityEnd = url.find_first_of("/?#", authorityStart);
+    std::string authority = url.substr(authorityStart, authorityEnd == std::string::npos ? std::string::npos : authorityEnd - authorityStart);
+
+    port = 0;
+    if (scheme == "http")
+    {
+        port = 80;
+    }
+    else if (scheme == "https")
+    {
+        port = 443;
+    }
+    return splitHostPort(authority, host, port) && port != 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\HostResolver.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 16:02:45
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef HOST_RESOLVER_H
+#define HOST_RESOLVER_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
+#include <cstdint>
+
+/*!
+    \brief Result of resolving one hostname.
+*/
+struct ResolvedHost
+{
+    std::vector<sockaddr_in> addresses;            //!> IPv4 addresses (port left 0); empty if resolution failed.
+    std::chrono::steady_clock::time_point expires; //!> When the cached result goes stale.
+};
+
+/*!
+    \brief Blocking name lookup used by HostResolver's worker threads.
+*/
+class ResolverBackend
+{
+public:
+    virtual ~ResolverBackend() = default;
+
+    /*!
+        \brief Resolve a hostname to IPv4 addresses.
+        \param host The hostname.
+        \return The addresses (port 0); empty if the name does not resolve.
+    */
+    virtual std::vector<sockaddr_in> resolve(const std::string &host) = 0;
+};
+
+/*!
+    \brief Resolves names with the operating system's resolver (getaddrinfo).
+*/
+class SystemResolverBackend : public ResolverBackend
+{
+public:
+    SystemResolverBackend();
+    ~SystemResolverBackend() override;
+    std::vector<sockaddr_in> resolve(const std::string &host) override;
+};
+
+/*!
+    \brief Resolves names from a hosts-format file ("address name [aliases...]", '#' comments).
+    Used in place of DNS for tests and offline setups.
+*/
+class HostsFileResolverBackend : public ResolverBackend
+{
+public:
+    /*!
+        \brief Loads the file.
+        \param path Path to the hosts file.
+        \throws std::runtime_error if the file cannot be opened.
+    */
+    explicit HostsFileResolverBackend(const std::string &path);
+    std::vector<sockaddr_in> resolve(const std::string &host) override;
+
+private:
+    std::unordered_map<std::string, std::vector<sockaddr_in>> entries; //!> Addresses by lower-case name.
+};
+
+/*!
+    \brief Asynchronous, caching hostname resolver.
+    Every hostname is resolved on its own thread, so a batch of names resolves in parallel
+    and callers never block unless they wait on the result. Results are cached for
+    POSITIVE_TTL (or NEGATIVE_TTL for failures); a name already being resolved shares the
+    in-flight result. Numeric addresses resolve immediately without touching the backend.
+*/
+class HostResolver
+{
+public:
+    static constexpr std::chrono::seconds POSITIVE_TTL{300}; //!> Cache lifetime of a successful lookup.
+    static constexpr std::chrono::seconds NEGATIVE_TTL{30};  //!> Cache lifetime of a failed lookup.
+
+    /*!
+        \brief Creates a resolver.
+        \param backend The name lookup to use; defaults to the system resolver.
+    */
+    explicit HostResolver(std::shared_ptr<ResolverBackend> backend = std::make_shared<SystemResolverBackend>());
+
+    /*!
+        \brief The process-wide resolver, created on first use.
+        \return The shared resolver.
+    */
+    static HostResolver &shared();
+
+    /*!
+        \brief Replace the backend; cached results are dropped.
+        \param backend The new name lookup.
+    */
+    void setBackend(std::shared_ptr<ResolverBackend> backend);
+
+    /*!
+        \brief Start resolving a hostname (or return the cached or in-flight result).
+        \param host Hostname or numeric IPv4 address.
+        \return Becomes ready when the name is resolved.
+    */
+    std::shared_future<ResolvedHost> resolve(const std::string &host);
+
+    /*!
+        \brief Start resolving the hosts of a list of URLs (e.g. trackers) so they are cached before use.
+        \param urls URLs such as "udp://tracker.example.org:1337/announce"; unparseable ones are skipped.
+    */
+    void prefetch(const std::vector<std::string> &urls);
+
+    /*!
+        \brief Split "host" or "host:port".
+        \param text The address.
+        \param host Receives the host.
+        \param port Receives the port (unchanged if none is given).
+        \return False if the port is not a number in range.
+    */
+    static bool splitHostPort(const std::string &text, std::string &host, uint16_t &port);
+
+    /*!
+        \brief Extract the host and port from a URL; the port defaults from the scheme (http 80, https 443).
+        \param url The URL.
+        \param host Receives the host.
+        \param port Receives the port.
+        \return False if the URL has no host or no usable port.
+    */
+    static bool splitUrl(const std::string &url, std::string &host, uint16_t &port);
+
+private:
+    std::mutex mutex;                                                        //!> Guards backend and cache.
+    std::shared_ptr<ResolverBackend> backend;                                //!> Name lookup.
+    std::unordered_map<std::string, std::shared_future<ResolvedHost>> cache; //!> Cached and in-flight results by host.
+};
+
+#endif
@@ -0,0 +1,802 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\HttpTrackerClient.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 18:04:13
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "HttpTrackerClient.h"
+#include "BencodeDocument.h"
+#include "BencodeStreamDecoder.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+#define INVALID_SOCKET -1
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL //!> A tracker hanging up must not raise SIGPIPE
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define RECEIVE_CHUNK 16384
+#define MAX_HEADER 16384
+#define USER_AGENT "MolexTorrent/0.1"
+
+/*!
+    \brief Percent-encode raw bytes for a query string.
+    \param data The bytes.
+    \param size Byte count.
+    \return The encoded text.
+*/
+static std::string urlEncode(const uint8_t *data, size_t size)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    std::string encoded;
+    encoded.reserve(size * 3);
+    for (size_t i = 0; i < size; ++i)
+    {
+        uint8_t c = data[i];
+        if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~')
+        {
+            encoded += static_cast<char>(c);
+        }
+        else
+        {
+            encoded += '%';
+            encoded += hex[c >> 4];
+            encoded += hex[c & 0x0F];
+        }
+    }
+    return encoded;
+}
+
+/*!
+    \brief Case-insensitive prefix test for header names.
+    \param line The header line.
+    \param name Lowercase header name including the colon.
+    \return True if the line starts with the name.
+*/
+static bool headerIs(std::string_view line, std::string_view name)
+{
+    if (line.size() < name.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        if (std::tolower(static_cast<unsigned char>(line[i])) != name[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    \brief Case-insensitive substring test for header values.
+    \param value The header value.
+    \param token Lowercase token to find.
+    \return True if the value contains the token.
+*/
+static bool headerHas(std::string_view value, std::string_view token)
+{
+    std::string lowered(value);
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    return lowered.find(token) != std::string::npos;
+}
+
+/*!
+    \brief Creates a client.
+    \param timeout Connect, send and receive timeout per operation.
+    \param resolver Resolver for tracker hostnames.
+*/
+HttpTrackerClient::HttpTrackerClient(std::chrono::milliseconds timeout, HostResolver &resolver)
+    : timeout(timeout), resolver(resolver)
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        throw std::runtime_error("WSAStartup failed");
+    }
+#endif
+}
+
+/*!
+    \brief The process-wide client, created on first use.
+    \return The shared client.
+*/
+HttpTrackerClient &HttpTrackerClient::shared()
+{
+    static HttpTrackerClient client;
+    return client;
+}
+
+/*!
+    \brief Closes every pooled connection.
+*/
+HttpTrackerClient::~HttpTrackerClient()
+{
+    for (auto &entry : idle)
+    {
+        closeConnection(entry.second);
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+/*!
+    \brief Split an http:// URL into host, port and request target.
+    \param url The URL.
+    \param endpoint Receives the parts.
+    \return False if the URL is not http:// or has no host.
+*/
+bool HttpTrackerClient::parseUrl(const std::string &url, Endpoint &endpoint)
+{
+    if (url.compare(0, 7, "http://") != 0 || !HostResolver::splitUrl(url, endpoint.host, endpoint.port))
+    {
+        return false;
+    }
+    size_t slash = url.find('/', 7);
+    endpoint.target = slash == std::string::npos ? "/" : url.substr(slash);
+    return true;
+}
+
+/*!
+    \brief Derive the scrape URL from an announce URL ("/announce" becomes "/scrape").
+    \param announceUrl The announce URL.
+    \return The scrape URL, or an empty string if the tracker does not support scrape.
+*/
+std::string HttpTrackerClient::scrapeUrl(const std::string &announceUrl)
+{
+    size_t slash = announceUrl.rfind('/', announceUrl.find('?'));
+    if (slash == std::string::npos || announceUrl.compare(slash + 1, 8, "announce") != 0)
+    {
+        return std::string();
+    }
+    return announceUrl.substr(0, slash + 1) + "scrape" + announceUrl.substr(slash + 9);
+}
+
+/*!
+    \brief Build the announce query parameters.
+    \param request The announce.
+    \return The query string, without the leading separator.
+*/
+std::string HttpTrackerClient::announceQuery(const TrackerAnnounce &request)
+{
+    static const char *events[] = {"", "completed", "started", "stopped"};
+
+    std::string query = "info_hash=" + urlEncode(request.infoHash.data(), request.infoHash.size()) +
+                        "&peer_id=" + urlEncode(request.peerId.data(), request.peerId.size()) +
+                        "&port=" + std::to_string(request.port) +
+                        "&uploaded=" + std::to_string(request.uploaded) +
+                        "&downloaded=" + std::to_string(request.downloaded) +
+                        "&left=" + std::to_string(request.left) +
+                        "&compact=1";
+    if (request.numWant >= 0)
+    {
+        query += "&numwant=" + std::to_string(request.numWant);
+    }
+    if (request.event > 0 && request.event < 4)
+    {
+        query += "&event=" + std::string(events[request.event]);
+    }
+    return query;
+}
+
+/*!
+    \brief Open a TCP connection to a tracker.
+    \param endpoint The tracker.
+    \param connection Receives the socket.
+    \param error Receives the failure reason.
+    \return False if the tracker could not be reached.
+*/
+bool HttpTrackerClient::openConnection(const Endpoint &endpoint, Connection &connection, std::string &error)
+{
+    std::shared_future<ResolvedHost> resolved = resolver.resolve(endpoint.host);
+    if (resolved.wait_for(timeout) != std::future_status::ready)
+    {
+        error = "Timed out resolving tracker host";
+        return false;
+    }
+    if (resolved.get().addresses.empty())
+    {
+        error = "Could not resolve tracker host";
+        return false;
+    }
+    sockaddr_in address = resolved.get().addresses.front();
+    address.sin_port = htons(endpoint.port);
+
+    connection.sock = socket(AF_INET, SOCK_STREAM, 0);
+#ifdef _WIN32
+    if (connection.sock == INVALID_SOCKET)
+#else
+    if (connection.sock < 0)
+#endif
+    {
+        connection.sock = INVALID_SOCKET;
+        error = "Failed to create socket";
+        return false;
+    }
+
+#ifdef _WIN32
+    DWORD tv = static_cast<DWORD>(timeout.count());
+#else
+    timeval tv;
+    tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+#endif
+    setsockopt(connection.sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&tv), sizeof(tv));
+    setsockopt(connection.sock, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char *>(&tv), sizeof(tv));
+    int noDelay = 1;
+    setsockopt(connection.sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+
+    if (connect(connection.sock, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        closeConnection(connection);
+        error = "Failed to connect to tracker";
+        return false;
+    }
+    connection.input.clear();
+    return true;
+}
+
+/*!
+    \brief Close a connection.
+    \param connection The connection.
+*/
+void HttpTrackerClient::closeConnection(Connection &connection)
+{
+    if (connection.sock != INVALID_SOCKET)
+    {
+#ifdef _WIN32
+        closesocket(connection.sock);
+#else
+        close(connection.sock);
+#endif
+        connection.sock = INVALID_SOCKET;
+    }
+    connection.input.clear();
+}
+
+/*!
+    \brief Return a connection to the pool; only one idle connection is kept per tracker.
+    \param key The tracker's "host:port".
+    \param connection The connection (moved from).
+*/
+void HttpTrackerClient::release(const std::string &key, Connection &connection)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = idle.find(key);
+    if (it == idle.end())
+    {
+        idle.emplace(key, std::move(connection));
+        connection.sock = INVALID_SOCKET;
+    }
+    else
+    {
+        closeConnection(connection);
+    }
+}
+
+/*!
+    \brief Write the whole buffer.
+    \param connection The connection.
+    \param data The bytes.
+    \return False on error or timeout.
+*/
+bool HttpTrackerClient::sendAll(Connection &connection, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        int result = send(connection.sock, data.data() + sent, static_cast<int>(data.size() - sent), SEND_FLAGS);
+        if (result <= 0)
+        {
+            return false;
+        }
+        sent += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+/*!
+    \brief Append whatever the socket has to the input buffer, waiting up to the timeout.
+    \param connection The connection.
+    \return False on close, error or timeout.
+*/
+bool HttpTrackerClient::fill(Connection &connection)
+{
+    size_t used = connection.input.size();
+    connection.input.resize(used + RECEIVE_CHUNK);
+    int received = recv(connection.sock, &connection.input[used], RECEIVE_CHUNK, 0);
+    connection.input.resize(used + static_cast<size_t>(std::max(received, 0)));
+    return received > 0;
+}
+
+/*!
+    \brief Read one response off the connection, leaving any pipelined successors buffered.
+    Handles Content-Length, chunked and unframed bodies; an unframed body ends where its
+    bencoded value does, or at close if it is not bencode.
+    \param connection The connection.
+    \param reply Receives the status and body.
+    \param keepAlive Receives whether the connection may carry further responses.
+    \return False if no complete response arrived.
+*/
+bool HttpTrackerClient::readResponse(Connection &connection, Reply &reply, bool &keepAlive)
+{
+    std::string &input = connection.input;
+    size_t headerEnd;
+    while ((headerEnd = input.find("\r\n\r\n")) == std::string::npos)
+    {
+        if (input.size() > MAX_HEADER || !fill(connection))
+        {
+            return false;
+        }
+    }
+
+    //* Status line and the three headers that decide framing and reuse
+    std::string_view head(input.data(), headerEnd);
+    size_t lineEnd = head.find("\r\n");
+    std::string_view statusLine = head.substr(0, lineEnd);
+    if (statusLine.size() < 12 || statusLine.compare(0, 5, "HTTP/") != 0)
+    {
+        return false;
+    }
+    int status = std::atoi(std::string(statusLine.substr(9, 3)).c_str());
+    keepAlive = statusLine.compare(5, 3, "1.0") != 0;
+
+    bool chunked = false;
+    bool hasLength = false;
+    size_t contentLength = 0;
+    while (lineEnd != std::string_view::npos)
+    {
+        size_t start = lineEnd + 2;
+        lineEnd = head.find("\r\n", start);
+        std::string_view line = head.substr(start, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - start);
+        std::string_view value = line.substr(std::min(line.find(':') + 1, line.size()));
+        if (headerIs(line, "content-length:"))
+        {
+            hasLength = true;
+            contentLength = std::strtoull(std::string(value).c_str(), nullptr, 10);
+        }
+        else if (headerIs(line, "transfer-encoding:"))
+        {
+            chunked = headerHas(value, "chunked");
+        }
+        else if (headerIs(line, "connection:"))
+        {
+            keepAlive = headerHas(value, "close") ? false : (keepAlive || headerHas(value, "keep-alive"));
+        }
+    }
+
+    size_t position = headerEnd + 4;
+    std::string body;
+    if (chunked)
+    {
+        while (true)
+        {
+            size_t sizeEnd;
+            while ((sizeEnd = input.find("\r\n", position)) == std::string::npos)
+            {
+                if (!fill(connection))
+                {
+                    return false;
+                }
+            }
+            size_t chunkSize = std::strtoull(input.c_str() + position, nullptr, 16);
+            position = sizeEnd + 2;
+            if (chunkSize == 0)
+            {
+                //* Skip any trailers up to the blank line
+                while (true)
+                {
+                    while ((sizeEnd = input.find("\r\n", position)) == std::string::npos)
+                    {
+                        if (!fill(connection))
+                        {
+                            return false;
+                        }
+                    }
+                    bool blank = sizeEnd == position;
+                    position = sizeEnd + 2;
+                    if (blank)
+                    {
+                        break;
+                    }
+                }
+                break;
+            }
+            if (body.size() + chunkSize > MAX_RESPONSE)
+            {
+                return false;
+            }
+            while (input.size() < position + chunkSize + 2)
+            {
+                if (!fill(connection))
+                {
+                    return false;
+                }
+            }
+            body.append(input, position, chunkSize);
+            position += chunkSize + 2;
+        }
+    }
+    else if (hasLength)
+    {
+        if (contentLength > MAX_RESPONSE)
+        {
+            return false;
+        }
+        while (input.size() < position + contentLength)
+        {
+            if (!fill(connection))
+            {
+                return false;
+            }
+        }
+        body.assign(input, position, contentLength);
+        position += contentLength;
+    }
+    else
+    {
+        //* No framing: the body runs to the end of the connection, but a bencoded one is
+        //* done as soon as its top-level value closes, so don't wait for the tracker to hang up
+        BencodeEventHandler ignore;
+        BencodeStreamDecoder decoder(ignore);
+        size_t decoded = position;
+        bool bencoded = true;
+        while (true)
+        {
+            if (bencoded && decoded < input.size())
+            {
+                try
+                {
+                    decoded += decoder.feed(std::string_view(input).substr(decoded));
+                }
+                catch (const std::runtime_error &)
+                {
+                    bencoded = false; //!> Not bencode (an error page); read it all
+                }
+                if (bencoded && decoder.isComplete())
+                {
+                    break;
+                }
+            }
+            if (input.size() - position > MAX_RESPONSE || !fill(connection))
+            {
+                break;
+            }
+        }
+        size_t end = bencoded && decoder.isComplete() ? decoded : input.size();
+        body.assign(input, position, end - position);
+        position = end;
+        keepAlive = false;
+    }
+    input.erase(0, position);
+
+    reply.ok = status == 200;
+    reply.body = std::move(body);
+    reply.error = reply.ok ? std::string() : "Tracker returned HTTP " + std::to_string(status);
+    return true;
+}
+
+/*!
+    \brief Send GET requests to one tracker over its pooled connection, pipelined, and collect the responses.
+    A reused connection the tracker has since closed, or a connection the tracker closes part
+    way through a pipeline, is replaced and the unanswered requests are resent.
+    \param endpoint The tracker.
+    \param targets Request target (path and query) of each request.
+    \return One reply per target, in order.
+*/
+std::vector<HttpTrackerClient::Reply> HttpTrackerClient::exchange(const Endpoint &endpoint, const std::vector<std::string> &targets)
+{
+    std::vector<Reply> replies(targets.size());
+    std::string key = endpoint.host + ":" + std::to_string(endpoint.port);
+    std::string hostHeader = endpoint.port == 80 ? endpoint.host : key;
+
+    Connection connection{INVALID_SOCKET, std::string()};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = idle.find(key);
+        if (it != idle.end())
+        {
+            connection = std::move(it->second);
+            idle.erase(it);
+        }
+    }
+
+    size_t done = 0;
+    while (done < targets.size())
+    {
+        bool fresh = connection.sock == INVALID_SOCKET;
+        std::string error;
+        if (fresh && !openConnection(endpoint, connection, error))
+        {
+            for (size_t i = done; i < targets.size(); ++i)
+            {
+                replies[i].error = error;
+            }
+            break;
+        }
+
+        size_t window = std::min(MAX_PIPELINE, targets.size() - done);
+        std::string batch;
+        for (size_t i = done; i < done + window; ++i)
+        {
+            batch += "GET " + targets[i] + " HTTP/1.1\r\n";
+            batch += "Host: " + hostHeader + "\r\n";
+            batch += "User-Agent: " USER_AGENT "\r\nAccept-Encoding: identity\r\nConnection: keep-alive\r\n\r\n";
+        }
+
+        size_t before = done;
+        bool keepAlive = sendAll(connection, batch);
+        for (size_t i = 0; keepAlive && i < window; ++i)
+        {
+            if (!readResponse(connection, replies[done], keepAlive))
+            {
+                keepAlive = false;
+                break;
+            }
+            done++;
+        }
+        if (!keepAlive)
+        {
+            closeConnection(connection);
+        }
+
+        if (done == before && fresh)
+        {
+            for (size_t i = done; i < targets.size(); ++i)
+            {
+                replies[i].error = "No response from tracker";
+            }
+            break;
+        }
+    }
+
+    if (connection.sock != INVALID_SOCKET)
+    {
+        release(key, connection);
+    }
+    return replies;
+}
+
+/*!
+    \brief Decode a bencoded announce response.
+    \param body The response body.
+    \param response Receives the interval, counts and peers, or the failure reason.
+    \return True if the tracker accepted the announce.
+*/
+bool HttpTrackerClient::parseAnnounce(std::string_view body, TrackerResponse &response)
+{
+    BencodeDocument document;
+    try
+    {
+        document.parse(body);
+    }
+    catch (const std::exception &)
+    {
+        response.ok = false;
+        response.error = "Malformed tracker response";
+        return false;
+    }
+
+    BencodeValue root = document.root();
+    BencodeValue failure = root.find("failure reason");
+    if (failure.isString() || !root.isDictionary())
+    {
+        response.ok = false;
+        response.error = failure.isString() ? std::string(failure.asString()) : "Malformed tracker response";
+        return false;
+    }
+
+    response.interval = static_cast<uint32_t>(root.find("interval").asInteger());
+    response.seeders = static_cast<uint32_t>(root.find("complete").asInteger());
+    response.leechers = static_cast<uint32_t>(root.find("incomplete").asInteger());
+
+    BencodeValue peers = root.find("peers");
+    if (peers.isString())
+    {
+        std::string_view compact = peers.asString();
+        for (size_t offset = 0; offset + PeerEndpoint::COMPACT_V4_SIZE <= compact.size(); offset += PeerEndpoint::COMPACT_V4_SIZE)
+        {
+            response.peers.push_back(PeerEndpoint::fromCompact(compact.substr(offset, PeerEndpoint::COMPACT_V4_SIZE)));
+        }
+    }
+    else
+    {
+        //* Original dictionary model, for trackers that ignore compact=1
+        for (BencodeValue peer : peers)
+        {
+            std::string ip(peer.find("ip").asString());
+            uint16_t port = static_cast<uint16_t>(peer.find("port").asInteger());
+            PeerEndpoint endpoint = PeerEndpoint::parse(ip.find(':') == std::string::npos
+                                                            ? ip + ":" + std::to_string(port)
+                                                            : "[" + ip + "]:" + std::to_string(port));
+            if (endpoint.isValid())
+            {
+                response.peers.push_back(endpoint);
+            }
+        }
+    }
+
+    std::string_view compact6 = root.find("peers6").asString();
+    for (size_t offset = 0; offset + PeerEndpoint::COMPACT_V6_SIZE <= compact6.size(); offset += PeerEndpoint::COMPACT_V6_SIZE)
+    {
+        response.peers.push_back(PeerEndpoint::fromCompact(compact6.substr(offset, PeerEndpoint::COMPACT_V6_SIZE)));
+    }
+
+    response.ok = true;
+    response.error.clear();
+    return true;
+}
+
+/*!
+    \brief Announce many torrents to one tracker over its pooled connection.
+    \param tracker The tracker's announce URL (http://).
+    \param requests One announce per torrent.
+    \return One response per request, in order.
+*/
+std::vector<TrackerResponse> HttpTrackerClient::announce(const std::string &tracker, const std::vector<TrackerAnnounce> &requests)
+{
+    std::vector<TrackerResponse> responses(requests.size());
+    for (TrackerResponse &response : responses)
+    {
+        response.tracker = tracker;
+    }
+
+    Endpoint endpoint;
+    if (!parseUrl(tracker, endpoint))
+    {
+        for (TrackerResponse &response : responses)
+        {
+            response.error = "Invalid tracker URL";
+        }
+        return responses;
+    }
+
+    char separator = endpoint.target.find('?') == std::string::npos ? '?' : '&';
+    std::vector<std::string> targets;
+    targets.reserve(requests.size());
+    for (const TrackerAnnounce &request : requests)
+    {
+        targets.push_back(endpoint.target + separator + announceQuery(request));
+    }
+
+    std::vector<Reply> replies = exchange(endpoint, targets);
+    for (size_t i = 0; i < replies.size(); ++i)
+    {
+        if (replies[i].ok)
+        {
+            parseAnnounce(replies[i].body, responses[i]);
+        }
+        else
+        {
+            responses[i].error = replies[i].error;
+        }
+    }
+    return responses;
+}
+
+/*!
+    \brief Announce one torrent to every http:// tracker in the list, all at once.
+    \param trackers Tracker URLs; other schemes are skipped.
+    \param request The announce.
+    \return One response per http:// tracker, in list order.
+*/
+std::vector<TrackerResponse> HttpTrackerClient::announce(const std::vector<std::string> &trackers, const TrackerAnnounce &request)
+{
+    std::vector<std::future<TrackerResponse>> pending;
+    for (const std::string &url : trackers)
+    {
+        if (url.compare(0, 7, "http://") != 0)
+        {
+            continue;
+        }
+        pending.push_back(std::async(std::launch::async, [this, url, &request]()
+                                     { return announce(url, std::vector<TrackerAnnounce>{request}).front(); }));
+    }
+
+    std::vector<TrackerResponse> responses;
+    responses.reserve(pending.size());
+    for (auto &response : pending)
+    {
+        responses.push_back(response.get());
+    }
+    return responses;
+}
+
+/*!
+    \brief Scrape swarm counts for many torrents from one tracker.
+    \param tracker The tracker's announce URL; its scrape URL is derived from it.
+    \param infoHashes The torrents.
+    \return One entry per info hash, in order.
+*/
+std::vector<TrackerScrape> HttpTrackerClient::scrape(const std::string &tracker, const std::vector<std::array<uint8_t, 20>> &infoHashes)
+{
+    std::vector<TrackerScrape> results(infoHashes.size());
+    for (size_t i = 0; i < infoHashes.size(); ++i)
+    {
+        results[i].infoHash = infoHashes[i];
+    }
+
+    Endpoint endpoint;
+    if (!parseUrl(scrapeUrl(tracker), endpoint))
+    {
+        return results;
+    }
+
+    char separator = endpoint.target.find('?') == std::string::npos ? '?' : '&';
+    std::vector<std::string> targets;
+    for (size_t first = 0; first < infoHashes.size(); first += SCRAPE_BATCH)
+    {
+        std::string target = endpoint.target;
+        for (size_t i = first; i < std::min(first + SCRAPE_BATCH, infoHashes.size()); ++i)
+        {
+            target += (i == first ? separator : '&');
+            target += "info_hash=" + urlEncode(infoHashes[i].data(), infoHashes[i].size());
+        }
+        targets.push_back(std::move(target));
+    }
+
+    std::vector<Reply> replies = exchange(endpoint, targets);
+    BencodeDocument document;
+    for (size_t batch = 0; batch < replies.size(); ++batch)
+    {
+        if (!replies[batch].ok)
+        {
+            continue;
+        }
+        try
+        {
+            if (!document.parse(replies[batch].body, {"files"})) //!> Skips anything else the tracker sent
+            {
+                continue;
+            }
+        }
+        catch (const std::exception &)
+        {
+            continue;
+        }
+
+        BencodeValue files = document.root();
+        size_t first = batch * SCRAPE_BATCH;
+        for (size_t i = first; i < std::min(first + SCRAPE_BATCH, infoHashes.size()); ++i)
+        {
+            BencodeValue entry = files.find(std::string_view(reinterpret_cast<const char *>(infoHashes[i].data()), infoHashes[i].size()));
+            if (entry.isDictionary())
+            {
+                results[i].ok = true;
+                results[i].seeders = static_cast<uint32_t>(entry.find("complete").asInteger());
+                results[i].completed = static_cast<uint32_t>(entry.find("downloaded").asInteger());
+                results[i].leechers = static_cast<uint32_t>(entry.find("incomplete").asInteger());
+            }
+        }
+    }
+    return results;
+}
@@ -0,0 +1,167 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\HttpTrackerClient.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 17:52:40
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef HTTP_TRACKER_CLIENT_H
+#define HTTP_TRACKER_CLIENT_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include "HostResolver.h"
+#include "UdpTrackerClient.h"
+
+/*!
+    \brief Swarm counts for one torrent from a scrape.
+*/
+struct TrackerScrape
+{
+    std::array<uint8_t, 20> infoHash{}; //!> The torrent.
+    bool ok = false;                    //!> True if the tracker reported on it.
+    uint32_t seeders = 0;               //!> `complete`.
+    uint32_t completed = 0;             //!> `downloaded`: times the torrent was completed.
+    uint32_t leechers = 0;              //!> `incomplete`.
+};
+
+/*!
+    \brief HTTP tracker client (BEP 3 announce, BEP 23 compact peers, BEP 7 peers6, scrape).
+    Keeps one persistent HTTP/1.1 connection per tracker and pipelines requests on it: up to
+    MAX_PIPELINE requests are written before their responses are read back in order. If the
+    tracker closes the connection part way, the unanswered requests are resent on a new one.
+    Compact peer lists are decoded straight from the response buffer.
+*/
+class HttpTrackerClient
+{
+public:
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+#else
+    using SocketHandle = int;
+#endif
+
+    static constexpr size_t MAX_PIPELINE = 32;          //!> Requests in flight on one connection.
+    static constexpr size_t SCRAPE_BATCH = 64;          //!> Info hashes per scrape request.
+    static constexpr size_t MAX_RESPONSE = 1024 * 1024; //!> Largest response accepted.
+
+    /*!
+        \brief Creates a client.
+        \param timeout Connect, send and receive timeout per operation.
+        \param resolver Resolver for tracker hostnames.
+    */
+    explicit HttpTrackerClient(std::chrono::milliseconds timeout = std::chrono::milliseconds(10000),
+                               HostResolver &resolver = HostResolver::shared());
+
+    /*!
+        \brief Closes every pooled connection.
+    */
+    ~HttpTrackerClient();
+
+    HttpTrackerClient(const HttpTrackerClient &) = delete;
+    HttpTrackerClient &operator=(const HttpTrackerClient &) = delete;
+
+    /*!
+        \brief The process-wide client, created on first use.
+        Every torrent announces through it, so they share its kept-alive tracker connections.
+        \return The shared client.
+    */
+    static HttpTrackerClient &shared();
+
+    /*!
+        \brief Announce many torrents to one tracker over its pooled connection.
+        \param tracker The tracker's announce URL (http://).
+        \param requests One announce per torrent.
+        \return One response per request, in order.
+    */
+    std::vector<TrackerResponse> announce(const std::string &tracker, const std::vector<TrackerAnnounce> &requests);
+
+    /*!
+        \brief Announce one torrent to every http:// tracker in the list, all at once.
+        \param trackers Tracker URLs; other schemes are skipped.
+        \param request The announce.
+        \return One response per http:// tracker, in list order.
+    */
+    std::vector<TrackerResponse> announce(const std::vector<std::string> &trackers, const TrackerAnnounce &request);
+
+    /*!
+        \brief Scrape swarm counts for many torrents from one tracker.
+        \param tracker The tracker's announce URL; its scrape URL is derived from it.
+        \param infoHashes The torrents.
+        \return One entry per info hash, in order.
+    */
+    std::vector<TrackerScrape> scrape(const std::string &tracker, const std::vector<std::array<uint8_t, 20>> &infoHashes);
+
+    /*!
+        \brief Decode a bencoded announce response.
+        \param body The response body.
+        \param response Receives the interval, counts and peers, or the failure reason.
+        \return True if the tracker accepted the announce.
+    */
+    static bool parseAnnounce(std::string_view body, TrackerResponse &response);
+
+    /*!
+        \brief Derive the scrape URL from an announce URL ("/announce" becomes "/scrape").
+        \param announceUrl The announce URL.
+        \return The scrape URL, or an empty string if the tracker does not support scrape.
+    */
+    static std::string scrapeUrl(const std::string &announceUrl);
+
+private:
+    struct Endpoint
+    {
+        std::string host;   //!> Host name, for the Host header.
+        uint16_t port = 80; //!> TCP port.
+        std::string target; //!> Path and any query string from the URL.
+    };
+
+    struct Connection
+    {
+        SocketHandle sock; //!> Connected socket.
+        std::string input; //!> Bytes received but not yet parsed (may hold later responses).
+    };
+
+    struct Reply
+    {
+        bool ok = false;   //!> A full response with status 200 arrived.
+        std::string body;  //!> Response body.
+        std::string error; //!> Failure reason when !ok.
+    };
+
+    std::chrono::milliseconds timeout;                //!> Per-operation timeout.
+    HostResolver &resolver;                           //!> Tracker name resolver.
+    std::mutex mutex;                                 //!> Guards idle.
+    std::unordered_map<std::string, Connection> idle; //!> Pooled connection per "host:port".
+
+    std::vector<Reply> exchange(const Endpoint &endpoint, const std::vector<std::string> &targets);
+    bool openConnection(const Endpoint &endpoint, Connection &connection, std::string &error);
+    bool sendAll(Connection &connection, const std::string &data);
+    bool fill(Connection &connection);
+    bool readResponse(Connection &connection, Reply &reply, bool &keepAlive);
+    void release(const std::string &key, Connection &connection);
+    void closeConnection(Connection &connection);
+
+    static bool parseUrl(const std::string &url, Endpoint &endpoint);
+    static std::string announceQuery(const TrackerAnnounce &request);
+};
+
+#endif
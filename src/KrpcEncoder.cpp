@@ -0,0 +1,62 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\KrpcEncoder.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 11:07:10
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "KrpcEncoder.h"
+#include <stdexcept>
+#include <cstring>
+
+/*!
+    \brief Locate a field in a template at compile time.
+    \param tmpl The template.
+    \param marker The text immediately before the field.
+    \return Offset of the field's first byte.
+*/
+static constexpr size_t fieldOffset(std::string_view tmpl, std::string_view marker)
+{
+    return tmpl.find(marker) + marker.size();
+}
+
+static constexpr size_t GET_PEERS_ID = fieldOffset(KrpcEncoder::GET_PEERS_TEMPLATE, "2:id20:");
+static constexpr size_t GET_PEERS_INFO_HASH = fieldOffset(KrpcEncoder::GET_PEERS_TEMPLATE, "9:info_hash20:");
+static constexpr size_t GET_PEERS_TID = fieldOffset(KrpcEncoder::GET_PEERS_TEMPLATE, "1:t2:");
+
+static_assert(GET_PEERS_INFO_HASH + 20 < GET_PEERS_TID, "get_peers template is malformed");
+
+/*!
+    \brief Copy a transaction ID into a template, checking its size.
+    \param out The message buffer.
+    \param offset Offset of the transaction ID field.
+    \param transactionId The transaction ID.
+*/
+static void stampTransactionId(char *out, size_t offset, std::string_view transactionId)
+{
+    if (transactionId.size() != KrpcEncoder::TRANSACTION_ID_SIZE)
+        throw std::runtime_error("Transaction ID must be two bytes");
+    std::memcpy(out + offset, transactionId.data(), KrpcEncoder::TRANSACTION_ID_SIZE);
+}
+
+/*!
+    \brief Encode a get_peers query.
+    \param out Destination buffer of at least GET_PEERS_SIZE bytes.
+    \param transactionId Two-byte transaction ID.
+    \param id Our node ID.
+    \param infoHash The torrent's info hash.
+    \return Bytes written.
+*/
+size_t KrpcEncoder::encodeGetPeers(char *out, std::string_view transactionId, const NodeId &id, const NodeId &infoHash)
+{
+    std::memcpy(out, GET_PEERS_TEMPLATE.data(), GET_PEERS_SIZE);
+    std::memcpy(out + GET_PEERS_ID, id.data(), id.size());
+    std::memcpy(out + GET_PEERS_INFO_HASH, infoHash.data(), infoHash.size());
+    stampTransactionId(out, GET_PEERS_TID, transactionId);
+    return GET_PEERS_SIZE;
+}
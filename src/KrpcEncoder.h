@@ -0,0 +1,50 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\KrpcEncoder.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 11:06:52
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef KRPC_ENCODER_H
+#define KRPC_ENCODER_H
+
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief Builds DHT (KRPC) query messages.
+    Fixed-shape queries are stamped from templates whose field offsets are computed at
+    compile time, so building one is a memcpy plus three field copies.
+*/
+class KrpcEncoder
+{
+public:
+    using NodeId = std::array<uint8_t, 20>;
+
+    static constexpr size_t TRANSACTION_ID_SIZE = 2; //!> Transaction IDs are always two bytes.
+
+    //* Canonical (sorted-key) template; '.' bytes are placeholders.
+    static constexpr std::string_view GET_PEERS_TEMPLATE =
+        "d1:ad2:id20:....................9:info_hash20:....................e1:q9:get_peers1:t2:..1:y1:qe";
+
+    static constexpr size_t GET_PEERS_SIZE = GET_PEERS_TEMPLATE.size();
+
+    /*!
+        \brief Encode a get_peers query.
+        \param out Destination buffer of at least GET_PEERS_SIZE bytes.
+        \param transactionId Two-byte transaction ID.
+        \param id Our node ID.
+        \param infoHash The torrent's info hash.
+        \return Bytes written.
+    */
+    static size_t encodeGetPeers(char *out, std::string_view transactionId, const NodeId &id, const NodeId &infoHash);
+};
+
+#endif
@@ -0,0 +1,448 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\LocalServiceDiscovery.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 20:17:09
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "LocalServiceDiscovery.h"
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <random>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#endif
+
+#define MAX_DATAGRAM 1400
+
+/*!
+    \brief Match a header name case-insensitively and return its trimmed value.
+    \param line The header line.
+    \param name Lowercase name without the colon.
+    \param value Receives the value.
+    \return True if the line is that header.
+*/
+static bool headerValue(std::string_view line, std::string_view name, std::string_view &value)
+{
+    if (line.size() <= name.size() || line[name.size()] != ':')
+    {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        if (std::tolower(static_cast<unsigned char>(line[i])) != name[i])
+        {
+            return false;
+        }
+    }
+    value = line.substr(name.size() + 1);
+    while (!value.empty() && value.front() == ' ')
+    {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && value.back() == ' ')
+    {
+        value.remove_suffix(1);
+    }
+    return true;
+}
+
+/*!
+    \brief Joins the multicast group and starts the worker thread.
+    \param listenPort Port we accept peer connections on (advertised to others), or 0 to only listen.
+    \param group Multicast group address.
+    \param groupPort Multicast port.
+*/
+LocalServiceDiscovery::LocalServiceDiscovery(uint16_t listenPort, const std::string &group, uint16_t groupPort)
+    : listenPort(listenPort)
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        throw std::runtime_error("WSAStartup failed");
+    }
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock == INVALID_SOCKET)
+    {
+        WSACleanup();
+        throw std::runtime_error("Failed to create LSD socket");
+    }
+#else
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0)
+    {
+        throw std::runtime_error("Failed to create LSD socket");
+    }
+#endif
+
+    //* Every process on the host binds the same port and gets its own copy of each datagram
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#endif
+
+    groupAddress.sin_family = AF_INET;
+    groupAddress.sin_port = htons(groupPort);
+    if (inet_pton(AF_INET, group.c_str(), &groupAddress.sin_addr) != 1)
+    {
+        closeSocket();
+        throw std::runtime_error("Invalid LSD multicast group");
+    }
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(groupPort);
+    if (bind(sock, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0)
+    {
+        closeSocket();
+        throw std::runtime_error("Failed to bind LSD socket");
+    }
+
+    ip_mreq membership{};
+    membership.imr_multiaddr = groupAddress.sin_addr;
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char *>(&membership), sizeof(membership)) != 0)
+    {
+        closeSocket();
+        throw std::runtime_error("Failed to join LSD multicast group");
+    }
+
+    unsigned char ttl = 1; //!> Stay on the local network
+    unsigned char loop = 1;
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char *>(&ttl), sizeof(ttl));
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char *>(&loop), sizeof(loop));
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(sock, FIONBIO, &nonBlocking);
+#else
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    std::random_device rd;
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 0; i < 16; ++i)
+    {
+        cookie += hex[rd() & 0x0F];
+    }
+
+    worker = std::thread([this]()
+                         { run(); });
+}
+
+/*!
+    \brief Stops the worker thread and leaves the group.
+*/
+LocalServiceDiscovery::~LocalServiceDiscovery()
+{
+    stopping = true;
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+    closeSocket();
+}
+
+/*!
+    \brief Closes the socket.
+*/
+void LocalServiceDiscovery::closeSocket()
+{
+#ifdef _WIN32
+    if (sock != INVALID_SOCKET)
+    {
+        closesocket(sock);
+        WSACleanup();
+        sock = INVALID_SOCKET;
+    }
+#else
+    if (sock >= 0)
+    {
+        close(sock);
+        sock = -1;
+    }
+#endif
+}
+
+/*!
+    \brief The process-wide instance, created on first use. It only listens.
+    \return The shared instance.
+*/
+LocalServiceDiscovery &LocalServiceDiscovery::shared()
+{
+    static LocalServiceDiscovery instance(0);
+    return instance;
+}
+
+/*!
+    \brief Start announcing an info hash and send its local peers to a pool.
+    \param infoHash The torrent.
+    \param pool Receives local peers with priority.
+*/
+void LocalServiceDiscovery::watch(const InfoHash &infoHash, PeerCandidatePool &pool)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Torrent &torrent = torrents[infoHash];
+    if (std::find(torrent.pools.begin(), torrent.pools.end(), &pool) == torrent.pools.end())
+    {
+        torrent.pools.push_back(&pool);
+    }
+    torrent.requested = true;
+    for (const PeerEndpoint &peer : torrent.peers)
+    {
+        pool.add(peer, PeerSource::Lsd);
+    }
+}
+
+/*!
+    \brief Stop sending peers to a pool.
+    \param infoHash The torrent.
+    \param pool The pool passed to watch().
+*/
+void LocalServiceDiscovery::unwatch(const InfoHash &infoHash, PeerCandidatePool &pool)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = torrents.find(infoHash);
+    if (it == torrents.end())
+    {
+        return;
+    }
+    std::vector<PeerCandidatePool *> &pools = it->second.pools;
+    pools.erase(std::remove(pools.begin(), pools.end(), &pool), pools.end());
+    if (pools.empty())
+    {
+        torrents.erase(it);
+    }
+}
+
+/*!
+    \brief Local peers heard for an info hash so far.
+    \param infoHash The torrent.
+    \return The peers.
+*/
+std::vector<PeerEndpoint> LocalServiceDiscovery::peersFor(const InfoHash &infoHash) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = torrents.find(infoHash);
+    return it == torrents.end() ? std::vector<PeerEndpoint>() : it->second.peers;
+}
+
+/*!
+    \brief Decode a 40-character hex info hash.
+    \param hex The text.
+    \param infoHash Receives the bytes.
+    \return False if the text is not 40 hex digits.
+*/
+bool LocalServiceDiscovery::parseInfoHash(std::string_view hex, InfoHash &infoHash)
+{
+    if (hex.size() != infoHash.size() * 2)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < infoHash.size(); ++i)
+    {
+        int value = 0;
+        for (size_t j = 0; j < 2; ++j)
+        {
+            char c = static_cast<char>(std::tolower(static_cast<unsigned char>(hex[i * 2 + j])));
+            if (c >= '0' && c <= '9')
+            {
+                value = value * 16 + (c - '0');
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                value = value * 16 + (c - 'a' + 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        infoHash[i] = static_cast<uint8_t>(value);
+    }
+    return true;
+}
+
+/*!
+    \brief Handle a BT-SEARCH datagram.
+    \param message The datagram.
+    \param from The sender; its address plus the Port header is the peer.
+*/
+void LocalServiceDiscovery::handleMessage(std::string_view message, const sockaddr_in &from)
+{
+    if (message.compare(0, 21, "BT-SEARCH * HTTP/1.1\r") != 0)
+    {
+        return;
+    }
+
+    uint32_t port = 0;
+    std::vector<InfoHash> hashes;
+    size_t position = message.find('\n') + 1;
+    while (position < message.size())
+    {
+        size_t end = message.find('\n', position);
+        std::string_view line = message.substr(position, end == std::string_view::npos ? std::string_view::npos : end - position);
+        position = end == std::string_view::npos ? message.size() : end + 1;
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+
+        std::string_view value;
+        InfoHash infoHash;
+        if (headerValue(line, "cookie", value) && value == cookie)
+        {
+            return; //!> Our own announce, looped back
+        }
+        else if (headerValue(line, "port", value))
+        {
+            port = static_cast<uint32_t>(std::strtoul(std::string(value).c_str(), nullptr, 10));
+        }
+        else if (headerValue(line, "infohash", value) && parseInfoHash(value, infoHash) && hashes.size() < MAX_HASHES_PER_MESSAGE)
+        {
+            hashes.push_back(infoHash);
+        }
+    }
+    if (port == 0 || port > 0xFFFF)
+    {
+        return;
+    }
+
+    sockaddr_in peerAddress = from;
+    peerAddress.sin_port = htons(static_cast<uint16_t>(port));
+    PeerEndpoint peer = PeerEndpoint::fromSockaddr(peerAddress);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const InfoHash &infoHash : hashes)
+    {
+        auto it = torrents.find(infoHash);
+        if (it == torrents.end())
+        {
+            continue; //!> Not a torrent we are interested in
+        }
+        Torrent &torrent = it->second;
+        torrent.requested = true; //!> Answer so the announcer learns of us too
+        if (torrent.peers.size() < MAX_PEERS_PER_TORRENT && torrent.seen.insert(peer))
+        {
+            torrent.peers.push_back(peer);
+            for (PeerCandidatePool *pool : torrent.pools)
+            {
+                pool->add(peer, PeerSource::Lsd);
+            }
+        }
+    }
+}
+
+/*!
+    \brief Announce every watched hash that is due, packing several into each datagram.
+*/
+void LocalServiceDiscovery::announceDue()
+{
+    if (listenPort == 0)
+    {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    std::vector<InfoHash> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &entry : torrents)
+        {
+            Torrent &torrent = entry.second;
+            bool allowed = !torrent.announced || now - torrent.lastAnnounced >= MIN_ANNOUNCE_INTERVAL;
+            bool wanted = torrent.requested || now - torrent.lastAnnounced >= ANNOUNCE_INTERVAL;
+            if (allowed && wanted)
+            {
+                torrent.announced = true;
+                torrent.requested = false;
+                torrent.lastAnnounced = now;
+                due.push_back(entry.first);
+            }
+        }
+    }
+    if (due.empty())
+    {
+        return;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    char groupText[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &groupAddress.sin_addr, groupText, sizeof(groupText));
+
+    for (size_t first = 0; first < due.size(); first += MAX_HASHES_PER_MESSAGE)
+    {
+        std::string message = "BT-SEARCH * HTTP/1.1\r\n";
+        message += "Host: " + std::string(groupText) + ":" + std::to_string(ntohs(groupAddress.sin_port)) + "\r\n";
+        message += "Port: " + std::to_string(listenPort) + "\r\n";
+        for (size_t i = first; i < std::min(first + MAX_HASHES_PER_MESSAGE, due.size()); ++i)
+        {
+            message += "Infohash: ";
+            for (uint8_t byte : due[i])
+            {
+                message += hex[byte >> 4];
+                message += hex[byte & 0x0F];
+            }
+            message += "\r\n";
+        }
+        message += "cookie: " + cookie + "\r\n\r\n\r\n";
+        sendto(sock, message.data(), static_cast<int>(message.size()), 0,
+               reinterpret_cast<const sockaddr *>(&groupAddress), sizeof(groupAddress));
+    }
+}
+
+/*!
+    \brief Worker loop: read announces and send due ones until stopped.
+*/
+void LocalServiceDiscovery::run()
+{
+    char datagram[MAX_DATAGRAM];
+    while (!stopping)
+    {
+        announceDue();
+
+#ifdef _WIN32
+        WSAPOLLFD entry{};
+        entry.fd = sock;
+        entry.events = POLLRDNORM;
+        if (WSAPoll(&entry, 1, static_cast<int>(POLL_INTERVAL.count())) <= 0)
+#else
+        pollfd entry{};
+        entry.fd = sock;
+        entry.events = POLLIN;
+        if (poll(&entry, 1, static_cast<int>(POLL_INTERVAL.count())) <= 0)
+#endif
+        {
+            continue;
+        }
+
+        while (true)
+        {
+            sockaddr_in from{};
+            socklen_t fromLen = sizeof(from);
+            int received = recvfrom(sock, datagram, sizeof(datagram), 0, reinterpret_cast<sockaddr *>(&from), &fromLen);
+            if (received <= 0)
+            {
+                break;
+            }
+            handleMessage(std::string_view(datagram, static_cast<size_t>(received)), from);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\LocalServiceDiscovery.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 19:58:44
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef LOCAL_SERVICE_DISCOVERY_H
+#define LOCAL_SERVICE_DISCOVERY_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "PeerEndpoint.h"
+#include "PeerCandidatePool.h"
+
+/*!
+    \brief Local Service Discovery (BEP 14): finds peers on the LAN over UDP multicast.
+    Announces every watched info hash to the multicast group and listens for other
+    processes' announces, feeding the peers they name into the watching candidate pools
+    ahead of internet peers. With no listening port it only listens, since announcing would
+    send other peers to a port nobody accepts on. Each info hash is announced at most once per
+    MIN_ANNOUNCE_INTERVAL and re-announced every ANNOUNCE_INTERVAL; hearing an announce for a
+    hash we also watch brings our next one forward to the earliest time the rate limit allows,
+    so a newcomer hears about us within a minute rather than five. Our own announces are recognised by a per-process cookie, so several
+    processes on one host can use it together.
+*/
+class LocalServiceDiscovery
+{
+public:
+    using InfoHash = std::array<uint8_t, 20>;
+
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+#else
+    using SocketHandle = int;
+#endif
+
+    static constexpr const char *MULTICAST_GROUP = "239.192.152.143"; //!> BEP 14 IPv4 group.
+    static constexpr uint16_t MULTICAST_PORT = 6771;                  //!> BEP 14 port.
+    static constexpr std::chrono::minutes ANNOUNCE_INTERVAL{5};       //!> Regular re-announce period.
+    static constexpr std::chrono::minutes MIN_ANNOUNCE_INTERVAL{1};   //!> Fastest a hash is announced again.
+    static constexpr size_t MAX_HASHES_PER_MESSAGE = 16;              //!> Infohash lines per datagram.
+    static constexpr size_t MAX_PEERS_PER_TORRENT = 256;              //!> Local peers remembered per hash.
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{250};    //!> Worker wake-up period.
+
+    /*!
+        \brief Joins the multicast group and starts the worker thread.
+        \param listenPort Port we accept peer connections on (advertised to others), or 0 to only listen.
+        \param group Multicast group address.
+        \param groupPort Multicast port.
+        \throws std::runtime_error if the socket cannot be set up.
+    */
+    explicit LocalServiceDiscovery(uint16_t listenPort, const std::string &group = MULTICAST_GROUP,
+                                   uint16_t groupPort = MULTICAST_PORT);
+
+    /*!
+        \brief Stops the worker thread and leaves the group.
+    */
+    ~LocalServiceDiscovery();
+
+    LocalServiceDiscovery(const LocalServiceDiscovery &) = delete;
+    LocalServiceDiscovery &operator=(const LocalServiceDiscovery &) = delete;
+
+    /*!
+        \brief The process-wide instance, created on first use. It only listens: the client
+        does not accept incoming peer connections.
+        \return The shared instance.
+        \throws std::runtime_error if the socket cannot be set up.
+    */
+    static LocalServiceDiscovery &shared();
+
+    /*!
+        \brief Start announcing an info hash and send its local peers to a pool.
+        Peers already known are added at once; later ones as they are heard.
+        \param infoHash The torrent.
+        \param pool Receives local peers with priority (must stay alive until unwatch()).
+    */
+    void watch(const InfoHash &infoHash, PeerCandidatePool &pool);
+
+    /*!
+        \brief Stop sending peers to a pool; the hash stops being announced once nobody watches it.
+        \param infoHash The torrent.
+        \param pool The pool passed to watch().
+    */
+    void unwatch(const InfoHash &infoHash, PeerCandidatePool &pool);
+
+    /*!
+        \brief Local peers heard for an info hash so far.
+        \param infoHash The torrent.
+        \return The peers.
+    */
+    std::vector<PeerEndpoint> peersFor(const InfoHash &infoHash) const;
+
+private:
+    struct Torrent
+    {
+        std::vector<PeerCandidatePool *> pools;              //!> Watchers.
+        std::vector<PeerEndpoint> peers;                     //!> Local peers heard.
+        PeerEndpointSet seen;                                //!> Dedupes peers.
+        std::chrono::steady_clock::time_point lastAnnounced; //!> When we last announced it.
+        bool announced = false;                              //!> At least one announce went out.
+        bool requested = false;                              //!> Announce as soon as the rate limit allows.
+    };
+
+    SocketHandle sock;                    //!> Multicast socket.
+    sockaddr_in groupAddress{};           //!> Where announces go.
+    uint16_t listenPort;                  //!> Advertised peer port (0: never announce).
+    std::string cookie;                   //!> Marks our own announces.
+    mutable std::mutex mutex;             //!> Guards torrents.
+    std::map<InfoHash, Torrent> torrents; //!> Watched and heard-of hashes.
+    std::atomic<bool> stopping{false};    //!> Tells the worker to exit.
+    std::thread worker;                   //!> Receive and re-announce loop.
+
+    void run();
+    void announceDue();
+    void handleMessage(std::string_view message, const sockaddr_in &from);
+    void closeSocket();
+
+    static bool parseInfoHash(std::string_view hex, InfoHash &infoHash);
+};
+
+#endif
@@ -60,3 +60,32 @@ uint32_t MagnetMetadata::getPieceSize() const
     std::cout << "Piece size: " << pieceSize << std::endl;
     return pieceSize;
 }
+
+/*!
+    \brief Set the torrent's name and file layout.
+    \param name The torrent's name.
+    \param files Every file in piece order.
+*/
+void MagnetMetadata::setFiles(std::string name, std::vector<TorrentFile> files)
+{
+    this->name = std::move(name);
+    this->files = std::move(files);
+}
+
+/*!
+    \brief Get the length of the torrent's data.
+    \return The sum of the file lengths, or piece count times piece size if the files are not known.
+*/
+uint64_t MagnetMetadata::getTotalSize() const
+{
+    if (files.empty())
+    {
+        return static_cast<uint64_t>(pieceHashes.size()) * pieceSize;
+    }
+    uint64_t total = 0;
+    for (const TorrentFile &file : files)
+    {
+        total += file.length;
+    }
+    return total;
+}
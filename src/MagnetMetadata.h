@@ -16,6 +16,16 @@
 #include <vector>
 #include <cstdint>
 
+
+/*!
+    \brief One file of a torrent, in the order its data appears in the pieces.
+*/
+struct TorrentFile
+{
+    std::string path;    //!> Relative to the download directory, '/'-separated.
+    uint64_t length = 0; //!> Size in bytes.
+};
+
 class MagnetMetadata
 {
 public:
@@ -53,11 +63,38 @@ public:
     */
     uint32_t getPieceSize() const;
 
+    /*!
+        \brief Set the torrent's name and file layout.
+        \param name The torrent's name (the single file, or the directory of a multi-file torrent).
+        \param files Every file in piece order (empty if not known).
+    */
+    void setFiles(std::string name, std::vector<TorrentFile> files);
+
+    /*!
+        \brief Get the torrent's name.
+        \return The name (empty if not known).
+    */
+    const std::string &getName() const { return name; }
+
+    /*!
+        \brief Get the file layout.
+        \return Every file in piece order (empty if not known).
+    */
+    const std::vector<TorrentFile> &getFiles() const { return files; }
+
+    /*!
+        \brief Get the length of the torrent's data.
+        \return The sum of the file lengths, or piece count times piece size if the files are not known.
+    */
+    uint64_t getTotalSize() const;
+
 private:
     std::string infoHash;                 //!> SHA-1 hash
     std::vector<std::string> trackers;    //!> List of tracker URLs
     std::vector<std::string> pieceHashes; //!> List of piece hashes (one per piece)
     uint32_t pieceSize;                   //!> Size of each piece
+    std::string name;                     //!> Torrent name
+    std::vector<TorrentFile> files;       //!> File layout in piece order
 };
 
 #endif
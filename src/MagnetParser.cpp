@@ -15,6 +15,7 @@
 #include <stdexcept>
 #include <cstdint>
 #include <algorithm>
+#include <cctype>
 
 /*!
     \brief Creates a MagnetParser object with the given magnet link.
@@ -22,6 +23,59 @@
 */
 MagnetParser::MagnetParser(const std::string &magnetLink) : magnetLink(magnetLink) {}
 
+/*!
+    \brief Undo URL encoding ('+' and %XX escapes).
+    \param value The encoded value.
+    \return The decoded value (malformed escapes are kept as they are).
+*/
+static std::string percentDecode(const std::string &value)
+{
+    std::string decoded;
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        if (value[i] == '+')
+        {
+            decoded += ' ';
+        }
+        else if (value[i] == '%' && i + 2 < value.size() && std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+                 std::isxdigit(static_cast<unsigned char>(value[i + 2])))
+        {
+            decoded += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        }
+        else
+        {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+/*!
+    \brief Turn a display name into a single file name that is safe to create.
+    Path separators, ':' and control characters become '_', so the name can neither make
+    directories nor be rejected by TorrentStorage.
+    \param name The decoded display name.
+    \param fallback Used instead if nothing usable is left (the info hash).
+    \return The file name.
+*/
+static std::string safeFileName(const std::string &name, const std::string &fallback)
+{
+    std::string safe = name;
+    for (char &c : safe)
+    {
+        if (c == '/' || c == '\\' || c == ':' || static_cast<unsigned char>(c) < 0x20 || c == 0x7F)
+        {
+            c = '_';
+        }
+    }
+    if (safe.empty() || safe == "." || safe == "..")
+    {
+        return fallback;
+    }
+    return safe;
+}
+
 /*!
     \brief Parses the magnet link and returns the metadata.
     \return The metadata of the torrent.
@@ -32,6 +86,8 @@ MagnetMetadata MagnetParser::parse()
     std::vector<std::string> trackers;
     std::vector<std::string> pieceHashes;
     uint32_t pieceSize = 0;
+    std::string displayName;
+    uint64_t exactLength = 0;
 
     if (magnetLink.find("magnet:?") != 0)
     {
@@ -67,6 +123,14 @@ MagnetMetadata MagnetParser::parse()
         {
             pieceSize = std::stoi(value); //!> Extract piece size
         }
+        else if (key == "dn")
+        {
+            displayName = percentDecode(value); //!> Display name (BEP 9)
+        }
+        else if (key == "xl")
+        {
+            exactLength = std::stoull(value); //!> Exact length in bytes (BEP 9)
+        }
     }
 
     if (infoHash.empty())
@@ -74,5 +138,15 @@ MagnetMetadata MagnetParser::parse()
         throw std::runtime_error("Missing or invalid info hash in magnet link");
     }
 
-    return MagnetMetadata(infoHash, trackers, pieceHashes, pieceSize);
+    MagnetMetadata metadata(infoHash, trackers, pieceHashes, pieceSize);
+    std::string fileName = safeFileName(displayName, infoHash); //!> dn is free text from the link, not a path
+    if (exactLength > 0)
+    {
+        metadata.setFiles(fileName, {{fileName, exactLength}}); //!> A magnet link only describes one file
+    }
+    else
+    {
+        metadata.setFiles(fileName, {});
+    }
+    return metadata;
 }
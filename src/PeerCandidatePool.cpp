@@ -0,0 +1,190 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerCandidatePool.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 19:04:51
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PeerCandidatePool.h"
+#include "PeerQualityCache.h"
+
+/*!
+    \brief Add a peer unless it is already known.
+    \param peer The peer.
+    \param source Where it came from.
+    \return True if the peer was new.
+*/
+bool PeerCandidatePool::add(const PeerEndpoint &peer, PeerSource source)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!peer.isValid() || peer.port() == 0 || candidates.size() >= MAX_CANDIDATES || !seen.insert(peer))
+    {
+        return false;
+    }
+    if (source == PeerSource::Lsd)
+    {
+        candidates.insert(candidates.begin() + static_cast<std::ptrdiff_t>(cursor), Candidate{peer, source, false});
+    }
+    else
+    {
+        candidates.push_back(Candidate{peer, source, false});
+    }
+    return true;
+}
+
+/*!
+    \brief Add several peers.
+    \param peers The peers.
+    \param source Where they came from.
+    \return Number of new peers.
+*/
+size_t PeerCandidatePool::add(const std::vector<PeerEndpoint> &peers, PeerSource source)
+{
+    size_t added = 0;
+    for (const PeerEndpoint &peer : peers)
+    {
+        if (add(peer, source))
+        {
+            added++;
+        }
+    }
+    return added;
+}
+
+/*!
+    \brief Take the next candidate nobody has tried yet.
+    \param peer Receives the candidate.
+    \return False if every candidate has been handed out.
+*/
+bool PeerCandidatePool::next(PeerEndpoint &peer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cursor == candidates.size())
+    {
+        return false;
+    }
+    peer = candidates[cursor++].endpoint;
+    return true;
+}
+
+/*!
+    \brief Reorder the untried candidates by remembered quality, dropping known-bad peers.
+    Dropped peers stay in the seen set, so rediscovering them does not bring them back.
+    \param cache Remembered peer outcomes.
+    \return Number of candidates dropped.
+*/
+size_t PeerCandidatePool::rank(const PeerQualityCache &cache)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t first = cursor;
+    while (first < candidates.size() && candidates[first].source == PeerSource::Lsd)
+    {
+        first++;
+    }
+
+    std::vector<PeerEndpoint> untried;
+    untried.reserve(candidates.size() - first);
+    for (size_t i = first; i < candidates.size(); ++i)
+    {
+        untried.push_back(candidates[i].endpoint);
+    }
+
+    std::vector<size_t> order = cache.rankOrder(untried);
+    std::vector<Candidate> ranked;
+    ranked.reserve(order.size());
+    for (size_t index : order)
+    {
+        ranked.push_back(candidates[first + index]);
+    }
+
+    size_t dropped = untried.size() - ranked.size();
+    candidates.resize(first);
+    candidates.insert(candidates.end(), ranked.begin(), ranked.end());
+    return dropped;
+}
+
+/*!
+    \brief Record that a connection to a candidate opened or closed.
+    \param peer The peer.
+    \param connected True while a connection is up.
+*/
+void PeerCandidatePool::setConnected(const PeerEndpoint &peer, bool connected)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Candidate &candidate : candidates)
+    {
+        if (candidate.endpoint == peer)
+        {
+            candidate.connected = connected;
+            return;
+        }
+    }
+}
+
+/*!
+    \brief Get every candidate.
+    \return The peers, each listed once, in discovery order.
+*/
+std::vector<PeerEndpoint> PeerCandidatePool::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<PeerEndpoint> peers;
+    peers.reserve(candidates.size());
+    for (const Candidate &candidate : candidates)
+    {
+        peers.push_back(candidate.endpoint);
+    }
+    return peers;
+}
+
+/*!
+    \brief Get the candidates we currently hold connections to.
+    \return The connected peers.
+*/
+std::vector<PeerEndpoint> PeerCandidatePool::connectedPeers() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<PeerEndpoint> peers;
+    for (const Candidate &candidate : candidates)
+    {
+        if (candidate.connected)
+        {
+            peers.push_back(candidate.endpoint);
+        }
+    }
+    return peers;
+}
+
+/*!
+    \brief Number of candidates.
+    \return The candidate count.
+*/
+size_t PeerCandidatePool::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return candidates.size();
+}
+
+/*!
+    \brief Number of candidates learned from one source.
+    \param source The source.
+    \return The count.
+*/
+size_t PeerCandidatePool::countFrom(PeerSource source) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const Candidate &candidate : candidates)
+    {
+        if (candidate.source == source)
+        {
+            count++;
+        }
+    }
+    return count;
+}
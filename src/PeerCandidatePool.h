@@ -0,0 +1,123 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerCandidatePool.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 19:02:17
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PEER_CANDIDATE_POOL_H
+#define PEER_CANDIDATE_POOL_H
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "PeerEndpoint.h"
+
+class PeerQualityCache;
+
+/*!
+    \brief Where a candidate peer was learned from.
+*/
+enum class PeerSource : uint8_t
+{
+    Tracker,
+    Dht,
+    Pex,
+    Lsd //!> Local network: tried before every other untried candidate.
+};
+
+/*!
+    \brief Deduplicated, thread-safe list of peers to try, in the order they were learned.
+    Discovery fills it up front; peer exchange keeps adding to it while connections run.
+    Tracks which candidates are currently connected, which is what we advertise over PEX.
+*/
+class PeerCandidatePool
+{
+public:
+    static constexpr size_t MAX_CANDIDATES = 4096; //!> Candidates kept; later ones are dropped.
+
+    /*!
+        \brief Add a peer unless it is already known.
+        Local (Lsd) peers jump ahead of every candidate not yet handed out by next().
+        \param peer The peer.
+        \param source Where it came from.
+        \return True if the peer was new.
+    */
+    bool add(const PeerEndpoint &peer, PeerSource source);
+
+    /*!
+        \brief Add several peers.
+        \param peers The peers.
+        \param source Where they came from.
+        \return Number of new peers.
+    */
+    size_t add(const std::vector<PeerEndpoint> &peers, PeerSource source);
+
+    /*!
+        \brief Take the next candidate nobody has tried yet.
+        \param peer Receives the candidate.
+        \return False if every candidate has been handed out.
+    */
+    bool next(PeerEndpoint &peer);
+
+    /*!
+        \brief Reorder the candidates not yet handed out by what we remember about them,
+        dropping peers that keep failing. Local (Lsd) peers stay in front.
+        \param cache Remembered peer outcomes.
+        \return Number of candidates dropped.
+    */
+    size_t rank(const PeerQualityCache &cache);
+
+    /*!
+        \brief Record that a connection to a candidate opened or closed.
+        \param peer The peer.
+        \param connected True while a connection is up.
+    */
+    void setConnected(const PeerEndpoint &peer, bool connected);
+
+    /*!
+        \brief Get every candidate.
+        \return The peers, each listed once, in discovery order.
+    */
+    std::vector<PeerEndpoint> snapshot() const;
+
+    /*!
+        \brief Get the candidates we currently hold connections to.
+        \return The connected peers.
+    */
+    std::vector<PeerEndpoint> connectedPeers() const;
+
+    /*!
+        \brief Number of candidates.
+        \return The candidate count.
+    */
+    size_t size() const;
+
+    /*!
+        \brief Number of candidates learned from one source.
+        \param source The source.
+        \return The count.
+    */
+    size_t countFrom(PeerSource source) const;
+
+private:
+    struct Candidate
+    {
+        PeerEndpoint endpoint; //!> The peer.
+        PeerSource source;     //!> Where it came from.
+        bool connected;        //!> A connection is up.
+    };
+
+    mutable std::mutex mutex;          //!> Guards everything below.
+    PeerEndpointSet seen;              //!> Every endpoint in candidates.
+    std::vector<Candidate> candidates; //!> Discovery order.
+    size_t cursor = 0;                 //!> Next candidate for next().
+};
+
+#endif
@@ -11,12 +11,15 @@
  */
 
 #include "PeerConnection.h"
+#include "TorrentUtilities.h"
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <cstring>
 #include <vector>
 #include <chrono>
 #include <thread>
+#include <cerrno>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -25,21 +28,60 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <poll.h>
 #endif
 
+#ifndef _WIN32
+#define INVALID_SOCKET -1
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL //!> A peer resetting the connection must not raise SIGPIPE
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define EXTENSION_PROTOCOL_BIT 0x10 //!> Reserved byte 5: peer speaks BEP 10
+#define FAST_EXTENSION_BIT 0x04     //!> Reserved byte 7: peer speaks BEP 6 (reject requests)
+#define READ_TIMEOUT 10000          //!> ms to wait for the rest of a message once it has started
+
 /*!
-    \brief Creates a PeerConnection object with the given peer address and metadata.
-    \param peerAddress The IP and port of the peer.
+    \brief Creates a PeerConnection object with the given peer and metadata.
+    \param peer The peer's address and port.
     \param metadata The metadata of the torrent.
 */
-PeerConnection::PeerConnection(const std::string &peerAddress, const MagnetMetadata &metadata)
-    : peerAddress(peerAddress), infoHash(metadata.getInfoHash()), socketFd(INVALID_SOCKET) {}
+PeerConnection::PeerConnection(const PeerEndpoint &peer, const MagnetMetadata &metadata)
+    : peer(peer), infoHash(metadata.getInfoHash()), socketFd(INVALID_SOCKET), extensions(false), fast(false),
+      pieces(metadata.getPieceHashes().size()) {}
+
+/*!
+    \brief Wraps a socket that is already connected and has completed the handshake.
+    \param peer The peer's address and port.
+    \param metadata The metadata of the torrent.
+    \param socket The established, blocking socket; the connection takes ownership.
+    \param extensions Whether the peer's handshake set the extension protocol bit.
+    \param fast Whether the peer's handshake set the fast extension bit.
+*/
+PeerConnection::PeerConnection(const PeerEndpoint &peer, const MagnetMetadata &metadata, SocketHandle socket, bool extensions, bool fast)
+    : peer(peer), infoHash(metadata.getInfoHash()), socketFd(socket), extensions(extensions), fast(fast),
+      pieces(metadata.getPieceHashes().size())
+{
+    setSocketTimeout(READ_TIMEOUT / 1000);
+}
 
 /*!
     \brief Destroys the PeerConnection object.
 */
 PeerConnection::~PeerConnection()
 {
+    if (availability != nullptr)
+    {
+        availability->remove(pieces);
+    }
+    if (candidates != nullptr)
+    {
+        candidates->setConnected(peer, false);
+    }
     closeSocket();
 }
 
@@ -55,14 +97,14 @@ void PeerConnection::createSocket()
         throw std::runtime_error("Winsock initialization failed");
     }
 
-    socketFd = socket(AF_INET, SOCK_STREAM, 0);
+    socketFd = socket(peer.isV6() ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
     if (socketFd == INVALID_SOCKET)
     {
         WSACleanup();
         throw std::runtime_error("Failed to create socket");
     }
 #else
-    socketFd = socket(AF_INET, SOCK_STREAM, 0);
+    socketFd = socket(peer.isV6() ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
     if (socketFd < 0)
     {
         throw std::runtime_error("Failed to create socket");
@@ -81,11 +123,12 @@ void PeerConnection::setSocketTimeout(int timeout)
     tv.tv_usec = 0;
 
 #ifdef _WIN32
-    setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, (char *)&tv, sizeof(tv));
-    setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, (char *)&tv, sizeof(tv));
+    DWORD millis = static_cast<DWORD>(timeout) * 1000; //!> Winsock takes milliseconds, not a timeval
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, (char *)&millis, sizeof(millis));
+    setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, (char *)&millis, sizeof(millis));
 #else
-    setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &tv, sizeof(tv));
-    setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &tv, sizeof(tv));
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
 #endif
 }
 
@@ -116,36 +159,25 @@ void PeerConnection::closeSocket()
 */
 bool PeerConnection::connectToPeer()
 {
-    size_t colonPos = peerAddress.find(':');
-    if (colonPos == std::string::npos)
+    sockaddr_storage peerAddr;
+    socklen_t peerAddrLen = peer.toSockaddr(peerAddr);
+    if (peerAddrLen == 0)
     {
-        throw std::runtime_error("Invalid peer address format");
+        throw std::runtime_error("Invalid peer address");
     }
 
-    std::string ip = peerAddress.substr(0, colonPos);
-    int port = std::stoi(peerAddress.substr(colonPos + 1));
-
     createSocket();
 
-    struct sockaddr_in peerAddr;
-    peerAddr.sin_family = AF_INET;
-    peerAddr.sin_port = htons(port);
-    if (inet_pton(AF_INET, ip.c_str(), &peerAddr.sin_addr) <= 0)
-    {
-        closeSocket();
-        throw std::runtime_error("Invalid peer IP address");
-    }
-
     setSocketTimeout(10); // 10-second timeout for connection
 
 #ifdef _WIN32
-    if (connect(socketFd, (struct sockaddr *)&peerAddr, sizeof(peerAddr)) == SOCKET_ERROR)
+    if (connect(socketFd, (struct sockaddr *)&peerAddr, peerAddrLen) == SOCKET_ERROR)
     {
         closeSocket();
         throw std::runtime_error("Failed to connect to peer");
     }
 #else
-    if (connect(socketFd, (struct sockaddr *)&peerAddr, sizeof(peerAddr)) < 0)
+    if (connect(socketFd, (struct sockaddr *)&peerAddr, peerAddrLen) < 0)
     {
         closeSocket();
         throw std::runtime_error("Failed to connect to peer");
@@ -155,43 +187,75 @@ bool PeerConnection::connectToPeer()
     return true;
 }
 
+/*!
+    \brief Build our handshake.
+    \param infoHash Hex info hash of the torrent.
+    \param out Destination for HANDSHAKE_SIZE bytes.
+*/
+void PeerConnection::encodeHandshake(const std::string &infoHash, char *out)
+{
+    std::array<uint8_t, 20> infoHashBytes = TorrentUtilities::infoHashToBytes(infoHash);
+
+    std::memset(out, 0, HANDSHAKE_SIZE);
+    out[0] = 19;                                                       //!> Protocol length - 19 for bittorrent protocol
+    std::memcpy(out + 1, "BitTorrent protocol", 19);                   //!> Protocol string
+    out[25] = EXTENSION_PROTOCOL_BIT;                                  //!> Reserved bytes (20-27)
+    out[27] = FAST_EXTENSION_BIT;                                      //!> So peers reject requests instead of dropping them
+    std::memcpy(out + 28, infoHashBytes.data(), 20);                   //!> Info hash
+    std::memcpy(out + 48, TorrentUtilities::localPeerId().data(), 20); //!> Peer ID
+}
+
+/*!
+    \brief Validate a peer's handshake.
+    \param infoHash Hex info hash we expect.
+    \param response HANDSHAKE_SIZE bytes from the peer.
+    \param extensions Receives whether the peer supports the extension protocol.
+    \param fast Receives whether the peer supports the fast extension.
+    \return False if the protocol string or info hash does not match.
+*/
+bool PeerConnection::checkHandshake(const std::string &infoHash, const char *response, bool &extensions, bool &fast)
+{
+    std::array<uint8_t, 20> infoHashBytes = TorrentUtilities::infoHashToBytes(infoHash);
+    if (response[0] != 19 || std::memcmp(response + 1, "BitTorrent protocol", 19) != 0 ||
+        std::memcmp(response + 28, infoHashBytes.data(), 20) != 0)
+    {
+        return false;
+    }
+    extensions = (response[25] & EXTENSION_PROTOCOL_BIT) != 0;
+    fast = (response[27] & FAST_EXTENSION_BIT) != 0;
+    return true;
+}
+
 /*!
     \brief Perform the torrent protocol handshake with the peer.
     \throws std::runtime_error if handshake fails.
 */
 void PeerConnection::performHandshake()
 {
-    char handshake[68] = {0};
-    handshake[0] = 19;                                     //!> Protocol length - 19 for bittorrent protocol
-    std::memcpy(handshake + 1, "BitTorrent protocol", 19); //!> Protocol string
-    std::memcpy(handshake + 28, infoHash.c_str(), 20);     //!> Info hash
-    std::memcpy(handshake + 48, "\0\0\0\0\0\0\0\0", 8);    //!> Reserved bytes
+    char handshake[HANDSHAKE_SIZE];
+    encodeHandshake(infoHash, handshake);
 
 #ifdef _WIN32
-    if (send(socketFd, handshake, sizeof(handshake), 0) == SOCKET_ERROR)
+    if (send(socketFd, handshake, sizeof(handshake), SEND_FLAGS) == SOCKET_ERROR)
     {
         throw std::runtime_error("Failed to send handshake");
     }
-
-    char response[68];
-    if (recv(socketFd, response, sizeof(response), 0) == SOCKET_ERROR)
-    {
-        throw std::runtime_error("Failed to receive handshake");
-    }
 #else
-    if (send(socketFd, handshake, sizeof(handshake), 0) < 0)
+    if (send(socketFd, handshake, sizeof(handshake), SEND_FLAGS) < 0)
     {
         throw std::runtime_error("Failed to send handshake");
     }
+#endif
 
-    char response[68];
-    if (recv(socketFd, response, sizeof(response), 0) < 0)
+    char response[HANDSHAKE_SIZE];
+    receiveExact(response, sizeof(response));
+    if (!checkHandshake(infoHash, response, extensions, fast))
     {
-        throw std::runtime_error("Failed to receive handshake");
+        throw std::runtime_error("Peer sent an invalid handshake");
     }
-#endif
 
     std::cout << "Handshake successful with peer!" << std::endl;
+    announcePieces();
 }
 
 /*!
@@ -202,68 +266,501 @@ void PeerConnection::performHandshake()
 */
 void PeerConnection::sendRequest(uint32_t pieceIndex, uint32_t blockOffset, uint32_t blockLength)
 {
-    char request[13] = {0};
-    request[0] = 6; //!> Length of the message
-    request[1] = 0; //!> Request message type (for the piece request)
+    char request[12];
+    PeerWireFramer::writeU32(request, pieceIndex);      //!> Piece index
+    PeerWireFramer::writeU32(request + 4, blockOffset); //!> Block offset
+    PeerWireFramer::writeU32(request + 8, blockLength); //!> Block length
+    sendMessage(static_cast<uint8_t>(PeerMessageId::Request), std::string_view(request, sizeof(request)));
+}
 
-    //* Fill in the rest with piece information
-    request[4] = pieceIndex;   //!> Piece index
-    request[8] = blockOffset;  //!> Block offset
-    request[12] = blockLength; //!> Block length
+/*!
+    \brief Withdraw a request.
+    \param pieceIndex The index of the piece.
+    \param blockOffset The offset of the block within the piece.
+    \param blockLength The length of the block.
+*/
+void PeerConnection::sendCancel(uint32_t pieceIndex, uint32_t blockOffset, uint32_t blockLength)
+{
+    char cancel[12];
+    PeerWireFramer::writeU32(cancel, pieceIndex);
+    PeerWireFramer::writeU32(cancel + 4, blockOffset);
+    PeerWireFramer::writeU32(cancel + 8, blockLength);
+    sendMessage(static_cast<uint8_t>(PeerMessageId::Cancel), std::string_view(cancel, sizeof(cancel)));
+}
 
-#ifdef _WIN32
-    if (send(socketFd, request, sizeof(request), 0) == SOCKET_ERROR)
+/*!
+    \brief Receive the next block the peer sends, ignoring other messages.
+    \return The block data (empty if nothing arrived within READ_TIMEOUT).
+*/
+std::vector<char> PeerConnection::receiveData()
+{
+    struct BlockReceiver : PeerWireHandler
     {
-        throw std::runtime_error("Failed to send request");
+        std::vector<char> data;
+        bool done = false;
+
+        char *blockBuffer(uint32_t, uint32_t, uint32_t length) override
+        {
+            data.resize(length);
+            return data.data();
+        }
+        void onPiece(uint32_t, uint32_t, uint32_t, bool) override { done = true; }
+    };
+
+    BlockReceiver receiver;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READ_TIMEOUT);
+    while (!receiver.done)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (!receive(receiver, remaining))
+        {
+            abandonBlock(); //!> receiver.data is about to go away
+            return std::vector<char>();
+        }
     }
-#else
-    if (send(socketFd, request, sizeof(request), 0) < 0)
+
+    std::cout << "Received " << receiver.data.size() << " bytes of torrent data." << std::endl;
+    return std::move(receiver.data);
+}
+
+/*!
+    \brief Stop receiving a block into the buffer blockBuffer() gave for it.
+    \param block The block.
+    \return True if it was arriving.
+*/
+bool PeerConnection::abandonBlock(const BlockRequest &block)
+{
+    if (!framer.receivingBlock(block.piece, block.begin))
     {
-        throw std::runtime_error("Failed to send request");
+        return false;
     }
+    framer.discardBlock();
+    return true;
+}
+
+/*!
+    \brief Stop receiving whatever block is arriving into a handler's buffer.
+    \return True if one was.
+*/
+bool PeerConnection::abandonBlock()
+{
+    bool receiving = framer.receivingBlock();
+    framer.discardBlock();
+    return receiving;
+}
+
+/*!
+    \brief Wait until the socket has data.
+    \param timeout Longest wait.
+    \return True if data (or a close) is waiting.
+*/
+bool PeerConnection::waitReadable(std::chrono::milliseconds timeout)
+{
+    int waitMs = static_cast<int>(std::max<int64_t>(0, timeout.count()));
+#ifdef _WIN32
+    WSAPOLLFD entry{};
+    entry.fd = socketFd;
+    entry.events = POLLRDNORM;
+    return WSAPoll(&entry, 1, waitMs) > 0;
+#else
+    pollfd entry{};
+    entry.fd = socketFd;
+    entry.events = POLLIN;
+    return poll(&entry, 1, waitMs) > 0;
 #endif
 }
 
 /*!
-    \brief Receive data from the peer (torrent pieces).
-    \return A vector of received data.
+    \brief Read exactly `length` bytes.
+    \param buffer Destination.
+    \param length Bytes to read.
+    \throws std::runtime_error on close, error or a stall longer than READ_TIMEOUT.
 */
-std::vector<char> PeerConnection::receiveData()
+void PeerConnection::receiveExact(char *buffer, size_t length)
 {
-    std::vector<char> data;
-    char buffer[16384];
-    ssize_t bytesReceived;
+    size_t received = 0;
+    while (received < length)
+    {
+        if (!waitReadable(std::chrono::milliseconds(READ_TIMEOUT)))
+        {
+            throw std::runtime_error("Timed out receiving from peer");
+        }
+        int result = recv(socketFd, buffer + received, static_cast<int>(length - received), 0);
+        if (result <= 0)
+        {
+            throw std::runtime_error("Peer closed the connection");
+        }
+        received += static_cast<size_t>(result);
+    }
+}
 
-    while (true)
+/*!
+    \brief Send one length-prefixed peer wire message.
+    \param id The message ID.
+    \param payload The bytes after the ID.
+    \throws std::runtime_error if the send fails.
+*/
+void PeerConnection::sendMessage(uint8_t id, std::string_view payload)
+{
+    uint32_t length = static_cast<uint32_t>(payload.size() + 1);
+    std::string message(5, '\0');
+    message[0] = static_cast<char>(length >> 24);
+    message[1] = static_cast<char>(length >> 16);
+    message[2] = static_cast<char>(length >> 8);
+    message[3] = static_cast<char>(length);
+    message[4] = static_cast<char>(id);
+    message.append(payload);
+
+    if (deferSends)
     {
-#ifdef _WIN32
-        bytesReceived = recv(socketFd, buffer, sizeof(buffer), 0);
-        if (bytesReceived == SOCKET_ERROR)
+        outbox.append(message);
+        flushSends();
+        return;
+    }
+
+    size_t sent = 0;
+    while (sent < message.size())
+    {
+        int result = send(socketFd, message.data() + sent, static_cast<int>(message.size() - sent), SEND_FLAGS);
+        if (result <= 0)
         {
-            throw std::runtime_error("Failed to receive data");
+            throw std::runtime_error("Failed to send message");
         }
-#else
-        bytesReceived = recv(socketFd, buffer, sizeof(buffer), 0);
-        if (bytesReceived < 0)
+        sent += static_cast<size_t>(result);
+    }
+}
+
+/*!
+    \brief Queue outgoing messages instead of blocking when the socket's send buffer is full.
+    \param deferred Whether to queue.
+    \throws std::runtime_error if switching back and the queued bytes cannot be sent.
+*/
+void PeerConnection::setDeferredSends(bool deferred)
+{
+    deferSends = deferred;
+    size_t sent = 0;
+    while (!deferred && sent < outbox.size())
+    {
+        int result = send(socketFd, outbox.data() + sent, static_cast<int>(outbox.size() - sent), SEND_FLAGS);
+        if (result <= 0)
+        {
+            throw std::runtime_error("Failed to send message");
+        }
+        sent += static_cast<size_t>(result);
+    }
+    outbox.erase(0, sent);
+}
+
+/*!
+    \brief Send as much of the queue as the socket takes without blocking.
+    \return True once the queue is empty.
+    \throws std::runtime_error if the send fails.
+*/
+bool PeerConnection::flushSends()
+{
+    size_t sent = 0;
+    while (sent < outbox.size())
+    {
+        size_t result = sendAvailable(outbox.data() + sent, outbox.size() - sent);
+        if (result == 0)
         {
-            throw std::runtime_error("Failed to receive data");
+            break;
         }
+        sent += result;
+    }
+    outbox.erase(0, sent);
+    return outbox.empty();
+}
+
+/*!
+    \brief Send without blocking.
+    \param data The bytes.
+    \param length Number of bytes.
+    \return Bytes the socket took (0 if its send buffer is full).
+    \throws std::runtime_error if the send fails.
+*/
+size_t PeerConnection::sendAvailable(const char *data, size_t length)
+{
+#ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(socketFd, FIONBIO, &mode);
+    int result = send(socketFd, data, static_cast<int>(length), SEND_FLAGS);
+    bool full = result == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK;
+    mode = 0;
+    ioctlsocket(socketFd, FIONBIO, &mode);
+#else
+    ssize_t result;
+    do
+    {
+        result = send(socketFd, data, length, SEND_FLAGS | MSG_DONTWAIT);
+    } while (result < 0 && errno == EINTR);
+    bool full = result < 0 && (errno == EWOULDBLOCK || errno == EAGAIN);
 #endif
+    if (full)
+    {
+        return 0;
+    }
+    if (result <= 0)
+    {
+        throw std::runtime_error("Failed to send message");
+    }
+    return static_cast<size_t>(result);
+}
 
-        if (bytesReceived > 0)
+/*!
+    \brief Deliver the next peer wire message to a handler, reading from the socket as needed.
+    \param handler Receives the message.
+    \param timeout How long to wait for the message to complete.
+    \return False if no complete message arrived in time.
+*/
+bool PeerConnection::receive(PeerWireHandler &handler, std::chrono::milliseconds timeout)
+{
+    struct StateTracker : PeerWireHandler
+    {
+        PeerConnection &session;
+        PeerWireHandler &next;
+
+        StateTracker(PeerConnection &session, PeerWireHandler &next) : session(session), next(next) {}
+
+        void onMessage(uint8_t id, std::string_view payload) override
         {
-            data.insert(data.end(), buffer, buffer + bytesReceived);
-            if (bytesReceived < static_cast<ssize_t>(sizeof(buffer)))
-            {
-                break;
-            }
+            session.track(id, payload);
+            next.onMessage(id, payload);
+        }
+        char *blockBuffer(uint32_t piece, uint32_t begin, uint32_t length) override { return next.blockBuffer(piece, begin, length); }
+        void onPiece(uint32_t piece, uint32_t begin, uint32_t length, bool stored) override { next.onPiece(piece, begin, length, stored); }
+        void onKeepAlive() override { next.onKeepAlive(); }
+    };
+
+    StateTracker tracker(*this, handler);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!framer.dispatch(tracker))
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (!waitReadable(remaining))
+        {
+            return false;
+        }
+        if (!framer.fill(socketFd))
+        {
+            throw std::runtime_error("Peer closed the connection");
         }
-        else
+    }
+    return true;
+}
+
+/*!
+    \brief Mark this peer connected in a candidate pool and trade peer lists with it.
+    \param pool The pool (must outlive the connection).
+*/
+void PeerConnection::setPeerExchange(PeerCandidatePool &pool)
+{
+    if (candidates != nullptr)
+    {
+        return;
+    }
+    candidates = &pool;
+    pool.setConnected(peer, true);
+    if (extensions)
+    {
+        char buffer[PeerExchange::MAX_MESSAGE];
+        sendMessage(PeerExchange::EXTENDED_MESSAGE, std::string_view(buffer, PeerExchange::encodeHandshake(buffer)));
+    }
+}
+
+/*!
+    \brief Send our PEX message if PeerExchange::INTERVAL has passed since the last one.
+*/
+void PeerConnection::sharePeers()
+{
+    auto now = PeerExchange::Clock::now();
+    if (candidates == nullptr || !exchange.isDue(now))
+    {
+        return;
+    }
+    std::vector<PeerEndpoint> connected = candidates->connectedPeers();
+    connected.erase(std::remove(connected.begin(), connected.end(), peer), connected.end()); //!> Not the peer itself
+    char buffer[PeerExchange::MAX_MESSAGE];
+    size_t length = exchange.buildMessage(connected, buffer, now);
+    if (length > 0)
+    {
+        sendMessage(PeerExchange::EXTENDED_MESSAGE, std::string_view(buffer, length));
+    }
+}
+
+/*!
+    \brief Do nothing but swap peer lists with the peer (ut_pex) for a while.
+    \param pool Candidate pool to read our connected set from and feed with new peers.
+    \param duration How long to keep exchanging.
+    \return Number of new candidates learned.
+*/
+size_t PeerConnection::exchangePeers(PeerCandidatePool &pool, std::chrono::milliseconds duration)
+{
+    if (!extensions)
+    {
+        return 0;
+    }
+    setPeerExchange(pool);
+
+    size_t before = learned;
+    PeerWireHandler ignore;
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    while (true)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
         {
             break;
         }
+        sharePeers();
+
+        //* Wake in time for the next PEX tick or the end of the window, whichever is first
+        auto wait = std::min<std::chrono::steady_clock::duration>(deadline - now, PeerExchange::INTERVAL);
+        receive(ignore, std::chrono::duration_cast<std::chrono::milliseconds>(wait)); //!> PEX messages are handled by track()
+    }
+    return learned - before;
+}
+
+/*!
+    \brief Update the session state from a received message.
+    \param id The message ID.
+    \param payload The bytes after the ID.
+    \throws std::runtime_error if the peer sends a bitfield of the wrong size.
+*/
+void PeerConnection::track(uint8_t id, std::string_view payload)
+{
+    switch (static_cast<PeerMessageId>(id))
+    {
+    case PeerMessageId::Choke:
+        wireState.peerChoking = true;
+        break;
+    case PeerMessageId::Unchoke:
+        wireState.peerChoking = false;
+        break;
+    case PeerMessageId::Interested:
+        wireState.peerInterested = true;
+        break;
+    case PeerMessageId::NotInterested:
+        wireState.peerInterested = false;
+        break;
+    case PeerMessageId::Have:
+        if (payload.size() == 4 && pieces.set(PeerWireFramer::readU32(payload.data())) && availability != nullptr)
+        {
+            availability->add(PeerWireFramer::readU32(payload.data()));
+        }
+        break;
+    case PeerMessageId::Bitfield:
+    {
+        PieceBitfield updated(pieces.size());
+        if (!updated.assign(payload))
+        {
+            throw std::runtime_error("Peer sent a bitfield of the wrong size");
+        }
+        replacePieces(updated);
+        break;
+    }
+    case PeerMessageId::HaveAll:
+    {
+        PieceBitfield updated(pieces.size());
+        updated.setAll();
+        replacePieces(updated);
+        break;
+    }
+    case PeerMessageId::HaveNone:
+        replacePieces(PieceBitfield(pieces.size()));
+        break;
+    case PeerMessageId::Extended:
+        if (candidates != nullptr)
+        {
+            std::vector<PeerEndpoint> added;
+            std::vector<PeerEndpoint> dropped;
+            if (exchange.onMessage(payload, added, dropped))
+            {
+                learned += candidates->add(added, PeerSource::Pex);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+    \brief Swap in a new set of peer pieces, moving the shared counts with it.
+    \param updated The peer's pieces.
+*/
+void PeerConnection::replacePieces(const PieceBitfield &updated)
+{
+    if (availability != nullptr)
+    {
+        availability->remove(pieces);
+        availability->add(updated);
+    }
+    pieces = updated;
+}
+
+/*!
+    \brief Count this peer's pieces in a shared availability table, now and as they change.
+    \param shared The table (must outlive the connection), or nullptr.
+*/
+void PeerConnection::setAvailability(PieceAvailability *shared)
+{
+    if (availability != nullptr)
+    {
+        availability->remove(pieces);
+    }
+    availability = shared;
+    if (availability != nullptr)
+    {
+        availability->add(pieces);
     }
+}
 
-    std::cout << "Received " << data.size() << " bytes of torrent data." << std::endl;
-    return data;
+/*!
+    \brief Tell the peer which pieces we have (have none with the fast extension, otherwise nothing).
+*/
+void PeerConnection::announcePieces()
+{
+    if (fast)
+    {
+        sendMessage(static_cast<uint8_t>(PeerMessageId::HaveNone), std::string_view());
+    }
+}
+
+/*!
+    \brief Send interested or not interested if it changes our state.
+    \param interested Whether we want the peer's pieces.
+*/
+void PeerConnection::setInterested(bool interested)
+{
+    if (wireState.amInterested != interested)
+    {
+        sendMessage(static_cast<uint8_t>(interested ? PeerMessageId::Interested : PeerMessageId::NotInterested), std::string_view());
+        wireState.amInterested = interested;
+    }
+}
+
+/*!
+    \brief Process whatever the peer has sent without blocking.
+    \return Number of messages processed.
+*/
+size_t PeerConnection::drain()
+{
+    PeerWireHandler ignore;
+    return drain(ignore);
+}
+
+/*!
+    \brief Deliver every message the peer has sent to a handler without blocking.
+    \param handler Receives the messages.
+    \return Number of messages processed.
+*/
+size_t PeerConnection::drain(PeerWireHandler &handler)
+{
+    size_t processed = 0;
+    while (receive(handler, std::chrono::milliseconds(0)))
+    {
+        processed++;
+    }
+    return processed;
 }
@@ -22,34 +22,272 @@
 #endif
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <chrono>
 #include <cstdint>
 #include "MagnetMetadata.h"
+#include "PeerEndpoint.h"
+#include "PeerCandidatePool.h"
+#include "PeerWireFramer.h"
+#include "RequestPipeline.h"
+#include "PieceAvailability.h"
+#include "PeerExchange.h"
 
+/*!
+    \brief Choke and interest flags for both directions of a peer connection (BEP 3).
+    Every connection starts choked and not interested on both sides.
+*/
+struct PeerWireState
+{
+    bool amChoking = true;       //!> We are not serving the peer.
+    bool amInterested = false;   //!> We told the peer we want its pieces.
+    bool peerChoking = true;     //!> The peer will not serve our requests.
+    bool peerInterested = false; //!> The peer wants our pieces.
+};
+
+/*!
+    \brief One peer wire session: the socket, its framing, the requests in flight, and the
+    choke, interest and piece state both sides have announced. Sessions are long-lived; the
+    connection manager pools them and every piece download borrows one.
+*/
 class PeerConnection
 {
 public:
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+#else
+    using SocketHandle = int;
+#endif
+
+    /*!
+        \brief Creates a PeerConnection object with the given peer and metadata.
+        \param peer The peer's address and port.
+        \param metadata The metadata of the torrent.
+    */
+    explicit PeerConnection(const PeerEndpoint &peer, const MagnetMetadata &metadata);
+
     /*!
-        \brief Creates a PeerConnection object with the given peer address and metadata.
-        \param peerAddress The IP and port of the peer.
+        \brief Wraps a socket that is already connected and has completed the handshake.
+        \param peer The peer's address and port.
         \param metadata The metadata of the torrent.
+        \param socket The established, blocking socket; the connection takes ownership.
+        \param extensions Whether the peer's handshake set the extension protocol bit.
+        \param fast Whether the peer's handshake set the fast extension bit.
     */
-    explicit PeerConnection(const std::string &peerAddress, const MagnetMetadata &metadata);
+    PeerConnection(const PeerEndpoint &peer, const MagnetMetadata &metadata, SocketHandle socket, bool extensions, bool fast);
     ~PeerConnection();
 
+    PeerConnection(const PeerConnection &) = delete;
+    PeerConnection &operator=(const PeerConnection &) = delete;
+
+    static constexpr size_t HANDSHAKE_SIZE = 68; //!> pstrlen, pstr, reserved, info hash, peer ID.
+
+    /*!
+        \brief Build our handshake.
+        \param infoHash Hex info hash of the torrent.
+        \param out Destination for HANDSHAKE_SIZE bytes.
+    */
+    static void encodeHandshake(const std::string &infoHash, char *out);
+
+    /*!
+        \brief Validate a peer's handshake.
+        \param infoHash Hex info hash we expect.
+        \param response HANDSHAKE_SIZE bytes from the peer.
+        \param extensions Receives whether the peer supports the extension protocol.
+        \param fast Receives whether the peer supports the fast extension.
+        \return False if the protocol string or info hash does not match.
+    */
+    static bool checkHandshake(const std::string &infoHash, const char *response, bool &extensions, bool &fast);
+
+    /*!
+        \brief The block requests outstanding on this connection.
+        \return The pipeline (kept with the connection, so its measurements survive reuse).
+    */
+    RequestPipeline &requests() { return pipeline; }
+
+    /*!
+        \brief Choke and interest state on both sides.
+        \return The flags as of the last message received or sent.
+    */
+    const PeerWireState &state() const { return wireState; }
+
+    /*!
+        \brief The pieces the peer has announced (bitfield, have, have all).
+        \return The peer's pieces.
+    */
+    const PieceBitfield &peerPieces() const { return pieces; }
+
+    /*!
+        \brief Count this peer's pieces in a shared availability table, now and as they change.
+        The peer's pieces are taken back out when the connection closes.
+        \param shared The table (must outlive the connection), or nullptr.
+    */
+    void setAvailability(PieceAvailability *shared);
+
+    /*!
+        \brief Tell the peer which pieces we have, as the protocol requires right after the handshake.
+        We have none to offer, so this is have none when both sides speak the fast extension and
+        nothing otherwise (an empty bitfield may be omitted).
+    */
+    void announcePieces();
+
+    /*!
+        \brief Send interested or not interested if it changes our state.
+        \param interested Whether we want the peer's pieces.
+    */
+    void setInterested(bool interested);
+
+    /*!
+        \brief Process whatever the peer has sent without blocking, keeping the state current
+        while the session sits idle. Piece data that arrives here is discarded.
+        \return Number of messages processed.
+        \throws std::runtime_error if the connection fails.
+    */
+    size_t drain();
+
+    /*!
+        \brief Deliver every message the peer has sent to a handler without blocking.
+        For event loops: call it whenever the socket polls readable.
+        \param handler Receives the messages (see receive()).
+        \return Number of messages processed.
+        \throws std::runtime_error if the connection fails.
+    */
+    size_t drain(PeerWireHandler &handler);
+
+    /*!
+        \brief Stop receiving a block into the buffer blockBuffer() gave for it.
+        Call before the buffer is freed or the block is handed to another peer; the rest of its
+        data is skipped.
+        \param block The block.
+        \return True if it was arriving.
+    */
+    bool abandonBlock(const BlockRequest &block);
+
+    /*!
+        \brief Stop receiving whatever block is arriving into a handler's buffer.
+        \return True if one was.
+    */
+    bool abandonBlock();
+
+    /*!
+        \brief Check whether piece data is being written into a handler's buffer.
+        A session in this state must not be handed to another borrower.
+        \return True mid-block.
+    */
+    bool isReceivingBlock() const { return framer.receivingBlock(); }
+
+    /*!
+        \brief The connection's socket, for registering with a poller.
+        \return The socket (reads must still go through receive() or drain()).
+    */
+    SocketHandle socketHandle() const { return socketFd; }
+
+    /*!
+        \brief Get the peer this connection talks to.
+        \return The endpoint.
+    */
+    const PeerEndpoint &endpoint() const { return peer; }
+
     bool connectToPeer();                                                              //!> Initiates the connection to the peer.
     void performHandshake();                                                           //!> Perform the torrent protocol handshake with the peer.
     void sendRequest(uint32_t pieceIndex, uint32_t blockOffset, uint32_t blockLength); //!> Request data (torrent pieces) from the peer.
-    std::vector<char> receiveData();                                                   //!> Receive data from the peer (torrent pieces).
+    void sendCancel(uint32_t pieceIndex, uint32_t blockOffset, uint32_t blockLength);  //!> Withdraw a request.
+    std::vector<char> receiveData();                                                   //!> Receive the next block the peer sends (empty on timeout).
+
+    /*!
+        \brief Check whether the peer set the extension protocol bit (BEP 10) in its handshake.
+        \return True if extended messages may be sent.
+    */
+    bool supportsExtensions() const { return extensions; }
+
+    /*!
+        \brief Send one length-prefixed peer wire message.
+        \param id The message ID.
+        \param payload The bytes after the ID.
+        \throws std::runtime_error if the send fails.
+    */
+    void sendMessage(uint8_t id, std::string_view payload);
+
+    /*!
+        \brief Queue outgoing messages instead of blocking when the socket's send buffer is full.
+        A deferring owner must call flushSends() when the socket becomes writable. Switching back
+        sends whatever is still queued, blocking as usual.
+        \param deferred Whether to queue.
+        \throws std::runtime_error if switching back and the queued bytes cannot be sent.
+    */
+    void setDeferredSends(bool deferred);
+
+    /*!
+        \brief Send as much of the queue as the socket takes without blocking.
+        \return True once the queue is empty.
+        \throws std::runtime_error if the send fails.
+    */
+    bool flushSends();
+
+    size_t queuedSendBytes() const { return outbox.size(); } //!> Bytes waiting for flushSends().
+
+    /*!
+        \brief Deliver the next peer wire message to a handler, reading from the socket as needed.
+        The session's own state is updated before the handler sees the message.
+        Piece data is read straight into the handler's blockBuffer().
+        \param handler Receives the message.
+        \param timeout How long to wait for the message to complete.
+        \return False if no complete message arrived in time.
+        \throws std::runtime_error if the peer disconnects or sends a malformed frame.
+    */
+    bool receive(PeerWireHandler &handler, std::chrono::milliseconds timeout);
+
+    /*!
+        \brief Mark this peer connected in a candidate pool and trade peer lists with it (ut_pex)
+        for as long as the session lives. Sends our extension handshake if the peer speaks BEP 10;
+        from then on every peer it advertises is added to the pool, whoever is receiving, and
+        sharePeers() advertises the pool's connected set. The peer is marked disconnected when
+        the connection closes.
+        \param pool The pool (must outlive the connection).
+        \throws std::runtime_error if the handshake cannot be sent.
+    */
+    void setPeerExchange(PeerCandidatePool &pool);
+
+    /*!
+        \brief Send our PEX message if PeerExchange::INTERVAL has passed since the last one.
+        Call regularly while the session is in use.
+        \throws std::runtime_error if the send fails.
+    */
+    void sharePeers();
+
+    /*!
+        \brief Do nothing but swap peer lists with the peer (ut_pex) for a while.
+        \param pool Candidate pool to read our connected set from and feed with new peers.
+        \param duration How long to keep exchanging.
+        \return Number of new candidates learned.
+    */
+    size_t exchangePeers(PeerCandidatePool &pool, std::chrono::milliseconds duration);
 
 private:
-    std::string peerAddress; //!> Peer IP and port.
-    std::string infoHash;    //!> Info hash of the torrent (for handshake).
-    SOCKET socketFd;         //!> Socket descriptor for the peer connection.
-    
+    PeerEndpoint peer;                         //!> Peer IP and port.
+    std::string infoHash;                      //!> Info hash of the torrent (for handshake).
+    SocketHandle socketFd;                     //!> Socket descriptor for the peer connection.
+    bool extensions;                           //!> Peer supports the extension protocol.
+    bool fast;                                 //!> Peer supports the fast extension.
+    PeerWireFramer framer;                     //!> Splits received bytes into messages.
+    RequestPipeline pipeline;                  //!> Outstanding block requests.
+    PeerWireState wireState;                   //!> Choke and interest flags.
+    PieceBitfield pieces;                      //!> Pieces the peer has.
+    PieceAvailability *availability = nullptr; //!> Shared counts fed with pieces, if any.
+    PeerExchange exchange;                     //!> ut_pex state for this connection.
+    PeerCandidatePool *candidates = nullptr;   //!> Pool we are marked connected in and trade peers with, if any.
+    size_t learned = 0;                        //!> New candidates this peer has advertised.
+    std::string outbox;                        //!> Messages the socket has not taken yet (deferred sends).
+    bool deferSends = false;                   //!> Queue sends rather than block on a full socket.
 
     void createSocket();
     void setSocketTimeout(int timeout);
+    bool waitReadable(std::chrono::milliseconds timeout);
+    void receiveExact(char *buffer, size_t length);
+    size_t sendAvailable(const char *data, size_t length);
+    void track(uint8_t id, std::string_view payload);
+    void replacePieces(const PieceBitfield &updated);
     //!> Create a socket for the peer connection.
     void closeSocket();  //!> Close the socket for the peer connection.
 };
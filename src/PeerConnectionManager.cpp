@@ -0,0 +1,505 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerConnectionManager.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 21:07:40
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PeerConnectionManager.h"
+#include "PeerQualityCache.h"
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#include <sys/socket.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#ifndef _WIN32
+#define INVALID_SOCKET -1
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL //!> A peer resetting the connection must not raise SIGPIPE
+#else
+#define SEND_FLAGS 0
+#endif
+
+/*!
+    \brief Switch a socket between blocking and non-blocking mode.
+    \param socket The socket.
+    \param nonBlocking True for non-blocking.
+*/
+static void setNonBlocking(PeerConnection::SocketHandle socket, bool nonBlocking)
+{
+#ifdef _WIN32
+    u_long mode = nonBlocking ? 1 : 0;
+    ioctlsocket(socket, FIONBIO, &mode);
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    fcntl(socket, F_SETFL, nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+#endif
+}
+
+/*!
+    \brief Check whether the last socket call would have blocked.
+    \return True for EWOULDBLOCK/EAGAIN (or the Winsock equivalent).
+*/
+static bool wouldBlock()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR;
+#endif
+}
+
+/*!
+    \brief Milliseconds elapsed since a time point.
+    \param since The start.
+    \return The elapsed time.
+*/
+static std::chrono::milliseconds elapsedSince(PeerConnectionManager::Clock::time_point since)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(PeerConnectionManager::Clock::now() - since);
+}
+
+/*!
+    \brief Creates an empty manager for one torrent.
+    \param metadata The torrent (its info hash goes into every handshake).
+*/
+PeerConnectionManager::PeerConnectionManager(const MagnetMetadata &metadata)
+    : metadata(metadata), availability(metadata.getPieceHashes().size())
+{
+#ifdef __linux__
+    pollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (pollFd < 0)
+    {
+        throw std::runtime_error("Failed to create epoll instance");
+    }
+#endif
+}
+
+/*!
+    \brief Closes every pooled session.
+*/
+PeerConnectionManager::~PeerConnectionManager()
+{
+#ifdef __linux__
+    if (pollFd >= 0)
+    {
+        close(pollFd);
+    }
+#endif
+}
+
+/*!
+    \brief Close a socket we created (each holds its own Winsock reference).
+    \param socket The socket.
+*/
+void PeerConnectionManager::closeHandle(PeerConnection::SocketHandle socket)
+{
+#ifdef _WIN32
+    closesocket(socket);
+    WSACleanup();
+#else
+    close(socket);
+#endif
+}
+
+/*!
+    \brief Create a non-blocking socket and start connecting it.
+    \param peer The peer.
+    \param pending Receives the in-flight connect.
+    \return False if the connect failed immediately (already recorded).
+*/
+bool PeerConnectionManager::startConnect(const PeerEndpoint &peer, HalfOpen &pending)
+{
+    sockaddr_storage address;
+    socklen_t addressLength = peer.toSockaddr(address);
+    if (addressLength == 0)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        return false;
+    }
+#endif
+    PeerConnection::SocketHandle socket = ::socket(peer.isV6() ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
+    if (socket == INVALID_SOCKET)
+    {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    setNonBlocking(socket, true);
+
+    pending.peer = peer;
+    pending.socket = socket;
+    pending.stage = Stage::Connecting;
+    pending.started = Clock::now();
+    pending.deadline = pending.started + CONNECT_TIMEOUT;
+    pending.transferred = 0;
+
+    if (::connect(socket, reinterpret_cast<sockaddr *>(&address), addressLength) != 0)
+    {
+#ifdef _WIN32
+        bool inProgress = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        bool inProgress = errno == EINPROGRESS;
+#endif
+        if (!inProgress)
+        {
+            fail(pending);
+            return false;
+        }
+    }
+    return true; //!> Writable once connected (immediately if it already is)
+}
+
+/*!
+    \brief Register a socket with the poller for the events its stage waits on.
+    \param pending The in-flight connect.
+    \param add True for a new socket, false to update one already registered.
+*/
+void PeerConnectionManager::watch(const HalfOpen &pending, bool add)
+{
+#ifdef __linux__
+    epoll_event event{};
+    event.events = pending.stage == Stage::Receiving ? EPOLLIN : EPOLLOUT;
+    event.data.fd = pending.socket;
+    epoll_ctl(pollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, pending.socket, &event);
+#else
+    (void)pending;
+    (void)add;
+#endif
+}
+
+/*!
+    \brief Remove a socket from the poller.
+    \param pending The in-flight connect.
+*/
+void PeerConnectionManager::unwatch(const HalfOpen &pending)
+{
+#ifdef __linux__
+    epoll_ctl(pollFd, EPOLL_CTL_DEL, pending.socket, nullptr);
+#else
+    (void)pending;
+#endif
+}
+
+/*!
+    \brief Give up on a connect or handshake, recording which one failed.
+    \param pending The in-flight connect.
+*/
+void PeerConnectionManager::fail(HalfOpen &pending)
+{
+    if (pending.stage == Stage::Connecting)
+    {
+        PeerQualityCache::shared().recordConnect(pending.peer, false, elapsedSince(pending.started));
+    }
+    else
+    {
+        PeerQualityCache::shared().recordHandshake(pending.peer, false);
+    }
+    unwatch(pending);
+    closeHandle(pending.socket);
+    pending.socket = INVALID_SOCKET;
+}
+
+/*!
+    \brief Move a connect forward after its socket became ready.
+    \param pending The in-flight connect.
+    \param candidates Pool the new session joins for PEX.
+    \param opened Incremented when the session is established.
+    \return True once the connect is finished, either way.
+*/
+bool PeerConnectionManager::advance(HalfOpen &pending, PeerCandidatePool &candidates, size_t &opened)
+{
+    if (pending.stage == Stage::Connecting)
+    {
+        int error = 0;
+        socklen_t errorLength = sizeof(error);
+        if (getsockopt(pending.socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&error), &errorLength) != 0 || error != 0)
+        {
+            fail(pending);
+            return true;
+        }
+        PeerQualityCache::shared().recordConnect(pending.peer, true, elapsedSince(pending.started));
+
+        PeerConnection::encodeHandshake(metadata.getInfoHash(), pending.handshake);
+        pending.stage = Stage::Sending;
+        pending.deadline = Clock::now() + HANDSHAKE_TIMEOUT;
+    }
+
+    if (pending.stage == Stage::Sending)
+    {
+        int result = send(pending.socket, pending.handshake + pending.transferred,
+                          static_cast<int>(PeerConnection::HANDSHAKE_SIZE - pending.transferred), SEND_FLAGS);
+        if (result < 0 && wouldBlock())
+        {
+            return false;
+        }
+        if (result <= 0)
+        {
+            fail(pending);
+            return true;
+        }
+        pending.transferred += static_cast<size_t>(result);
+        if (pending.transferred == PeerConnection::HANDSHAKE_SIZE)
+        {
+            pending.stage = Stage::Receiving;
+            pending.transferred = 0;
+            watch(pending, false);
+        }
+        return false; //!> The reply cannot be here yet
+    }
+
+    //* Read exactly the handshake; whatever the peer sends after it stays in the socket
+    int result = recv(pending.socket, pending.handshake + pending.transferred,
+                      static_cast<int>(PeerConnection::HANDSHAKE_SIZE - pending.transferred), 0);
+    if (result < 0 && wouldBlock())
+    {
+        return false;
+    }
+    if (result <= 0)
+    {
+        fail(pending);
+        return true;
+    }
+    pending.transferred += static_cast<size_t>(result);
+    if (pending.transferred < PeerConnection::HANDSHAKE_SIZE)
+    {
+        return false;
+    }
+
+    bool extensions = false;
+    bool fast = false;
+    if (!PeerConnection::checkHandshake(metadata.getInfoHash(), pending.handshake, extensions, fast))
+    {
+        fail(pending);
+        return true;
+    }
+    PeerQualityCache::shared().recordHandshake(pending.peer, true);
+
+    unwatch(pending);
+    setNonBlocking(pending.socket, false);
+    auto session = std::make_shared<PeerConnection>(pending.peer, metadata, pending.socket, extensions, fast);
+    pending.socket = INVALID_SOCKET;
+    session->setAvailability(&availability);
+    try
+    {
+        session->announcePieces();
+        session->setPeerExchange(candidates);
+        session->drain(); //* The bitfield usually arrives with the handshake
+    }
+    catch (const std::exception &)
+    {
+        return true; //!> Closed right after the handshake
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(std::move(session));
+    }
+    released.notify_one();
+    opened++;
+    return true;
+}
+
+/*!
+    \brief Connect to untried candidates until the session pool is full or the candidates run out.
+    \param candidates Where to take peers from (must outlive the sessions).
+    \return Number of new sessions.
+*/
+size_t PeerConnectionManager::connect(PeerCandidatePool &candidates)
+{
+    std::vector<HalfOpen> pending;
+    pending.reserve(MAX_HALF_OPEN);
+    std::vector<bool> ready;
+    size_t opened = 0;
+    bool exhausted = false;
+    PeerEndpoint peer;
+
+    while (true)
+    {
+        while (!exhausted && pending.size() < MAX_HALF_OPEN && sessionCount() + pending.size() < MAX_SESSIONS)
+        {
+            if (!candidates.next(peer))
+            {
+                exhausted = true;
+                break;
+            }
+            HalfOpen connect;
+            if (startConnect(peer, connect))
+            {
+                pending.push_back(connect);
+                watch(pending.back(), true);
+            }
+        }
+        if (pending.empty())
+        {
+            break;
+        }
+
+        auto now = Clock::now();
+        auto earliest = std::min_element(pending.begin(), pending.end(), [](const HalfOpen &a, const HalfOpen &b)
+                                         { return a.deadline < b.deadline; })
+                            ->deadline;
+        int waitMs = static_cast<int>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(earliest - now).count() + 1));
+
+        ready.assign(pending.size(), false);
+#ifdef __linux__
+        epoll_event events[MAX_HALF_OPEN];
+        int count = epoll_wait(pollFd, events, static_cast<int>(MAX_HALF_OPEN), waitMs);
+        for (int i = 0; i < count; ++i)
+        {
+            for (size_t j = 0; j < pending.size(); ++j)
+            {
+                if (pending[j].socket == events[i].data.fd)
+                {
+                    ready[j] = true;
+                    break;
+                }
+            }
+        }
+#else
+#ifdef _WIN32
+        std::vector<WSAPOLLFD> entries(pending.size());
+#else
+        std::vector<pollfd> entries(pending.size());
+#endif
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            entries[i].fd = pending[i].socket;
+            entries[i].events = pending[i].stage == Stage::Receiving ? POLLIN : POLLOUT;
+        }
+#ifdef _WIN32
+        int count = WSAPoll(entries.data(), static_cast<ULONG>(entries.size()), waitMs);
+#else
+        int count = ::poll(entries.data(), static_cast<nfds_t>(entries.size()), waitMs);
+#endif
+        for (size_t i = 0; count > 0 && i < entries.size(); ++i)
+        {
+            ready[i] = entries[i].revents != 0;
+        }
+#endif
+
+        now = Clock::now();
+        size_t kept = 0;
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            bool finished;
+            if (ready[i])
+            {
+                finished = advance(pending[i], candidates, opened);
+            }
+            else
+            {
+                finished = now >= pending[i].deadline;
+                if (finished)
+                {
+                    fail(pending[i]);
+                }
+            }
+            if (!finished)
+            {
+                pending[kept++] = pending[i];
+            }
+        }
+        pending.resize(kept);
+    }
+    return opened;
+}
+
+/*!
+    \brief Borrow an idle session, waiting for one to be released if all are in use.
+    \param timeout How long to wait.
+    \return The session, or nullptr if none became idle in time or the pool is empty.
+*/
+std::shared_ptr<PeerConnection> PeerConnectionManager::acquire(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    released.wait_for(lock, timeout, [this]()
+                      { return !idle.empty() || borrowed == 0; });
+    if (idle.empty())
+    {
+        return nullptr;
+    }
+    std::shared_ptr<PeerConnection> session = std::move(idle.back());
+    idle.pop_back();
+    borrowed++;
+    return session;
+}
+
+/*!
+    \brief Return a borrowed session.
+    \param session The session from acquire().
+    \param reusable False if the connection failed; it is closed and forgotten.
+*/
+void PeerConnectionManager::release(const std::shared_ptr<PeerConnection> &session, bool reusable)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        borrowed--;
+        if (reusable && !session->isReceivingBlock()) //!> Mid-block it still writes into the last borrower's buffer
+        {
+            idle.insert(idle.begin(), session); //!> Back of the queue, so sessions take turns
+        }
+    }
+    released.notify_all();
+}
+
+/*!
+    \brief Close every idle session (borrowed ones are left alone).
+    \return Number of sessions closed.
+*/
+size_t PeerConnectionManager::closeIdle()
+{
+    std::vector<std::shared_ptr<PeerConnection>> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing.swap(idle);
+    }
+    return closing.size(); //!> Closed here, outside the lock
+}
+
+/*!
+    \brief Number of sessions, idle or borrowed.
+    \return The session count.
+*/
+size_t PeerConnectionManager::sessionCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return idle.size() + borrowed;
+}
+
+/*!
+    \brief Number of idle sessions.
+    \return The idle count.
+*/
+size_t PeerConnectionManager::idleCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return idle.size();
+}
@@ -0,0 +1,143 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerConnectionManager.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 21:06:14
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PEER_CONNECTION_MANAGER_H
+#define PEER_CONNECTION_MANAGER_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include "PeerConnection.h"
+#include "PeerCandidatePool.h"
+#include "MagnetMetadata.h"
+
+/*!
+    \brief Opens peer connections concurrently and keeps the established ones for reuse.
+    connect() issues non-blocking connects to many candidates at once (at most MAX_HALF_OPEN
+    outstanding), sends and checks the handshake on each, and enforces separate connect and
+    handshake deadlines, all from one poller (epoll on Linux, poll elsewhere). Sessions that
+    complete the handshake go into a pool that download threads borrow with acquire() and hand
+    back with release(). Outcomes are recorded in the peer quality cache, and every session's
+    pieces are counted in one availability table.
+*/
+class PeerConnectionManager
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_HALF_OPEN = 32;                         //!> Connects and handshakes in flight at once.
+    static constexpr size_t MAX_SESSIONS = 50;                          //!> Established sessions kept.
+    static constexpr std::chrono::milliseconds CONNECT_TIMEOUT{5000};   //!> Budget for the TCP connect.
+    static constexpr std::chrono::milliseconds HANDSHAKE_TIMEOUT{8000}; //!> Budget for the handshake once connected.
+
+    /*!
+        \brief Creates an empty manager for one torrent.
+        \param metadata The torrent (its info hash goes into every handshake).
+    */
+    explicit PeerConnectionManager(const MagnetMetadata &metadata);
+
+    /*!
+        \brief Closes every pooled session.
+    */
+    ~PeerConnectionManager();
+
+    PeerConnectionManager(const PeerConnectionManager &) = delete;
+    PeerConnectionManager &operator=(const PeerConnectionManager &) = delete;
+
+    /*!
+        \brief Connect to untried candidates until the session pool is full or the candidates run out.
+        Candidates are taken from the pool in its order (rank it first). Every new session is
+        marked connected in the pool and trades peers with it over PEX for as long as it lives.
+        \param candidates Where to take peers from (must outlive the sessions).
+        \return Number of new sessions.
+    */
+    size_t connect(PeerCandidatePool &candidates);
+
+    /*!
+        \brief Borrow an idle session, waiting for one to be released if all are in use.
+        \param timeout How long to wait.
+        \return The session, or nullptr if none became idle in time or the pool is empty.
+    */
+    std::shared_ptr<PeerConnection> acquire(std::chrono::milliseconds timeout);
+
+    /*!
+        \brief Return a borrowed session.
+        \param session The session from acquire().
+        \param reusable False if the connection failed; it is closed and forgotten (as is a session still
+        receiving a block into the borrower's buffer).
+    */
+    void release(const std::shared_ptr<PeerConnection> &session, bool reusable);
+
+    /*!
+        \brief Close every idle session (borrowed ones are left alone).
+        Use it before the candidate pool the sessions were connected from goes away.
+        \return Number of sessions closed.
+    */
+    size_t closeIdle();
+
+    /*!
+        \brief Number of sessions, idle or borrowed.
+        \return The session count.
+    */
+    size_t sessionCount() const;
+
+    /*!
+        \brief Number of idle sessions.
+        \return The idle count.
+    */
+    size_t idleCount() const;
+
+    /*!
+        \brief How many connected peers have each piece.
+        \return The counts, kept current by every session.
+    */
+    const PieceAvailability &pieceAvailability() const { return availability; }
+
+private:
+    enum class Stage : uint8_t
+    {
+        Connecting,
+        Sending,
+        Receiving
+    };
+
+    struct HalfOpen
+    {
+        PeerEndpoint peer;                              //!> Who we are connecting to.
+        PeerConnection::SocketHandle socket;            //!> Non-blocking socket.
+        Stage stage;                                    //!> Progress.
+        Clock::time_point started;                      //!> When the connect was issued.
+        Clock::time_point deadline;                     //!> Connect or handshake deadline.
+        size_t transferred;                             //!> Handshake bytes sent or received so far.
+        char handshake[PeerConnection::HANDSHAKE_SIZE]; //!> Our handshake, then the peer's.
+    };
+
+    MagnetMetadata metadata;                           //!> Torrent the sessions are for.
+    PieceAvailability availability;                    //!> Piece counts over all sessions (outlives them).
+    mutable std::mutex mutex;                          //!> Guards the session lists.
+    std::condition_variable released;                  //!> Signalled when a session comes back.
+    std::vector<std::shared_ptr<PeerConnection>> idle; //!> Sessions ready to borrow.
+    size_t borrowed = 0;                               //!> Sessions out on loan.
+    int pollFd = -1;                                   //!> epoll instance (Linux only).
+
+    bool startConnect(const PeerEndpoint &peer, HalfOpen &pending);
+    bool advance(HalfOpen &pending, PeerCandidatePool &candidates, size_t &opened);
+    void watch(const HalfOpen &pending, bool add);
+    void unwatch(const HalfOpen &pending);
+    void fail(HalfOpen &pending);
+    static void closeHandle(PeerConnection::SocketHandle socket);
+};
+
+#endif
@@ -12,35 +12,87 @@
 
 
 #include "PeerDiscovery.h"
+#include "TorrentUtilities.h"
+#include "LocalServiceDiscovery.h"
 #include <stdexcept>
+#include <future>
+#include <iostream>
+
+#define ANNOUNCE_EVENT_STARTED 2
+#define LISTEN_PORT 6881
 
 /*!
     \brief Creates a PeerDiscovery object with the given info hash.
     \param infoHash The info hash of the torrent.
+    \param trackers Tracker URLs from the magnet link (udp:// and http://).
 */
-PeerDiscovery::PeerDiscovery(const std::string &infoHash) : infoHash(infoHash), dhtClient(infoHash) {}
+PeerDiscovery::PeerDiscovery(const std::string &infoHash, const std::vector<std::string> &trackers)
+    : infoHash(infoHash), trackers(trackers), dhtClient(infoHash)
+{
+    try
+    {
+        LocalServiceDiscovery::shared().watch(TorrentUtilities::infoHashToBytes(infoHash), pool);
+        watchingLocal = true;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Local service discovery unavailable: " << e.what() << std::endl;
+    }
+}
 
 /*!
-    \brief Discovers peers for the torrent.
-    \return A vector of peer addresses.
+    \brief Stops feeding local peers into the candidate pool.
 */
-std::vector<std::string> PeerDiscovery::discoverPeers()
+PeerDiscovery::~PeerDiscovery()
+{
+    if (watchingLocal)
+    {
+        LocalServiceDiscovery::shared().unwatch(TorrentUtilities::infoHashToBytes(infoHash), pool);
+    }
+}
+
+/*!
+    \brief Discovers peers for the torrent and adds them to the candidate pool.
+    Local peers heard so far are already at the front of the pool.
+    \return Every candidate in the pool, each listed once.
+*/
+std::vector<PeerEndpoint> PeerDiscovery::discoverPeers()
 {
-    std::vector<std::string> allPeers;
     try
     {
-        DHTClient dhtClient(infoHash);
-        std::vector<std::string> nodes = dhtClient.getPeers();
-        for (const auto &node : nodes)
+        std::future<std::vector<PeerEndpoint>> dhtPeers = std::async(std::launch::async, [this]()
+                                                                     { return dhtClient.getPeers(); });
+
+        TrackerAnnounce request;
+        request.infoHash = TorrentUtilities::infoHashToBytes(infoHash);
+        request.peerId = TorrentUtilities::localPeerId();
+        request.port = LISTEN_PORT;
+        request.event = ANNOUNCE_EVENT_STARTED;
+        std::future<std::vector<TrackerResponse>> httpResponses = std::async(std::launch::async, [this, &request]()
+                                                                             { return HttpTrackerClient::shared().announce(trackers, request); });
+        std::vector<TrackerResponse> responses = UdpTrackerClient::shared().announce(trackers, request);
+        for (TrackerResponse &response : httpResponses.get())
+        {
+            responses.push_back(std::move(response));
+        }
+        for (const TrackerResponse &response : responses)
         {
-            std::string query = dhtClient.buildGetPeersQuery();
-            std::vector<std::string> peersFromNode = dhtClient.getPeersFromNode(node, query);
-            allPeers.insert(allPeers.end(), peersFromNode.begin(), peersFromNode.end());
+            if (response.ok)
+            {
+                std::cout << "Tracker " << response.tracker << ": " << response.peers.size() << " peers, "
+                          << response.seeders << " seeders, " << response.leechers << " leechers" << std::endl;
+                pool.add(response.peers, PeerSource::Tracker);
+            }
+            else
+            {
+                std::cerr << "Tracker " << response.tracker << ": " << response.error << std::endl;
+            }
         }
+        pool.add(dhtPeers.get(), PeerSource::Dht);
     }
     catch (const std::exception &e)
     {
         throw std::runtime_error("Failed to discover peers: " + std::string(e.what()));
     }
-    return allPeers;
+    return pool.snapshot();
 }
\ No newline at end of file
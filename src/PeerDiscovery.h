@@ -17,25 +17,46 @@
 #include <string>
 #include <cstdint>
 #include "DHTClient.h"
+#include "UdpTrackerClient.h"
+#include "HttpTrackerClient.h"
+#include "PeerCandidatePool.h"
 
 class PeerDiscovery
 {
 public:
     /*!
         \brief Creates a PeerDiscovery object with the given info hash.
+        Starts announcing the torrent on the local network right away; LAN peers that answer
+        go to the front of the candidate pool.
         \param infoHash The info hash of the torrent.
+        \param trackers Tracker URLs from the magnet link (udp:// and http://).
     */
-    explicit PeerDiscovery(const std::string &infoHash);
+    explicit PeerDiscovery(const std::string &infoHash, const std::vector<std::string> &trackers = {});
 
     /*!
-        \brief Discovers peers for the torrent.
-        \return A vector of peer addresses.
+        \brief Stops feeding local peers into the candidate pool.
     */
-    std::vector<std::string> discoverPeers();
+    ~PeerDiscovery();
+
+    /*!
+        \brief Discovers peers for the torrent and adds them to the candidate pool.
+        The DHT lookup runs in the background while every tracker is announced to at once.
+        \return Every candidate in the pool, each listed once.
+    */
+    std::vector<PeerEndpoint> discoverPeers();
+
+    /*!
+        \brief The candidate pool discovery fills; peer exchange keeps adding to it.
+        \return The pool.
+    */
+    PeerCandidatePool &candidates() { return pool; }
 
 private:
-    std::string infoHash; //!< Info hash of the torrent file.
-    DHTClient dhtClient;  //!< DHT client.
+    std::string infoHash;              //!< Info hash of the torrent file.
+    std::vector<std::string> trackers; //!< Tracker URLs.
+    DHTClient dhtClient;               //!< DHT client.
+    PeerCandidatePool pool;            //!< Deduplicated candidates from every source.
+    bool watchingLocal = false;        //!< Registered with local service discovery.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,295 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerEndpoint.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 16:41:52
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PeerEndpoint.h"
+#include <cstring>
+#include <algorithm>
+
+/*!
+    \brief Wrap a compact peer record.
+    \param data 6 or 18 bytes.
+    \return The endpoint, or an invalid one for any other size.
+*/
+PeerEndpoint PeerEndpoint::fromCompact(std::string_view data)
+{
+    PeerEndpoint endpoint;
+    if (data.size() == COMPACT_V4_SIZE || data.size() == COMPACT_V6_SIZE)
+    {
+        std::memcpy(endpoint.bytes.data(), data.data(), data.size());
+        endpoint.length = static_cast<uint8_t>(data.size());
+    }
+    return endpoint;
+}
+
+/*!
+    \brief Build from an IPv4 socket address.
+    \param address The address.
+    \return The endpoint.
+*/
+PeerEndpoint PeerEndpoint::fromSockaddr(const sockaddr_in &address)
+{
+    PeerEndpoint endpoint;
+    std::memcpy(endpoint.bytes.data(), &address.sin_addr, 4);
+    std::memcpy(endpoint.bytes.data() + 4, &address.sin_port, 2); //!> Both already network order
+    endpoint.length = COMPACT_V4_SIZE;
+    return endpoint;
+}
+
+/*!
+    \brief Build from an IPv6 socket address.
+    \param address The address.
+    \return The endpoint.
+*/
+PeerEndpoint PeerEndpoint::fromSockaddr(const sockaddr_in6 &address)
+{
+    PeerEndpoint endpoint;
+    std::memcpy(endpoint.bytes.data(), &address.sin6_addr, 16);
+    std::memcpy(endpoint.bytes.data() + 16, &address.sin6_port, 2);
+    endpoint.length = COMPACT_V6_SIZE;
+    return endpoint;
+}
+
+/*!
+    \brief Parse "a.b.c.d:port" or "[v6]:port".
+    \param text The textual endpoint.
+    \return The endpoint, or an invalid one if the text does not parse or the port is 0.
+*/
+PeerEndpoint PeerEndpoint::parse(const std::string &text)
+{
+    size_t colonPos = text.rfind(':');
+    if (colonPos == std::string::npos || colonPos + 1 == text.size() || text.size() - colonPos > 6)
+    {
+        return PeerEndpoint();
+    }
+
+    unsigned long port = 0;
+    for (size_t i = colonPos + 1; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+        {
+            return PeerEndpoint();
+        }
+        port = port * 10 + static_cast<unsigned long>(text[i] - '0');
+    }
+    if (port == 0 || port > 0xFFFF)
+    {
+        return PeerEndpoint(); //!> Port 0 cannot be connected to
+    }
+
+    std::string host = text.substr(0, colonPos);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+    {
+        sockaddr_in6 address{};
+        address.sin6_family = AF_INET6;
+        address.sin6_port = htons(static_cast<uint16_t>(port));
+        if (inet_pton(AF_INET6, host.substr(1, host.size() - 2).c_str(), &address.sin6_addr) <= 0)
+        {
+            return PeerEndpoint();
+        }
+        return fromSockaddr(address);
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) <= 0)
+    {
+        return PeerEndpoint();
+    }
+    return fromSockaddr(address);
+}
+
+/*!
+    \brief The compact bytes.
+    \return 6 or 18 bytes (empty if invalid).
+*/
+std::string_view PeerEndpoint::compact() const
+{
+    return std::string_view(reinterpret_cast<const char *>(bytes.data()), length);
+}
+
+/*!
+    \brief The port.
+    \return Port in host order.
+*/
+uint16_t PeerEndpoint::port() const
+{
+    if (length == 0)
+    {
+        return 0;
+    }
+    return static_cast<uint16_t>((bytes[length - 2] << 8) | bytes[length - 1]);
+}
+
+/*!
+    \brief Format for logging.
+    \return "a.b.c.d:port" or "[v6]:port".
+*/
+std::string PeerEndpoint::toString() const
+{
+    if (length == 0)
+    {
+        return "<invalid>";
+    }
+
+    char address[INET6_ADDRSTRLEN];
+    if (isV6())
+    {
+        inet_ntop(AF_INET6, bytes.data(), address, sizeof(address));
+        return "[" + std::string(address) + "]:" + std::to_string(port());
+    }
+    inet_ntop(AF_INET, bytes.data(), address, sizeof(address));
+    return std::string(address) + ":" + std::to_string(port());
+}
+
+/*!
+    \brief Fill a socket address.
+    \param address Receives a sockaddr_in or sockaddr_in6.
+    \return The address size to pass to connect(), or 0 if the endpoint is invalid.
+*/
+socklen_t PeerEndpoint::toSockaddr(sockaddr_storage &address) const
+{
+    address = sockaddr_storage{};
+    if (isV6())
+    {
+        sockaddr_in6 &v6 = reinterpret_cast<sockaddr_in6 &>(address);
+        v6.sin6_family = AF_INET6;
+        std::memcpy(&v6.sin6_addr, bytes.data(), 16);
+        std::memcpy(&v6.sin6_port, bytes.data() + 16, 2);
+        return sizeof(sockaddr_in6);
+    }
+    if (length == COMPACT_V4_SIZE)
+    {
+        sockaddr_in &v4 = reinterpret_cast<sockaddr_in &>(address);
+        v4.sin_family = AF_INET;
+        std::memcpy(&v4.sin_addr, bytes.data(), 4);
+        std::memcpy(&v4.sin_port, bytes.data() + 4, 2);
+        return sizeof(sockaddr_in);
+    }
+    return 0;
+}
+
+/*!
+    \brief Hash the compact bytes.
+    \return FNV-1a hash.
+*/
+size_t PeerEndpoint::hash() const
+{
+    uint64_t value = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        value ^= bytes[i];
+        value *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(value ^ (value >> 32));
+}
+
+/*!
+    \brief Compare two endpoints.
+    \param other The other endpoint.
+    \return True if both hold the same compact record.
+*/
+bool PeerEndpoint::operator==(const PeerEndpoint &other) const
+{
+    return length == other.length && std::memcmp(bytes.data(), other.bytes.data(), length) == 0;
+}
+
+/*!
+    \brief Creates an empty set.
+    \param expected Number of endpoints to size the table for.
+*/
+PeerEndpointSet::PeerEndpointSet(size_t expected)
+{
+    size_t capacity = 16;
+    while (capacity < expected * 2)
+    {
+        capacity *= 2;
+    }
+    slots.resize(capacity);
+}
+
+/*!
+    \brief Find the slot holding an endpoint, or the empty slot where it would go.
+    \param endpoint The endpoint.
+    \return The slot index.
+*/
+size_t PeerEndpointSet::probe(const PeerEndpoint &endpoint) const
+{
+    size_t mask = slots.size() - 1;
+    size_t index = endpoint.hash() & mask;
+    while (slots[index].isValid() && slots[index] != endpoint)
+    {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+/*!
+    \brief Double the table and reinsert every endpoint.
+*/
+void PeerEndpointSet::grow()
+{
+    std::vector<PeerEndpoint> old(slots.size() * 2);
+    old.swap(slots);
+    for (const PeerEndpoint &endpoint : old)
+    {
+        if (endpoint.isValid())
+        {
+            slots[probe(endpoint)] = endpoint;
+        }
+    }
+}
+
+/*!
+    \brief Add an endpoint.
+    \param endpoint The endpoint (invalid ones are ignored).
+    \return True if it was not already present.
+*/
+bool PeerEndpointSet::insert(const PeerEndpoint &endpoint)
+{
+    if (!endpoint.isValid())
+    {
+        return false;
+    }
+    size_t index = probe(endpoint);
+    if (slots[index].isValid())
+    {
+        return false;
+    }
+    if ((count + 1) * 2 > slots.size())
+    {
+        grow();
+        index = probe(endpoint); //!> Only grow for a new key; duplicates leave the table alone
+    }
+    slots[index] = endpoint;
+    count++;
+    return true;
+}
+
+/*!
+    \brief Check for an endpoint.
+    \param endpoint The endpoint.
+    \return True if present.
+*/
+bool PeerEndpointSet::contains(const PeerEndpoint &endpoint) const
+{
+    return endpoint.isValid() && slots[probe(endpoint)].isValid();
+}
+
+/*!
+    \brief Remove every endpoint, keeping the table.
+*/
+void PeerEndpointSet::clear()
+{
+    std::fill(slots.begin(), slots.end(), PeerEndpoint());
+    count = 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerEndpoint.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 16:41:08
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PEER_ENDPOINT_H
+#define PEER_ENDPOINT_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief A peer's address and port in compact form: 6 bytes for IPv4, 18 for IPv6
+    (address then big-endian port, exactly as peers appear on the wire).
+*/
+class PeerEndpoint
+{
+public:
+    static constexpr size_t COMPACT_V4_SIZE = 6;  //!> 4-byte address, 2-byte port.
+    static constexpr size_t COMPACT_V6_SIZE = 18; //!> 16-byte address, 2-byte port.
+
+    /*!
+        \brief Creates an invalid endpoint.
+    */
+    PeerEndpoint() = default;
+
+    /*!
+        \brief Wrap a compact peer record.
+        \param data 6 or 18 bytes.
+        \return The endpoint, or an invalid one for any other size.
+    */
+    static PeerEndpoint fromCompact(std::string_view data);
+
+    /*!
+        \brief Build from an IPv4 socket address.
+        \param address The address.
+        \return The endpoint.
+    */
+    static PeerEndpoint fromSockaddr(const sockaddr_in &address);
+
+    /*!
+        \brief Build from an IPv6 socket address.
+        \param address The address.
+        \return The endpoint.
+    */
+    static PeerEndpoint fromSockaddr(const sockaddr_in6 &address);
+
+    /*!
+        \brief Parse "a.b.c.d:port" or "[v6]:port".
+        \param text The textual endpoint.
+        \return The endpoint, or an invalid one if the text does not parse or the port is 0.
+    */
+    static PeerEndpoint parse(const std::string &text);
+
+    bool isValid() const { return length != 0; }            //!> True unless default-constructed or unparseable.
+    bool isV6() const { return length == COMPACT_V6_SIZE; } //!> True for IPv6 endpoints.
+    std::string_view compact() const;                       //!> The 6 or 18 compact bytes.
+    uint16_t port() const;                                  //!> Port in host order.
+    std::string toString() const;                           //!> "a.b.c.d:port" or "[v6]:port".
+    socklen_t toSockaddr(sockaddr_storage &address) const;  //!> Fill a socket address; returns its size (0 if invalid).
+    size_t hash() const;                                    //!> FNV-1a of the compact bytes.
+
+    bool operator==(const PeerEndpoint &other) const;
+    bool operator!=(const PeerEndpoint &other) const { return !(*this == other); }
+
+private:
+    std::array<uint8_t, COMPACT_V6_SIZE> bytes{}; //!> Compact record, zero padded.
+    uint8_t length = 0;                           //!> 0, 6 or 18.
+};
+
+/*!
+    \brief Open-addressing set of endpoints for deduplicating peer lists.
+    Linear probing over a power-of-two table kept at most half full; endpoints are stored
+    inline, so a lookup touches one or two cache lines and never allocates.
+*/
+class PeerEndpointSet
+{
+public:
+    /*!
+        \brief Creates an empty set.
+        \param expected Number of endpoints to size the table for.
+    */
+    explicit PeerEndpointSet(size_t expected = 16);
+
+    /*!
+        \brief Add an endpoint.
+        \param endpoint The endpoint (invalid ones are ignored).
+        \return True if it was not already present.
+    */
+    bool insert(const PeerEndpoint &endpoint);
+
+    /*!
+        \brief Check for an endpoint.
+        \param endpoint The endpoint.
+        \return True if present.
+    */
+    bool contains(const PeerEndpoint &endpoint) const;
+
+    size_t size() const { return count; } //!> Number of endpoints stored.
+    void clear();                         //!> Remove every endpoint, keeping the table.
+
+private:
+    std::vector<PeerEndpoint> slots; //!> Invalid endpoints mark empty slots.
+    size_t count = 0;                //!> Occupied slots.
+
+    size_t probe(const PeerEndpoint &endpoint) const;
+    void grow();
+};
+
+#endif
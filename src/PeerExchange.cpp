@@ -0,0 +1,225 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerExchange.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 19:26:08
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PeerExchange.h"
+#include "BencodeDocument.h"
+#include "BencodeWriter.h"
+#include <stdexcept>
+
+#define CLIENT_VERSION "MolexTorrent 0.1"
+#define PEX_FLAG_REACHABLE 0x10 //!> We connected out to the peer, so it accepts connections
+
+/*!
+    \brief Append the compact form of each peer of one address family.
+    \param peers The peers.
+    \param v6 Which family to take.
+    \param limit Most peers to take.
+    \param compact Receives the compact records.
+    \param flags Receives one flag byte per peer (nullptr to skip).
+*/
+static void packPeers(const std::vector<PeerEndpoint> &peers, bool v6, size_t limit, std::string &compact, std::string *flags)
+{
+    for (const PeerEndpoint &peer : peers)
+    {
+        if (peer.isV6() != v6)
+        {
+            continue;
+        }
+        if (limit-- == 0)
+        {
+            break;
+        }
+        compact.append(peer.compact());
+        if (flags != nullptr)
+        {
+            flags->push_back(static_cast<char>(PEX_FLAG_REACHABLE));
+        }
+    }
+}
+
+/*!
+    \brief Split a compact peer string into endpoints.
+    \param data The compact records.
+    \param recordSize 6 or 18.
+    \param limit Most peers to take (decremented).
+    \param peers Receives the peers.
+*/
+static void unpackPeers(std::string_view data, size_t recordSize, size_t &limit, std::vector<PeerEndpoint> &peers)
+{
+    for (size_t offset = 0; offset + recordSize <= data.size() && limit > 0; offset += recordSize, --limit)
+    {
+        peers.push_back(PeerEndpoint::fromCompact(data.substr(offset, recordSize)));
+    }
+}
+
+/*!
+    \brief Encode our extension handshake. There is no `p`, as we accept no incoming connections.
+    \param out Destination buffer (MAX_MESSAGE bytes).
+    \return Payload size: the extended ID byte followed by the bencoded dictionary.
+*/
+size_t PeerExchange::encodeHandshake(char *out)
+{
+    out[0] = static_cast<char>(HANDSHAKE_ID);
+    BencodeWriter writer(out + 1, MAX_MESSAGE - 1);
+    writer.beginDictionary();
+    writer.key("m");
+    writer.beginDictionary();
+    writer.key("ut_pex");
+    writer.integer(LOCAL_PEX_ID);
+    writer.end();
+    writer.key("v");
+    writer.string(CLIENT_VERSION);
+    writer.end();
+    return 1 + writer.size();
+}
+
+/*!
+    \brief Read the peer's extension handshake.
+    \param dictionary The bencoded handshake.
+*/
+void PeerExchange::onHandshake(std::string_view dictionary)
+{
+    BencodeDocument document;
+    document.parse(dictionary);
+    int64_t id = document.root().find("m").find("ut_pex").asInteger();
+    remotePexId = id > 0 && id < 256 ? static_cast<uint8_t>(id) : 0;
+}
+
+/*!
+    \brief Handle an extended message from the peer.
+    \param payload Message payload after the id 20 byte.
+    \param added Receives peers the peer says it connected to.
+    \param dropped Receives peers the peer says it disconnected from.
+    \return True if the message was a PEX message that produced peers.
+*/
+bool PeerExchange::onMessage(std::string_view payload, std::vector<PeerEndpoint> &added, std::vector<PeerEndpoint> &dropped)
+{
+    if (payload.empty())
+    {
+        return false;
+    }
+
+    try
+    {
+        uint8_t id = static_cast<uint8_t>(payload[0]);
+        if (id == HANDSHAKE_ID)
+        {
+            onHandshake(payload.substr(1));
+            return false;
+        }
+        if (id != LOCAL_PEX_ID)
+        {
+            return false;
+        }
+
+        BencodeDocument document;
+        document.parse(payload.substr(1));
+        BencodeValue root = document.root();
+        size_t addLimit = MAX_ACCEPTED;
+        size_t dropLimit = MAX_ACCEPTED;
+        unpackPeers(root.find("added").asString(), PeerEndpoint::COMPACT_V4_SIZE, addLimit, added);
+        unpackPeers(root.find("added6").asString(), PeerEndpoint::COMPACT_V6_SIZE, addLimit, added);
+        unpackPeers(root.find("dropped").asString(), PeerEndpoint::COMPACT_V4_SIZE, dropLimit, dropped);
+        unpackPeers(root.find("dropped6").asString(), PeerEndpoint::COMPACT_V6_SIZE, dropLimit, dropped);
+        return !added.empty() || !dropped.empty();
+    }
+    catch (const std::exception &)
+    {
+        return false; //!> Malformed message: ignore it rather than drop the connection
+    }
+}
+
+/*!
+    \brief Check whether our next PEX message may go out.
+    \param now The current time.
+    \return True if PEX is enabled and INTERVAL has passed since the last one.
+*/
+bool PeerExchange::isDue(Clock::time_point now) const
+{
+    return isEnabled() && (!sentAny || now - lastSent >= INTERVAL);
+}
+
+/*!
+    \brief Encode a PEX message announcing changes to our connected set since the last one.
+    \param connected Peers we are connected to right now.
+    \param out Destination buffer (MAX_MESSAGE bytes).
+    \param now The current time.
+    \return Payload size (extended ID byte then dictionary), or 0 if there is nothing to say.
+*/
+size_t PeerExchange::buildMessage(const std::vector<PeerEndpoint> &connected, char *out, Clock::time_point now)
+{
+    lastSent = now;
+    sentAny = true;
+
+    PeerEndpointSet current(connected.size());
+    for (const PeerEndpoint &peer : connected)
+    {
+        current.insert(peer);
+    }
+    PeerEndpointSet previous(advertised.size());
+    for (const PeerEndpoint &peer : advertised)
+    {
+        previous.insert(peer);
+    }
+
+    std::vector<PeerEndpoint> added;
+    for (const PeerEndpoint &peer : connected)
+    {
+        if (!previous.contains(peer) && added.size() < MAX_ADDED)
+        {
+            added.push_back(peer);
+        }
+    }
+    std::vector<PeerEndpoint> dropped;
+    std::vector<PeerEndpoint> kept;
+    for (const PeerEndpoint &peer : advertised)
+    {
+        if (!current.contains(peer) && dropped.size() < MAX_ADDED)
+        {
+            dropped.push_back(peer);
+        }
+        else
+        {
+            kept.push_back(peer);
+        }
+    }
+    if (added.empty() && dropped.empty())
+    {
+        return 0;
+    }
+    kept.insert(kept.end(), added.begin(), added.end());
+    advertised.swap(kept);
+
+    std::string added4, added4Flags, added6, added6Flags, dropped4, dropped6;
+    packPeers(added, false, MAX_ADDED, added4, &added4Flags);
+    packPeers(added, true, MAX_ADDED, added6, &added6Flags);
+    packPeers(dropped, false, MAX_ADDED, dropped4, nullptr);
+    packPeers(dropped, true, MAX_ADDED, dropped6, nullptr);
+
+    out[0] = static_cast<char>(remotePexId);
+    BencodeWriter writer(out + 1, MAX_MESSAGE - 1);
+    writer.beginDictionary();
+    writer.key("added");
+    writer.string(added4);
+    writer.key("added.f");
+    writer.string(added4Flags);
+    writer.key("added6");
+    writer.string(added6);
+    writer.key("added6.f");
+    writer.string(added6Flags);
+    writer.key("dropped");
+    writer.string(dropped4);
+    writer.key("dropped6");
+    writer.string(dropped6);
+    writer.end();
+    return writer.ok() ? 1 + writer.size() : 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerExchange.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 19:11:33
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PEER_EXCHANGE_H
+#define PEER_EXCHANGE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include "PeerEndpoint.h"
+
+/*!
+    \brief Per-connection state for the extension protocol (BEP 10) and ut_pex (BEP 11).
+    Transport agnostic: the connection hands in the payloads of extended messages (id 20)
+    and sends what this class encodes. Our PEX messages carry only the difference from the
+    previous one, at most once per INTERVAL.
+*/
+class PeerExchange
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint8_t EXTENDED_MESSAGE = 20;     //!> Peer wire message ID of extension messages.
+    static constexpr uint8_t HANDSHAKE_ID = 0;          //!> Extended message ID of the extension handshake.
+    static constexpr uint8_t LOCAL_PEX_ID = 1;          //!> ID we assign to ut_pex in our handshake.
+    static constexpr std::chrono::seconds INTERVAL{60}; //!> Minimum time between our PEX messages.
+    static constexpr size_t MAX_ADDED = 50;             //!> Peers added per message (either family).
+    static constexpr size_t MAX_ACCEPTED = 200;         //!> Peers taken from one incoming message.
+    static constexpr size_t MAX_MESSAGE = 4096;         //!> Buffer size that fits any message we build.
+
+    /*!
+        \brief Encode our extension handshake. There is no `p`, as we accept no incoming connections.
+        \param out Destination buffer (MAX_MESSAGE bytes).
+        \return Payload size: the extended ID byte followed by the bencoded dictionary.
+    */
+    static size_t encodeHandshake(char *out);
+
+    /*!
+        \brief Handle an extended message from the peer.
+        \param payload Message payload after the id 20 byte.
+        \param added Receives peers the peer says it connected to.
+        \param dropped Receives peers the peer says it disconnected from.
+        \return True if the message was a PEX message that produced peers.
+    */
+    bool onMessage(std::string_view payload, std::vector<PeerEndpoint> &added, std::vector<PeerEndpoint> &dropped);
+
+    /*!
+        \brief Check whether the peer advertised ut_pex.
+        \return True once its handshake listed ut_pex.
+    */
+    bool isEnabled() const { return remotePexId != 0; }
+
+    /*!
+        \brief Check whether our next PEX message may go out.
+        \param now The current time.
+        \return True if PEX is enabled and INTERVAL has passed since the last one.
+    */
+    bool isDue(Clock::time_point now) const;
+
+    /*!
+        \brief Encode a PEX message announcing changes to our connected set since the last one.
+        \param connected Peers we are connected to right now.
+        \param out Destination buffer (MAX_MESSAGE bytes).
+        \param now The current time.
+        \return Payload size (extended ID byte then dictionary), or 0 if there is nothing to say.
+    */
+    size_t buildMessage(const std::vector<PeerEndpoint> &connected, char *out, Clock::time_point now);
+
+private:
+    uint8_t remotePexId = 0;              //!> Peer's ID for ut_pex (0 if unsupported).
+    std::vector<PeerEndpoint> advertised; //!> Connected set as of our last message.
+    Clock::time_point lastSent;           //!> When our last message went out.
+    bool sentAny = false;                 //!> At least one message has gone out.
+
+    void onHandshake(std::string_view dictionary);
+};
+
+#endif
@@ -0,0 +1,460 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerQualityCache.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 20:42:30
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PeerQualityCache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <iterator>
+
+#define CACHE_FILE "peer_cache.dat"
+#define CACHE_MAGIC "PQC1"
+#define CACHE_VERSION 1
+#define CACHE_HEADER_SIZE (4 + 1 + 4)                                                 //!> Magic, version, entry count
+#define CACHE_FIELD_COUNT 9                                                           //!> u32 fields per record
+#define CACHE_RECORD_SIZE (1 + PeerEndpoint::COMPACT_V6_SIZE + CACHE_FIELD_COUNT * 4) //!> Length, endpoint, fields
+
+/*!
+    \brief Write a big-endian u32.
+    \param out Destination for 4 bytes.
+    \param value The value.
+*/
+static void writeU32(char *out, uint32_t value)
+{
+    out[0] = static_cast<char>(value >> 24);
+    out[1] = static_cast<char>(value >> 16);
+    out[2] = static_cast<char>(value >> 8);
+    out[3] = static_cast<char>(value);
+}
+
+/*!
+    \brief Read a big-endian u32.
+    \param data Pointer to 4 bytes.
+    \return The value.
+*/
+static uint32_t readU32(const char *data)
+{
+    return (static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(data[3]));
+}
+
+/*!
+    \brief Blend a sample into a running average (weight 1/4), seeding it on the first sample.
+    \param average The running average (0 = no samples yet).
+    \param sample The new sample.
+    \return The updated average.
+*/
+static uint32_t smooth(uint32_t average, uint64_t sample)
+{
+    uint32_t clamped = static_cast<uint32_t>(std::min<uint64_t>(sample, 0xFFFFFFFFu));
+    if (average == 0)
+    {
+        return std::max<uint32_t>(clamped, 1);
+    }
+    return static_cast<uint32_t>((static_cast<uint64_t>(average) * 3 + clamped) / 4);
+}
+
+/*!
+    \brief Creates a cache backed by a file, loading it if present.
+    \param path The cache file.
+*/
+PeerQualityCache::PeerQualityCache(const std::string &path) : path(path)
+{
+    load();
+}
+
+/*!
+    \brief Saves the cache.
+*/
+PeerQualityCache::~PeerQualityCache()
+{
+    save();
+}
+
+/*!
+    \brief The process-wide cache, created on first use. Downloads save it as they finish,
+    and it is saved again at exit.
+    \return The shared cache.
+*/
+PeerQualityCache &PeerQualityCache::shared()
+{
+    static PeerQualityCache cache(CACHE_FILE);
+    return cache;
+}
+
+/*!
+    \brief Current wall-clock time; outcomes are compared across runs.
+    \return Unix time in seconds.
+*/
+uint32_t PeerQualityCache::unixNow()
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+/*!
+    \brief Find or create the record for a peer and stamp it, evicting the least recently
+    updated record when full.
+    \param peer The peer.
+    \return The record (caller holds the mutex).
+*/
+PeerQuality &PeerQualityCache::touch(const PeerEndpoint &peer)
+{
+    auto it = entries.find(peer);
+    if (it == entries.end())
+    {
+        if (entries.size() >= MAX_ENTRIES)
+        {
+            entries.erase(recency.back());
+            recency.pop_back();
+        }
+        recency.push_front(peer);
+        it = entries.emplace(peer, Entry{PeerQuality{}, recency.begin()}).first;
+    }
+    else if (it->second.seen != recency.begin())
+    {
+        recency.splice(recency.begin(), recency, it->second.seen); //!> Iterators stay valid
+    }
+    it->second.quality.lastUpdated = unixNow();
+    return it->second.quality;
+}
+
+/*!
+    \brief Record a connect attempt.
+    \param peer The peer.
+    \param succeeded True if the TCP connection opened.
+    \param latency Time the attempt took.
+*/
+void PeerQualityCache::recordConnect(const PeerEndpoint &peer, bool succeeded, std::chrono::milliseconds latency)
+{
+    if (!peer.isValid())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    PeerQuality &quality = touch(peer);
+    if (succeeded)
+    {
+        quality.connects++;
+        quality.connectMillis = smooth(quality.connectMillis, static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)));
+    }
+    else
+    {
+        quality.connectFailures++;
+        quality.consecutiveFailures++;
+    }
+}
+
+/*!
+    \brief Record a handshake outcome.
+    \param peer The peer.
+    \param succeeded True if the peer answered with a valid handshake.
+*/
+void PeerQualityCache::recordHandshake(const PeerEndpoint &peer, bool succeeded)
+{
+    if (!peer.isValid())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    PeerQuality &quality = touch(peer);
+    if (succeeded)
+    {
+        quality.handshakes++;
+        quality.consecutiveFailures = 0;
+    }
+    else
+    {
+        quality.handshakeFailures++;
+        quality.consecutiveFailures++;
+    }
+}
+
+/*!
+    \brief Record data received from a peer.
+    \param peer The peer.
+    \param bytes Bytes received.
+    \param elapsed Time it took.
+*/
+void PeerQualityCache::recordTransfer(const PeerEndpoint &peer, uint64_t bytes, std::chrono::milliseconds elapsed)
+{
+    if (!peer.isValid() || bytes == 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    PeerQuality &quality = touch(peer);
+    uint64_t millis = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 1));
+    quality.bytesPerSecond = smooth(quality.bytesPerSecond, bytes * 1000 / millis);
+    quality.consecutiveFailures = 0;
+}
+
+/*!
+    \brief Record that a piece from a peer failed its hash check.
+    \param peer The peer.
+*/
+void PeerQualityCache::recordHashFailure(const PeerEndpoint &peer)
+{
+    if (!peer.isValid())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    touch(peer).hashFailures++;
+}
+
+/*!
+    \brief Get what is known about a peer.
+    \param peer The peer.
+    \param quality Receives the record.
+    \return False if the peer is unknown.
+*/
+bool PeerQualityCache::lookup(const PeerEndpoint &peer, PeerQuality &quality) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(peer);
+    if (it == entries.end())
+    {
+        return false;
+    }
+    quality = it->second.quality;
+    return true;
+}
+
+/*!
+    \brief Order candidates best first and drop known-bad ones.
+    \param peers The candidates, in discovery order; reordered in place.
+    \return Number of candidates dropped.
+*/
+size_t PeerQualityCache::rank(std::vector<PeerEndpoint> &peers) const
+{
+    std::vector<size_t> order = rankOrder(peers);
+    std::vector<PeerEndpoint> ranked;
+    ranked.reserve(order.size());
+    for (size_t index : order)
+    {
+        ranked.push_back(peers[index]);
+    }
+    size_t dropped = peers.size() - ranked.size();
+    peers = std::move(ranked);
+    return dropped;
+}
+
+/*!
+    \brief Work out the ranked order of candidates without moving them.
+    Tiers: peers that delivered data (fastest first), peers that completed a handshake (lowest
+    connect latency first), unknown peers (discovery order), then peers with recent failures.
+    \param peers The candidates, in discovery order.
+    \return Indices into peers, best first, with known-bad peers left out.
+*/
+std::vector<size_t> PeerQualityCache::rankOrder(const std::vector<PeerEndpoint> &peers) const
+{
+    struct Ranked
+    {
+        size_t index;     //!> Position in peers.
+        uint8_t tier;     //!> 0 best .. 3 worst.
+        uint32_t rate;    //!> Bytes per second (tier 0).
+        uint32_t latency; //!> Connect latency (tier 1).
+    };
+
+    std::vector<Ranked> ranked;
+    ranked.reserve(peers.size());
+    uint32_t oldest = unixNow() - static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(ENTRY_TTL).count());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < peers.size(); ++i)
+        {
+            auto it = entries.find(peers[i]);
+            if (it == entries.end() || it->second.quality.lastUpdated < oldest)
+            {
+                ranked.push_back({i, 2, 0, 0});
+                continue;
+            }
+
+            const PeerQuality &quality = it->second.quality;
+            if (quality.consecutiveFailures >= DEAD_AFTER_FAILURES || quality.hashFailures >= MAX_HASH_FAILURES)
+            {
+                continue;
+            }
+            if (quality.consecutiveFailures > 0)
+            {
+                ranked.push_back({i, 3, 0, 0});
+            }
+            else if (quality.bytesPerSecond > 0)
+            {
+                ranked.push_back({i, 0, quality.bytesPerSecond, 0});
+            }
+            else if (quality.handshakes > 0)
+            {
+                ranked.push_back({i, 1, 0, quality.connectMillis});
+            }
+            else
+            {
+                ranked.push_back({i, 2, 0, 0});
+            }
+        }
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Ranked &a, const Ranked &b)
+                     {
+        if (a.tier != b.tier)
+            return a.tier < b.tier;
+        if (a.tier == 0)
+            return a.rate > b.rate;
+        return a.tier == 1 && a.latency < b.latency; });
+
+    std::vector<size_t> order;
+    order.reserve(ranked.size());
+    for (const Ranked &entry : ranked)
+    {
+        order.push_back(entry.index);
+    }
+    return order;
+}
+
+/*!
+    \brief Write the cache to its file (temporary file and rename). Expired records are left out.
+    \return False if the file could not be written.
+*/
+bool PeerQualityCache::save() const
+{
+    std::vector<char> snapshot(CACHE_HEADER_SIZE);
+    std::memcpy(snapshot.data(), CACHE_MAGIC, 4);
+    snapshot[4] = CACHE_VERSION;
+
+    uint32_t oldest = unixNow() - static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(ENTRY_TTL).count());
+    uint32_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.reserve(CACHE_HEADER_SIZE + entries.size() * CACHE_RECORD_SIZE);
+        for (const auto &[peer, entry] : entries)
+        {
+            const PeerQuality &quality = entry.quality;
+            if (quality.lastUpdated < oldest)
+            {
+                continue;
+            }
+
+            size_t offset = snapshot.size();
+            snapshot.resize(offset + CACHE_RECORD_SIZE);
+            char *record = snapshot.data() + offset;
+            std::string_view compact = peer.compact();
+            record[0] = static_cast<char>(compact.size());
+            std::memcpy(record + 1, compact.data(), compact.size());
+
+            const uint32_t fields[CACHE_FIELD_COUNT] = {
+                quality.connects, quality.connectFailures, quality.consecutiveFailures,
+                quality.handshakes, quality.handshakeFailures, quality.hashFailures,
+                quality.connectMillis, quality.bytesPerSecond, quality.lastUpdated};
+            char *out = record + 1 + PeerEndpoint::COMPACT_V6_SIZE;
+            for (uint32_t field : fields)
+            {
+                writeU32(out, field);
+                out += 4;
+            }
+            count++;
+        }
+    }
+    writeU32(snapshot.data() + 5, count);
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+        file.write(snapshot.data(), static_cast<std::streamsize>(snapshot.size()));
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+/*!
+    \brief Read the cache file, skipping expired or malformed records.
+    \return False if the file is missing or malformed.
+*/
+bool PeerQualityCache::load()
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::vector<char> snapshot((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (snapshot.size() < CACHE_HEADER_SIZE ||
+        std::memcmp(snapshot.data(), CACHE_MAGIC, 4) != 0 ||
+        snapshot[4] != CACHE_VERSION)
+    {
+        return false;
+    }
+
+    uint32_t count = readU32(snapshot.data() + 5);
+    if (snapshot.size() != CACHE_HEADER_SIZE + static_cast<size_t>(count) * CACHE_RECORD_SIZE)
+    {
+        return false;
+    }
+
+    uint32_t oldest = unixNow() - static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(ENTRY_TTL).count());
+    std::vector<std::pair<PeerEndpoint, PeerQuality>> loaded;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const char *record = snapshot.data() + CACHE_HEADER_SIZE + static_cast<size_t>(i) * CACHE_RECORD_SIZE;
+        PeerEndpoint peer = PeerEndpoint::fromCompact(std::string_view(record + 1, static_cast<uint8_t>(record[0])));
+        if (!peer.isValid())
+        {
+            continue;
+        }
+
+        uint32_t fields[CACHE_FIELD_COUNT];
+        const char *in = record + 1 + PeerEndpoint::COMPACT_V6_SIZE;
+        for (uint32_t &field : fields)
+        {
+            field = readU32(in);
+            in += 4;
+        }
+        PeerQuality quality{fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], fields[6], fields[7], fields[8]};
+        if (quality.lastUpdated >= oldest)
+        {
+            loaded.emplace_back(peer, quality);
+        }
+    }
+
+    //* Rebuild the recency order from the timestamps, keeping the freshest records if the file holds too many
+    std::stable_sort(loaded.begin(), loaded.end(), [](const auto &a, const auto &b)
+                     { return a.second.lastUpdated > b.second.lastUpdated; });
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &[peer, quality] : loaded)
+    {
+        if (entries.size() >= MAX_ENTRIES)
+        {
+            break;
+        }
+        if (entries.find(peer) == entries.end())
+        {
+            recency.push_back(peer);
+            entries.emplace(peer, Entry{quality, std::prev(recency.end())});
+        }
+    }
+    return true;
+}
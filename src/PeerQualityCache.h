@@ -0,0 +1,157 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerQualityCache.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 20:41:52
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PEER_QUALITY_CACHE_H
+#define PEER_QUALITY_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include "PeerEndpoint.h"
+
+/*!
+    \brief What we have learned about one peer across runs.
+*/
+struct PeerQuality
+{
+    uint32_t connects = 0;            //!> Successful connects.
+    uint32_t connectFailures = 0;     //!> Failed connects.
+    uint32_t consecutiveFailures = 0; //!> Failed connects or handshakes since the last success.
+    uint32_t handshakes = 0;          //!> Successful handshakes.
+    uint32_t handshakeFailures = 0;   //!> Failed handshakes.
+    uint32_t hashFailures = 0;        //!> Pieces from this peer that failed verification.
+    uint32_t connectMillis = 0;       //!> Smoothed connect latency.
+    uint32_t bytesPerSecond = 0;      //!> Smoothed download rate.
+    uint32_t lastUpdated = 0;         //!> Unix time of the last outcome.
+};
+
+/*!
+    \brief Small on-disk cache of per-peer outcomes, used to order and prune connect candidates.
+    Peers that delivered data come first (fastest first, then lowest latency), unknown peers keep
+    their discovery order after them, peers with recent failures go last, and peers that keep
+    failing or send corrupt data are dropped. Entries older than ENTRY_TTL are forgotten so a
+    peer gets another chance eventually. Thread-safe.
+*/
+class PeerQualityCache
+{
+public:
+    static constexpr size_t MAX_ENTRIES = 8192;            //!> Peers remembered; the least recently updated are evicted.
+    static constexpr std::chrono::hours ENTRY_TTL{24 * 7}; //!> How long an outcome is remembered.
+    static constexpr uint32_t DEAD_AFTER_FAILURES = 3;     //!> Consecutive failures that prune a peer.
+    static constexpr uint32_t MAX_HASH_FAILURES = 2;       //!> Corrupt pieces that prune a peer.
+
+    /*!
+        \brief Creates a cache backed by a file, loading it if present.
+        \param path The cache file.
+    */
+    explicit PeerQualityCache(const std::string &path);
+
+    /*!
+        \brief Saves the cache.
+    */
+    ~PeerQualityCache();
+
+    PeerQualityCache(const PeerQualityCache &) = delete;
+    PeerQualityCache &operator=(const PeerQualityCache &) = delete;
+
+    /*!
+        \brief The process-wide cache, created on first use. Downloads save it as they finish,
+        and it is saved again at exit.
+        \return The shared cache.
+    */
+    static PeerQualityCache &shared();
+
+    /*!
+        \brief Record a connect attempt.
+        \param peer The peer.
+        \param succeeded True if the TCP connection opened.
+        \param latency Time the attempt took.
+    */
+    void recordConnect(const PeerEndpoint &peer, bool succeeded, std::chrono::milliseconds latency);
+
+    /*!
+        \brief Record a handshake outcome.
+        \param peer The peer.
+        \param succeeded True if the peer answered with a valid handshake.
+    */
+    void recordHandshake(const PeerEndpoint &peer, bool succeeded);
+
+    /*!
+        \brief Record data received from a peer.
+        \param peer The peer.
+        \param bytes Bytes received.
+        \param elapsed Time it took.
+    */
+    void recordTransfer(const PeerEndpoint &peer, uint64_t bytes, std::chrono::milliseconds elapsed);
+
+    /*!
+        \brief Record that a piece from a peer failed its hash check.
+        \param peer The peer.
+    */
+    void recordHashFailure(const PeerEndpoint &peer);
+
+    /*!
+        \brief Get what is known about a peer.
+        \param peer The peer.
+        \param quality Receives the record.
+        \return False if the peer is unknown.
+    */
+    bool lookup(const PeerEndpoint &peer, PeerQuality &quality) const;
+
+    /*!
+        \brief Order candidates best first and drop known-bad ones.
+        \param peers The candidates, in discovery order; reordered in place.
+        \return Number of candidates dropped.
+    */
+    size_t rank(std::vector<PeerEndpoint> &peers) const;
+
+    /*!
+        \brief Work out the ranked order of candidates without moving them.
+        \param peers The candidates, in discovery order.
+        \return Indices into peers, best first, with known-bad peers left out.
+    */
+    std::vector<size_t> rankOrder(const std::vector<PeerEndpoint> &peers) const;
+
+    /*!
+        \brief Write the cache to its file (temporary file and rename).
+        \return False if the file could not be written.
+    */
+    bool save() const;
+
+private:
+    struct EndpointHasher
+    {
+        size_t operator()(const PeerEndpoint &peer) const { return peer.hash(); }
+    };
+
+    struct Entry
+    {
+        PeerQuality quality;                    //!> The record.
+        std::list<PeerEndpoint>::iterator seen; //!> Position in recency.
+    };
+
+    std::string path;                                                //!> Backing file.
+    mutable std::mutex mutex;                                        //!> Guards entries and recency.
+    std::unordered_map<PeerEndpoint, Entry, EndpointHasher> entries; //!> Records by endpoint.
+    std::list<PeerEndpoint> recency;                                 //!> Endpoints, most recently updated first.
+
+    PeerQuality &touch(const PeerEndpoint &peer);
+    bool load();
+
+    static uint32_t unixNow();
+};
+
+#endif
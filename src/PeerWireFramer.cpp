@@ -0,0 +1,423 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerWireFramer.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 21:38:47
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PeerWireFramer.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/uio.h>
+#include <cerrno>
+#endif
+
+#define RING_MASK (PeerWireFramer::RING_SIZE - 1)
+
+/*!
+    \brief A complete message other than piece; decodes it into the typed callbacks.
+    \param id The message ID.
+    \param payload The bytes after the ID; only valid during the call.
+*/
+void PeerWireHandler::onMessage(uint8_t id, std::string_view payload)
+{
+    switch (static_cast<PeerMessageId>(id))
+    {
+    case PeerMessageId::Choke:
+        onChoke();
+        return;
+    case PeerMessageId::Unchoke:
+        onUnchoke();
+        return;
+    case PeerMessageId::Interested:
+        onInterested();
+        return;
+    case PeerMessageId::NotInterested:
+        onNotInterested();
+        return;
+    case PeerMessageId::Have:
+        if (payload.size() == 4)
+        {
+            onHave(PeerWireFramer::readU32(payload.data()));
+            return;
+        }
+        break;
+    case PeerMessageId::Bitfield:
+        onBitfield(payload);
+        return;
+    case PeerMessageId::HaveAll:
+        onHaveAll();
+        return;
+    case PeerMessageId::HaveNone:
+        onHaveNone();
+        return;
+    case PeerMessageId::Request:
+    case PeerMessageId::Cancel:
+    case PeerMessageId::RejectRequest:
+        if (payload.size() == 12)
+        {
+            uint32_t piece = PeerWireFramer::readU32(payload.data());
+            uint32_t begin = PeerWireFramer::readU32(payload.data() + 4);
+            uint32_t blockLength = PeerWireFramer::readU32(payload.data() + 8);
+            if (id == static_cast<uint8_t>(PeerMessageId::Request))
+            {
+                onRequest(piece, begin, blockLength);
+            }
+            else if (id == static_cast<uint8_t>(PeerMessageId::Cancel))
+            {
+                onCancel(piece, begin, blockLength);
+            }
+            else
+            {
+                onReject(piece, begin, blockLength);
+            }
+            return;
+        }
+        break;
+    case PeerMessageId::Extended:
+        if (!payload.empty())
+        {
+            onExtended(payload);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    onUnknown(id, payload);
+}
+
+/*!
+    \brief Where to put the data of an incoming piece message; by default nowhere.
+    \param piece Piece index.
+    \param begin Offset within the piece.
+    \param length Block length.
+    \return nullptr, so the data is discarded.
+*/
+char *PeerWireHandler::blockBuffer(uint32_t piece, uint32_t begin, uint32_t length)
+{
+    (void)piece;
+    (void)begin;
+    (void)length;
+    return nullptr;
+}
+
+/*!
+    \brief A piece message has been fully received.
+    \param piece Piece index.
+    \param begin Offset within the piece.
+    \param length Block length.
+    \param stored True if the data went into the blockBuffer() buffer.
+*/
+void PeerWireHandler::onPiece(uint32_t piece, uint32_t begin, uint32_t length, bool stored)
+{
+    (void)piece;
+    (void)begin;
+    (void)length;
+    (void)stored;
+}
+
+/*!
+    \brief Peer requests a block.
+    \param piece Piece index.
+    \param begin Offset within the piece.
+    \param length Block length.
+*/
+void PeerWireHandler::onRequest(uint32_t piece, uint32_t begin, uint32_t length)
+{
+    (void)piece;
+    (void)begin;
+    (void)length;
+}
+
+/*!
+    \brief Peer withdraws a request.
+    \param piece Piece index.
+    \param begin Offset within the piece.
+    \param length Block length.
+*/
+void PeerWireHandler::onCancel(uint32_t piece, uint32_t begin, uint32_t length)
+{
+    (void)piece;
+    (void)begin;
+    (void)length;
+}
+
+/*!
+    \brief Peer will not serve a request (BEP 6).
+    \param piece Piece index.
+    \param begin Offset within the piece.
+    \param length Block length.
+*/
+void PeerWireHandler::onReject(uint32_t piece, uint32_t begin, uint32_t length)
+{
+    (void)piece;
+    (void)begin;
+    (void)length;
+}
+
+/*!
+    \brief A message with an unknown ID, or a known one with the wrong payload size.
+    \param id The message ID.
+    \param payload The bytes after the ID.
+*/
+void PeerWireHandler::onUnknown(uint8_t id, std::string_view payload)
+{
+    (void)id;
+    (void)payload;
+}
+
+/*!
+    \brief Creates an empty framer.
+*/
+PeerWireFramer::PeerWireFramer() : ring(RING_SIZE) {}
+
+/*!
+    \brief Read a big-endian u32.
+    \param data Pointer to 4 bytes.
+    \return The value.
+*/
+uint32_t PeerWireFramer::readU32(const char *data)
+{
+    return (static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(data[3]));
+}
+
+/*!
+    \brief Write a big-endian u32.
+    \param out Destination for 4 bytes.
+    \param value The value.
+*/
+void PeerWireFramer::writeU32(char *out, uint32_t value)
+{
+    out[0] = static_cast<char>(value >> 24);
+    out[1] = static_cast<char>(value >> 16);
+    out[2] = static_cast<char>(value >> 8);
+    out[3] = static_cast<char>(value);
+}
+
+/*!
+    \brief Move buffered bytes out of the ring.
+    \param out Destination, or nullptr to skip the bytes.
+    \param size Most bytes to take.
+    \return Bytes taken.
+*/
+size_t PeerWireFramer::take(char *out, size_t size)
+{
+    size_t count = std::min(size, tail - head);
+    if (out != nullptr)
+    {
+        size_t start = head & RING_MASK;
+        size_t first = std::min(count, RING_SIZE - start);
+        std::memcpy(out, ring.data() + start, first);
+        std::memcpy(out + first, ring.data(), count - first);
+    }
+    head += count;
+    return count;
+}
+
+/*!
+    \brief Collect a fixed-size header from the ring.
+    \param size Header size (at most 8).
+    \return True once all of it has been collected.
+*/
+bool PeerWireFramer::gather(size_t size)
+{
+    headerSize += take(header + headerSize, size - headerSize);
+    if (headerSize < size)
+    {
+        return false;
+    }
+    headerSize = 0;
+    return true;
+}
+
+/*!
+    \brief Stop writing the block in progress into its buffer.
+*/
+void PeerWireFramer::discardBlock()
+{
+    if (state == State::Block)
+    {
+        state = State::Discard;
+        block = nullptr;
+    }
+}
+
+/*!
+    \brief Read whatever the socket has with one scatter read.
+    \param socket The connected socket.
+    \return False if the peer closed the connection.
+    \throws std::runtime_error if the read fails.
+*/
+bool PeerWireFramer::fill(SocketHandle socket)
+{
+    //* Mid-block, the block's own buffer comes first so its data lands in place
+    size_t direct = state == State::Block ? blockLength - blockReceived : 0;
+    size_t space = RING_SIZE - (tail - head);
+    size_t start = tail & RING_MASK;
+    size_t first = std::min(space, RING_SIZE - start);
+
+#ifdef _WIN32
+    WSABUF buffers[3];
+    DWORD count = 0;
+    if (direct > 0)
+    {
+        buffers[count++] = {static_cast<ULONG>(direct), block + blockReceived};
+    }
+    if (first > 0)
+    {
+        buffers[count++] = {static_cast<ULONG>(first), ring.data() + start};
+    }
+    if (space > first)
+    {
+        buffers[count++] = {static_cast<ULONG>(space - first), ring.data()};
+    }
+    DWORD received = 0;
+    DWORD flags = 0;
+    if (WSARecv(socket, buffers, count, &received, &flags, nullptr, nullptr) == SOCKET_ERROR)
+    {
+        throw std::runtime_error("Failed to receive from peer");
+    }
+    size_t result = received;
+#else
+    iovec buffers[3];
+    int count = 0;
+    if (direct > 0)
+    {
+        buffers[count++] = {block + blockReceived, direct};
+    }
+    if (first > 0)
+    {
+        buffers[count++] = {ring.data() + start, first};
+    }
+    if (space > first)
+    {
+        buffers[count++] = {ring.data(), space - first};
+    }
+    ssize_t received;
+    do
+    {
+        received = readv(socket, buffers, count);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0)
+    {
+        throw std::runtime_error("Failed to receive from peer");
+    }
+    size_t result = static_cast<size_t>(received);
+#endif
+
+    if (result == 0)
+    {
+        return false;
+    }
+    size_t toBlock = std::min(result, direct);
+    blockReceived += toBlock;
+    tail += result - toBlock;
+    return true;
+}
+
+/*!
+    \brief Deliver the next complete message from the bytes read so far.
+    \param handler Receives the message.
+    \return True if a message was delivered, false if more bytes are needed.
+    \throws std::runtime_error if the peer sent an oversized or malformed frame.
+*/
+bool PeerWireFramer::dispatch(PeerWireHandler &handler)
+{
+    while (true)
+    {
+        switch (state)
+        {
+        case State::Length:
+            if (!gather(4))
+            {
+                return false;
+            }
+            length = readU32(header);
+            if (length == 0)
+            {
+                handler.onKeepAlive();
+                return true;
+            }
+            if (length > MAX_MESSAGE_SIZE)
+            {
+                throw std::runtime_error("Peer sent an oversized message");
+            }
+            state = State::Id;
+            break;
+
+        case State::Id:
+            if (!gather(1))
+            {
+                return false;
+            }
+            id = static_cast<uint8_t>(header[0]);
+            if (id == static_cast<uint8_t>(PeerMessageId::Piece))
+            {
+                if (length < 9)
+                {
+                    throw std::runtime_error("Peer sent a truncated piece message");
+                }
+                state = State::PieceHeader;
+            }
+            else
+            {
+                payload.resize(length - 1);
+                blockReceived = 0;
+                state = State::Payload;
+            }
+            break;
+
+        case State::PieceHeader:
+            if (!gather(8))
+            {
+                return false;
+            }
+            blockPiece = readU32(header);
+            blockBegin = readU32(header + 4);
+            blockLength = length - 9;
+            blockReceived = 0;
+            block = handler.blockBuffer(blockPiece, blockBegin, blockLength);
+            state = block != nullptr ? State::Block : State::Discard;
+            break;
+
+        case State::Block:
+        case State::Discard:
+            blockReceived += take(state == State::Block ? block + blockReceived : nullptr, blockLength - blockReceived);
+            if (blockReceived < blockLength)
+            {
+                return false;
+            }
+            {
+                bool stored = state == State::Block;
+                state = State::Length;
+                block = nullptr;
+                handler.onPiece(blockPiece, blockBegin, blockLength, stored);
+            }
+            return true;
+
+        case State::Payload:
+            blockReceived += take(&payload[0] + blockReceived, payload.size() - blockReceived);
+            if (blockReceived < payload.size())
+            {
+                return false;
+            }
+            state = State::Length;
+            handler.onMessage(id, payload);
+            return true;
+        }
+    }
+}
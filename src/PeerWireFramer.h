@@ -0,0 +1,209 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PeerWireFramer.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 21:38:05
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PEER_WIRE_FRAMER_H
+#define PEER_WIRE_FRAMER_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief Peer wire message IDs (BEP 3, the BEP 6 fast extension messages we use, and BEP 10).
+*/
+enum class PeerMessageId : uint8_t
+{
+    Choke = 0,
+    Unchoke = 1,
+    Interested = 2,
+    NotInterested = 3,
+    Have = 4,
+    Bitfield = 5,
+    Request = 6,
+    Piece = 7,
+    Cancel = 8,
+    Port = 9,
+    HaveAll = 14,       //!> BEP 6 fast extension.
+    HaveNone = 15,      //!> BEP 6 fast extension.
+    RejectRequest = 16, //!> BEP 6 fast extension.
+    Extended = 20
+};
+
+/*!
+    \brief Receives decoded peer wire messages from a PeerWireFramer.
+    onMessage() decodes every non-piece message into the typed callbacks below; override it to
+    see raw payloads instead. Piece messages never pass through onMessage(): their data goes
+    into the buffer returned by blockBuffer() and onPiece() is called once it has all arrived.
+*/
+class PeerWireHandler
+{
+public:
+    virtual ~PeerWireHandler() = default;
+
+    /*!
+        \brief A complete message other than piece.
+        \param id The message ID.
+        \param payload The bytes after the ID; only valid during the call.
+    */
+    virtual void onMessage(uint8_t id, std::string_view payload);
+
+    /*!
+        \brief Where to put the data of an incoming piece message.
+        \param piece Piece index.
+        \param begin Offset within the piece.
+        \param length Block length.
+        \return A buffer of at least length bytes, or nullptr to discard the data.
+    */
+    virtual char *blockBuffer(uint32_t piece, uint32_t begin, uint32_t length);
+
+    /*!
+        \brief A piece message has been fully received.
+        \param piece Piece index.
+        \param begin Offset within the piece.
+        \param length Block length.
+        \param stored True if the data went into the blockBuffer() buffer, false if it was discarded.
+    */
+    virtual void onPiece(uint32_t piece, uint32_t begin, uint32_t length, bool stored);
+
+    virtual void onKeepAlive() {}                                            //!> Zero-length message.
+    virtual void onChoke() {}                                                //!> Peer stopped serving us.
+    virtual void onUnchoke() {}                                              //!> Peer will serve our requests.
+    virtual void onInterested() {}                                           //!> Peer wants our pieces.
+    virtual void onNotInterested() {}                                        //!> Peer no longer wants our pieces.
+    virtual void onHave(uint32_t piece) { (void)piece; }                     //!> Peer completed a piece.
+    virtual void onBitfield(std::string_view bits) { (void)bits; }           //!> Peer's pieces, high bit first.
+    virtual void onHaveAll() {}                                              //!> Peer is a seed (BEP 6).
+    virtual void onHaveNone() {}                                             //!> Peer has no pieces (BEP 6).
+    virtual void onRequest(uint32_t piece, uint32_t begin, uint32_t length); //!> Peer requests a block.
+    virtual void onCancel(uint32_t piece, uint32_t begin, uint32_t length);  //!> Peer withdraws a request.
+    virtual void onReject(uint32_t piece, uint32_t begin, uint32_t length);  //!> Peer will not serve a request (BEP 6).
+    virtual void onExtended(std::string_view payload) { (void)payload; }     //!> BEP 10 message (extended ID first).
+    virtual void onUnknown(uint8_t id, std::string_view payload);            //!> Anything else, or a malformed message.
+};
+
+/*!
+    \brief Splits a peer connection's byte stream into length-prefixed messages.
+    Bytes are read into a fixed ring buffer, one scatter read (readv / WSARecv) per fill().
+    While a piece message is being received the read targets the block's destination buffer
+    first and the ring second, so block data is written once by the kernel and never copied,
+    apart from whatever arrived in the same read as the piece header.
+*/
+class PeerWireFramer
+{
+public:
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+#else
+    using SocketHandle = int;
+#endif
+
+    static constexpr size_t RING_SIZE = 32 * 1024;        //!> Read-ahead buffer; a power of two.
+    static constexpr uint32_t MAX_MESSAGE_SIZE = 1 << 20; //!> Larger than any block or metadata message.
+
+    /*!
+        \brief Creates an empty framer.
+    */
+    PeerWireFramer();
+
+    /*!
+        \brief Read whatever the socket has (one call; blocks if the socket does and nothing is waiting).
+        \param socket The connected socket.
+        \return False if the peer closed the connection.
+        \throws std::runtime_error if the read fails.
+    */
+    bool fill(SocketHandle socket);
+
+    /*!
+        \brief Deliver the next complete message from the bytes read so far.
+        \param handler Receives the message.
+        \return True if a message was delivered, false if more bytes are needed.
+        \throws std::runtime_error if the peer sent an oversized or malformed frame.
+    */
+    bool dispatch(PeerWireHandler &handler);
+
+    /*!
+        \brief Number of bytes read ahead and not yet consumed.
+        \return The buffered byte count.
+    */
+    size_t buffered() const { return tail - head; }
+
+    /*!
+        \brief Check whether piece data is being written into a handler's block buffer.
+        \return True between blockBuffer() returning a buffer and the matching onPiece().
+    */
+    bool receivingBlock() const { return state == State::Block; }
+
+    /*!
+        \brief Check whether a particular block is being written into a handler's buffer.
+        \param piece Piece index.
+        \param begin Offset within the piece.
+        \return True if it is the block in progress.
+    */
+    bool receivingBlock(uint32_t piece, uint32_t begin) const { return state == State::Block && blockPiece == piece && blockBegin == begin; }
+
+    /*!
+        \brief Stop writing the block in progress into its buffer, so the buffer may be freed or
+        handed to someone else. The rest of its data is skipped and onPiece() reports it as not stored.
+    */
+    void discardBlock();
+
+    /*!
+        \brief Read a big-endian u32.
+        \param data Pointer to 4 bytes.
+        \return The value.
+    */
+    static uint32_t readU32(const char *data);
+
+    /*!
+        \brief Write a big-endian u32.
+        \param out Destination for 4 bytes.
+        \param value The value.
+    */
+    static void writeU32(char *out, uint32_t value);
+
+private:
+    enum class State : uint8_t
+    {
+        Length,      //!> Reading the 4-byte length prefix.
+        Id,          //!> Reading the message ID.
+        PieceHeader, //!> Reading a piece message's index and offset.
+        Block,       //!> Receiving piece data into the handler's buffer.
+        Discard,     //!> Skipping piece data nobody wants.
+        Payload      //!> Collecting any other message's payload.
+    };
+
+    std::vector<char> ring;      //!> RING_SIZE bytes of read-ahead.
+    size_t head = 0;             //!> Consumed byte count (ring index is head mod RING_SIZE).
+    size_t tail = 0;             //!> Received byte count.
+    State state = State::Length; //!> Parser position.
+    char header[8];              //!> Length prefix, ID or piece header being assembled.
+    size_t headerSize = 0;       //!> Bytes of header collected.
+    uint32_t length = 0;         //!> Current message length (ID included).
+    uint8_t id = 0;              //!> Current message ID.
+    uint32_t blockPiece = 0;     //!> Piece message: piece index.
+    uint32_t blockBegin = 0;     //!> Piece message: offset.
+    uint32_t blockLength = 0;    //!> Piece message: data length.
+    char *block = nullptr;       //!> Piece message: destination.
+    size_t blockReceived = 0;    //!> Bytes of the current block or payload received.
+    std::string payload;         //!> Non-piece payload being collected (reused).
+
+    bool gather(size_t size);
+    size_t take(char *out, size_t size);
+};
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PieceAvailability.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 23:14:02
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PieceAvailability.h"
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+/*!
+    \brief Creates an empty set.
+    \param size Number of pieces in the torrent (0 if not known yet).
+*/
+PieceBitfield::PieceBitfield(size_t size) : bytes((size + 7) / 8, 0), bits(size) {}
+
+/*!
+    \brief Replace the contents with a bitfield message payload.
+    \param payload The payload.
+    \return False if the payload has the wrong length for the piece count.
+*/
+bool PieceBitfield::assign(std::string_view payload)
+{
+    if (bits == 0)
+    {
+        bits = payload.size() * 8;
+    }
+    if (payload.size() != (bits + 7) / 8)
+    {
+        return false;
+    }
+
+    bytes.assign(payload.begin(), payload.end());
+    if (bits % 8 != 0)
+    {
+        bytes.back() &= static_cast<uint8_t>(0xFF << (8 - bits % 8)); //!> Spare bits should be 0; ignore them if not
+    }
+
+    present = 0;
+    for (uint8_t byte : bytes)
+    {
+        present += std::bitset<8>(byte).count();
+    }
+    return true;
+}
+
+/*!
+    \brief Add a piece.
+    \param piece The piece index.
+    \return False if it was out of range or already present.
+*/
+bool PieceBitfield::set(uint32_t piece)
+{
+    if (piece >= bits || has(piece))
+    {
+        return false;
+    }
+    bytes[piece >> 3] |= static_cast<uint8_t>(0x80 >> (piece & 7));
+    present++;
+    return true;
+}
+
+/*!
+    \brief Add every piece.
+*/
+void PieceBitfield::setAll()
+{
+    std::memset(bytes.data(), 0xFF, bytes.size());
+    if (bits % 8 != 0)
+    {
+        bytes.back() = static_cast<uint8_t>(0xFF << (8 - bits % 8));
+    }
+    present = bits;
+}
+
+/*!
+    \brief Remove every piece.
+*/
+void PieceBitfield::clear()
+{
+    std::memset(bytes.data(), 0, bytes.size());
+    present = 0;
+}
+
+/*!
+    \brief Creates all-zero counts.
+    \param pieceCount Number of pieces in the torrent.
+*/
+PieceAvailability::PieceAvailability(size_t pieceCount) : counts(pieceCount, 0) {}
+
+/*!
+    \brief Add or subtract one for every piece in a bitfield.
+    \param pieces The bitfield.
+    \param delta +1 or -1.
+*/
+void PieceAvailability::apply(const PieceBitfield &pieces, int delta)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::vector<uint8_t> &bytes = pieces.data();
+    size_t limit = std::min(pieces.size(), counts.size());
+    for (size_t i = 0; i * 8 < limit; ++i)
+    {
+        if (bytes[i] == 0)
+        {
+            continue; //!> Most of a new peer's bitfield, so skip it a byte at a time
+        }
+        for (size_t piece = i * 8; piece < i * 8 + 8 && piece < limit; ++piece)
+        {
+            if (pieces.has(static_cast<uint32_t>(piece)))
+            {
+                counts[piece] += static_cast<uint32_t>(delta);
+            }
+        }
+    }
+}
+
+/*!
+    \brief Count a peer's pieces.
+    \param pieces The peer's bitfield.
+*/
+void PieceAvailability::add(const PieceBitfield &pieces)
+{
+    apply(pieces, 1);
+}
+
+/*!
+    \brief Count one piece a peer just announced.
+    \param piece The piece index.
+*/
+void PieceAvailability::add(uint32_t piece)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (piece < counts.size())
+    {
+        counts[piece]++;
+    }
+}
+
+/*!
+    \brief Stop counting a peer's pieces.
+    \param pieces The bitfield that was added.
+*/
+void PieceAvailability::remove(const PieceBitfield &pieces)
+{
+    apply(pieces, -1);
+}
+
+/*!
+    \brief Number of connected peers that have a piece.
+    \param piece The piece index.
+    \return The count (0 if out of range).
+*/
+uint32_t PieceAvailability::count(uint32_t piece) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return piece < counts.size() ? counts[piece] : 0;
+}
+
+/*!
+    \brief Copy of every count.
+    \return One count per piece.
+*/
+std::vector<uint32_t> PieceAvailability::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counts;
+}
@@ -0,0 +1,128 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PieceAvailability.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 23:12:37
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PIECE_AVAILABILITY_H
+#define PIECE_AVAILABILITY_H
+
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief A set of pieces, stored in the bitfield wire format (high bit of byte 0 is piece 0).
+*/
+class PieceBitfield
+{
+public:
+    /*!
+        \brief Creates an empty set.
+        \param size Number of pieces in the torrent (0 if not known yet).
+    */
+    explicit PieceBitfield(size_t size = 0);
+
+    /*!
+        \brief Replace the contents with a bitfield message payload.
+        If the piece count is not known yet it is taken from the payload.
+        \param payload The payload.
+        \return False if the payload has the wrong length for the piece count.
+    */
+    bool assign(std::string_view payload);
+
+    /*!
+        \brief Add a piece.
+        \param piece The piece index.
+        \return False if it was out of range or already present.
+    */
+    bool set(uint32_t piece);
+
+    void setAll(); //!> Add every piece.
+    void clear();  //!> Remove every piece.
+
+    /*!
+        \brief Check whether a piece is in the set.
+        \param piece The piece index.
+        \return True if present (false if out of range).
+    */
+    bool has(uint32_t piece) const { return piece < bits && (bytes[piece >> 3] & (0x80 >> (piece & 7))) != 0; }
+
+    size_t size() const { return bits; }                       //!> Number of pieces in the torrent.
+    size_t count() const { return present; }                   //!> Number of pieces in the set.
+    bool all() const { return bits > 0 && present == bits; }   //!> True if every piece is present.
+    const std::vector<uint8_t> &data() const { return bytes; } //!> The wire-format bytes.
+
+private:
+    std::vector<uint8_t> bytes; //!> ceil(bits / 8) bytes; spare low bits of the last byte stay 0.
+    size_t bits = 0;            //!> Piece count.
+    size_t present = 0;         //!> Set bits.
+};
+
+/*!
+    \brief How many connected peers have each piece.
+    Every session adds its peer's bitfield and haves and takes them back out when it closes,
+    so the counts always describe the current swarm. Thread-safe.
+*/
+class PieceAvailability
+{
+public:
+    /*!
+        \brief Creates all-zero counts.
+        \param pieceCount Number of pieces in the torrent.
+    */
+    explicit PieceAvailability(size_t pieceCount);
+
+    /*!
+        \brief Count a peer's pieces.
+        \param pieces The peer's bitfield.
+    */
+    void add(const PieceBitfield &pieces);
+
+    /*!
+        \brief Count one piece a peer just announced.
+        \param piece The piece index.
+    */
+    void add(uint32_t piece);
+
+    /*!
+        \brief Stop counting a peer's pieces (it disconnected or replaced its bitfield).
+        \param pieces The bitfield that was added.
+    */
+    void remove(const PieceBitfield &pieces);
+
+    /*!
+        \brief Number of connected peers that have a piece.
+        \param piece The piece index.
+        \return The count (0 if out of range).
+    */
+    uint32_t count(uint32_t piece) const;
+
+    /*!
+        \brief Copy of every count.
+        \return One count per piece.
+    */
+    std::vector<uint32_t> snapshot() const;
+
+    /*!
+        \brief Number of pieces tracked.
+        \return The piece count.
+    */
+    size_t size() const { return counts.size(); }
+
+private:
+    mutable std::mutex mutex;     //!> Guards counts.
+    std::vector<uint32_t> counts; //!> Peers per piece.
+
+    void apply(const PieceBitfield &pieces, int delta);
+};
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PiecePicker.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sun October 18th 2026 0:21:47
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "PiecePicker.h"
+#include <algorithm>
+#include <limits>
+
+/*!
+    \brief Creates a picker with every piece missing.
+    \param pieceCount Number of pieces.
+    \param pieceSize Length of every piece but the last.
+    \param totalSize Length of the torrent's data.
+*/
+PiecePicker::PiecePicker(size_t pieceCount, uint32_t pieceSize, uint64_t totalSize)
+    : pieceSize(pieceSize), totalSize(totalSize), states(pieceCount, PieceState::Missing), missing(pieceCount),
+      random(std::random_device{}()) {}
+
+/*!
+    \brief Length of a piece.
+    \param piece The piece index.
+    \return The piece size, shorter for the last piece.
+*/
+uint32_t PiecePicker::pieceLength(uint32_t piece) const
+{
+    uint64_t start = static_cast<uint64_t>(piece) * pieceSize;
+    return start >= totalSize ? 0 : static_cast<uint32_t>(std::min<uint64_t>(pieceSize, totalSize - start));
+}
+
+/*!
+    \brief Find the active piece and block slot a request refers to.
+    \param block The block.
+    \param index Receives the block's slot.
+    \return The piece, or nullptr if it is not active or the block does not line up with a slot.
+*/
+PiecePicker::ActivePiece *PiecePicker::findActive(const BlockRequest &block, size_t &index)
+{
+    return const_cast<ActivePiece *>(static_cast<const PiecePicker *>(this)->findActive(block, index));
+}
+
+/*!
+    \brief Find the active piece and block slot a request refers to.
+    \param block The block.
+    \param index Receives the block's slot.
+    \return The piece, or nullptr if it is not active or the block does not line up with a slot.
+*/
+const PiecePicker::ActivePiece *PiecePicker::findActive(const BlockRequest &block, size_t &index) const
+{
+    auto it = active.find(block.piece);
+    if (it == active.end() || block.begin % RequestPipeline::BLOCK_SIZE != 0)
+    {
+        return nullptr;
+    }
+    index = block.begin / RequestPipeline::BLOCK_SIZE;
+    uint32_t length = static_cast<uint32_t>(it->second.data.size());
+    if (index >= it->second.blocks.size() || block.length != std::min(RequestPipeline::BLOCK_SIZE, length - block.begin))
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+/*!
+    \brief Choose the rarest missing piece a peer has, breaking ties at random.
+    \param peerPieces The pieces the peer has.
+    \param counts Availability per piece.
+    \param piece Receives the piece index.
+    \return False if the peer has no missing piece.
+*/
+bool PiecePicker::startRarest(const PieceBitfield &peerPieces, const std::vector<uint32_t> &counts, uint32_t &piece)
+{
+    uint32_t rarest = std::numeric_limits<uint32_t>::max();
+    size_t ties = 0;
+    for (uint32_t i = 0; i < states.size(); ++i)
+    {
+        if (states[i] != PieceState::Missing || !peerPieces.has(i))
+        {
+            continue;
+        }
+        uint32_t count = i < counts.size() ? counts[i] : 0;
+        if (count < rarest)
+        {
+            rarest = count;
+            piece = i;
+            ties = 1;
+        }
+        else if (count == rarest && std::uniform_int_distribution<size_t>(0, ties++)(random) == 0)
+        {
+            piece = i; //!> Each of the n tied pieces ends up chosen with probability 1/n
+        }
+    }
+    return ties > 0;
+}
+
+/*!
+    \brief Choose blocks to request from a peer and record them as requested by it.
+    \param peer The peer.
+    \param peerPieces The pieces it has.
+    \param availability Swarm-wide piece counts, for rarest first.
+    \param count Most blocks to return.
+    \param out Receives the blocks.
+    \return Number of blocks added.
+*/
+size_t PiecePicker::pick(const PeerEndpoint &peer, const PieceBitfield &peerPieces, const PieceAvailability &availability,
+                         size_t count, std::vector<BlockRequest> &out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t added = 0;
+
+    auto takeOpen = [&](uint32_t index, ActivePiece &entry)
+    {
+        uint32_t length = static_cast<uint32_t>(entry.data.size());
+        for (size_t i = 0; i < entry.blocks.size() && added < count; ++i)
+        {
+            Block &block = entry.blocks[i];
+            if (block.received || block.receiving || !block.requesters.empty())
+            {
+                continue;
+            }
+            uint32_t begin = static_cast<uint32_t>(i) * RequestPipeline::BLOCK_SIZE;
+            block.requesters.push_back(peer);
+            openBlocks--;
+            out.push_back({index, begin, std::min(RequestPipeline::BLOCK_SIZE, length - begin)});
+            added++;
+        }
+    };
+
+    //* Finish what is already started, most complete piece first
+    std::vector<std::pair<size_t, uint32_t>> partial;
+    for (const auto &[index, entry] : active)
+    {
+        if (peerPieces.has(index))
+        {
+            partial.push_back({entry.received, index});
+        }
+    }
+    std::sort(partial.begin(), partial.end(), std::greater<std::pair<size_t, uint32_t>>());
+    for (size_t i = 0; i < partial.size() && added < count && openBlocks > 0; ++i)
+    {
+        takeOpen(partial[i].second, active[partial[i].second]);
+    }
+
+    //* Then start new pieces, rarest first
+    if (added < count && missing > 0)
+    {
+        std::vector<uint32_t> counts = availability.snapshot();
+        uint32_t piece;
+        while (added < count && startRarest(peerPieces, counts, piece))
+        {
+            uint32_t length = pieceLength(piece);
+            ActivePiece &entry = active[piece];
+            entry.data.resize(length);
+            entry.blocks.resize((length + RequestPipeline::BLOCK_SIZE - 1) / RequestPipeline::BLOCK_SIZE);
+            states[piece] = PieceState::Active;
+            missing--;
+            openBlocks += entry.blocks.size();
+            takeOpen(piece, entry);
+        }
+    }
+
+    //* Endgame: everything is requested, so ask this peer for blocks still in flight elsewhere
+    if (added < count && missing == 0 && openBlocks == 0)
+    {
+        for (auto &[index, entry] : active)
+        {
+            if (!peerPieces.has(index))
+            {
+                continue;
+            }
+            uint32_t length = static_cast<uint32_t>(entry.data.size());
+            for (size_t i = 0; i < entry.blocks.size() && added < count; ++i)
+            {
+                Block &block = entry.blocks[i];
+                if (block.received || block.receiving || block.requesters.size() >= MAX_REQUESTERS ||
+                    std::find(block.requesters.begin(), block.requesters.end(), peer) != block.requesters.end())
+                {
+                    continue;
+                }
+                uint32_t begin = static_cast<uint32_t>(i) * RequestPipeline::BLOCK_SIZE;
+                block.requesters.push_back(peer);
+                out.push_back({index, begin, std::min(RequestPipeline::BLOCK_SIZE, length - begin)});
+                added++;
+            }
+        }
+    }
+    return added;
+}
+
+/*!
+    \brief Claim an incoming block for a peer and get where its data goes.
+    \param peer The peer sending it.
+    \param block The block.
+    \return The destination, or nullptr if the block is not wanted or another peer is delivering it.
+*/
+char *PiecePicker::claim(const PeerEndpoint &peer, const BlockRequest &block)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index;
+    ActivePiece *entry = findActive(block, index);
+    if (entry == nullptr)
+    {
+        return nullptr;
+    }
+    Block &slot = entry->blocks[index];
+    if (slot.received || slot.receiving)
+    {
+        return nullptr;
+    }
+    if (slot.requesters.empty())
+    {
+        openBlocks--; //!> A late answer to a request made before the piece was restarted
+    }
+    slot.receiving = true;
+    slot.receiver = peer;
+    return entry->data.data() + block.begin;
+}
+
+/*!
+    \brief Record that a claimed block has fully arrived.
+    \param peer The peer that sent it.
+    \param block The block.
+    \return True if this completed its piece.
+*/
+bool PiecePicker::onReceived(const PeerEndpoint &peer, const BlockRequest &block)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index;
+    ActivePiece *entry = findActive(block, index);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    Block &slot = entry->blocks[index];
+    if (!slot.receiving || !(slot.receiver == peer))
+    {
+        return false;
+    }
+    slot.receiving = false;
+    slot.received = true;
+    slot.requesters.erase(std::remove(slot.requesters.begin(), slot.requesters.end(), peer), slot.requesters.end());
+    entry->received++;
+    if (std::find(entry->contributors.begin(), entry->contributors.end(), peer) == entry->contributors.end())
+    {
+        entry->contributors.push_back(peer);
+    }
+    return entry->received == entry->blocks.size();
+}
+
+/*!
+    \brief Forget a peer's request for a block, so the block can be requested again.
+    \param peer The peer.
+    \param block The block.
+*/
+void PiecePicker::release(const PeerEndpoint &peer, const BlockRequest &block)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index;
+    ActivePiece *entry = findActive(block, index);
+    if (entry == nullptr)
+    {
+        return;
+    }
+    Block &slot = entry->blocks[index];
+    bool wasOpen = slot.requesters.empty() && !slot.receiving && !slot.received;
+    slot.requesters.erase(std::remove(slot.requesters.begin(), slot.requesters.end(), peer), slot.requesters.end());
+    if (slot.receiving && slot.receiver == peer)
+    {
+        slot.receiving = false; //!> The connection failed part way through the block
+    }
+    if (!wasOpen && slot.requesters.empty() && !slot.receiving && !slot.received)
+    {
+        openBlocks++;
+    }
+}
+
+/*!
+    \brief Check whether a block still has to be received.
+    \param block The block.
+    \return False once any peer has delivered it.
+*/
+bool PiecePicker::isWanted(const BlockRequest &block) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index;
+    const ActivePiece *entry = findActive(block, index);
+    return entry != nullptr && !entry->blocks[index].received;
+}
+
+/*!
+    \brief Hand over a completed piece for verification.
+    \param piece The piece index.
+    \param data Receives the piece data.
+    \param contributors Receives every peer that sent part of it.
+    \return False if the piece is not complete.
+*/
+bool PiecePicker::takePiece(uint32_t piece, std::vector<char> &data, std::vector<PeerEndpoint> &contributors)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = active.find(piece);
+    if (it == active.end() || it->second.received < it->second.blocks.size())
+    {
+        return false;
+    }
+    data = std::move(it->second.data);
+    contributors = std::move(it->second.contributors);
+    active.erase(it);
+    states[piece] = PieceState::Verifying;
+    return true;
+}
+
+/*!
+    \brief Record the hash check of a piece from takePiece().
+    \param piece The piece index.
+    \param valid True if the hash matched; otherwise the piece is downloaded again.
+*/
+void PiecePicker::onVerified(uint32_t piece, bool valid)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (piece >= states.size() || states[piece] != PieceState::Verifying)
+    {
+        return;
+    }
+    if (valid)
+    {
+        states[piece] = PieceState::Have;
+        have++;
+    }
+    else
+    {
+        states[piece] = PieceState::Missing;
+        missing++;
+    }
+}
+
+/*!
+    \brief Check whether every piece has been verified.
+    \return True when the download is complete.
+*/
+bool PiecePicker::isComplete() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return have == states.size();
+}
+
+/*!
+    \brief Check whether every missing block has been requested.
+    \return True in endgame (and once everything has arrived).
+*/
+bool PiecePicker::inEndgame() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return missing == 0 && openBlocks == 0;
+}
+
+/*!
+    \brief Number of pieces not yet verified.
+    \return The count.
+*/
+size_t PiecePicker::piecesLeft() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return states.size() - have;
+}
@@ -0,0 +1,159 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\PiecePicker.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 23:58:20
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef PIECE_PICKER_H
+#define PIECE_PICKER_H
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+#include "PieceAvailability.h"
+#include "PeerEndpoint.h"
+#include "RequestPipeline.h"
+
+/*!
+    \brief Decides which blocks to request from which peer, and assembles the pieces.
+    Blocks of pieces already in progress come first, most complete piece first, so few partial
+    pieces are held in memory at once. New pieces are started rarest first by the availability
+    counts, with ties broken at random so peers with the same bitfield spread out over the swarm.
+    Once every missing block has been requested the picker enters endgame: the blocks still in
+    flight are handed to further peers as well (up to MAX_REQUESTERS per block), and whichever
+    copy arrives first wins; callers withdraw the others with isWanted(). Thread-safe.
+*/
+class PiecePicker
+{
+public:
+    static constexpr size_t MAX_REQUESTERS = 3; //!> Peers asked for the same block in endgame.
+
+    /*!
+        \brief Creates a picker with every piece missing.
+        \param pieceCount Number of pieces.
+        \param pieceSize Length of every piece but the last.
+        \param totalSize Length of the torrent's data.
+    */
+    PiecePicker(size_t pieceCount, uint32_t pieceSize, uint64_t totalSize);
+
+    /*!
+        \brief Choose blocks to request from a peer and record them as requested by it.
+        \param peer The peer.
+        \param peerPieces The pieces it has.
+        \param availability Swarm-wide piece counts, for rarest first.
+        \param count Most blocks to return.
+        \param out Receives the blocks.
+        \return Number of blocks added.
+    */
+    size_t pick(const PeerEndpoint &peer, const PieceBitfield &peerPieces, const PieceAvailability &availability,
+                size_t count, std::vector<BlockRequest> &out);
+
+    /*!
+        \brief Claim an incoming block for a peer and get where its data goes.
+        Only one copy of a block is received; in endgame the others are discarded.
+        \param peer The peer sending it.
+        \param block The block.
+        \return The destination, or nullptr if the block is not wanted (or another peer is delivering it).
+    */
+    char *claim(const PeerEndpoint &peer, const BlockRequest &block);
+
+    /*!
+        \brief Record that a claimed block has fully arrived.
+        \param peer The peer that sent it.
+        \param block The block.
+        \return True if this completed its piece (collect it with takePiece()).
+    */
+    bool onReceived(const PeerEndpoint &peer, const BlockRequest &block);
+
+    /*!
+        \brief Forget a peer's request for a block (rejected, timed out, cancelled or the connection
+        failed), so the block can be requested again.
+        \param peer The peer.
+        \param block The block.
+    */
+    void release(const PeerEndpoint &peer, const BlockRequest &block);
+
+    /*!
+        \brief Check whether a block still has to be received.
+        \param block The block.
+        \return False once any peer has delivered it.
+    */
+    bool isWanted(const BlockRequest &block) const;
+
+    /*!
+        \brief Hand over a completed piece for verification.
+        \param piece The piece index.
+        \param data Receives the piece data.
+        \param contributors Receives every peer that sent part of it.
+        \return False if the piece is not complete.
+    */
+    bool takePiece(uint32_t piece, std::vector<char> &data, std::vector<PeerEndpoint> &contributors);
+
+    /*!
+        \brief Record the hash check of a piece from takePiece(); a failed piece is downloaded again.
+        \param piece The piece index.
+        \param valid True if the hash matched.
+    */
+    void onVerified(uint32_t piece, bool valid);
+
+    /*!
+        \brief Length of a piece.
+        \param piece The piece index.
+        \return The piece size, shorter for the last piece.
+    */
+    uint32_t pieceLength(uint32_t piece) const;
+
+    bool isComplete() const;   //!> True once every piece has been verified.
+    bool inEndgame() const;    //!> True once every missing block has been requested (or received).
+    size_t piecesLeft() const; //!> Pieces not yet verified.
+
+private:
+    enum class PieceState : uint8_t
+    {
+        Missing,   //!> Not started.
+        Active,    //!> Blocks being requested and received.
+        Verifying, //!> Complete, handed out by takePiece().
+        Have       //!> Verified.
+    };
+
+    struct Block
+    {
+        std::vector<PeerEndpoint> requesters; //!> Peers with a request out for it.
+        PeerEndpoint receiver;                //!> Peer whose copy is arriving (if receiving).
+        bool receiving = false;               //!> Data is being written into the piece buffer.
+        bool received = false;                //!> Data is complete.
+    };
+
+    struct ActivePiece
+    {
+        std::vector<char> data;                 //!> Piece buffer.
+        std::vector<Block> blocks;              //!> One per BLOCK_SIZE.
+        size_t received = 0;                    //!> Blocks complete.
+        std::vector<PeerEndpoint> contributors; //!> Peers that sent blocks.
+    };
+
+    mutable std::mutex mutex;                         //!> Guards everything below.
+    uint32_t pieceSize;                               //!> Length of every piece but the last.
+    uint64_t totalSize;                               //!> Length of the torrent's data.
+    std::vector<PieceState> states;                   //!> Per piece.
+    std::unordered_map<uint32_t, ActivePiece> active; //!> Pieces in progress.
+    size_t missing;                                   //!> Pieces in the Missing state.
+    size_t openBlocks = 0;                            //!> Blocks of active pieces nobody has requested or sent.
+    size_t have = 0;                                  //!> Pieces verified.
+    std::mt19937 random;                              //!> Tie-breaker for rarest first.
+
+    ActivePiece *findActive(const BlockRequest &block, size_t &index);
+    const ActivePiece *findActive(const BlockRequest &block, size_t &index) const;
+    bool startRarest(const PieceBitfield &peerPieces, const std::vector<uint32_t> &counts, uint32_t &piece);
+};
+
+#endif
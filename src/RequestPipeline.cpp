@@ -0,0 +1,175 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\RequestPipeline.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 22:05:12
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "RequestPipeline.h"
+#include <algorithm>
+#include <cmath>
+
+/*!
+    \brief Number of further requests that may be sent now.
+    \return Target depth minus outstanding requests (0 if full).
+*/
+size_t RequestPipeline::room() const
+{
+    size_t target = depth();
+    return queue.size() >= target ? 0 : target - queue.size();
+}
+
+/*!
+    \brief Current request timeout: three average block latencies, within bounds.
+    \return The timeout.
+*/
+std::chrono::milliseconds RequestPipeline::timeout() const
+{
+    auto scaled = std::chrono::duration_cast<std::chrono::milliseconds>(smoothedLatency * 3);
+    return std::clamp(scaled, MIN_TIMEOUT, MAX_TIMEOUT);
+}
+
+/*!
+    \brief Record that a request was sent.
+    \param request The block requested.
+    \param now Send time.
+*/
+void RequestPipeline::onSent(const BlockRequest &request, Clock::time_point now)
+{
+    if (queue.empty())
+    {
+        windowStart = now; //!> Idle time says nothing about the link
+        windowBytes = 0;
+    }
+    queue.push_back({request, now});
+}
+
+/*!
+    \brief Check whether a block is still awaited on this connection.
+    \param block The block.
+    \return True if it was requested and has not arrived, expired or been rejected.
+*/
+bool RequestPipeline::isOutstanding(const BlockRequest &block) const
+{
+    return std::any_of(queue.begin(), queue.end(), [&block](const Outstanding &entry)
+                       { return entry.request == block; });
+}
+
+/*!
+    \brief Record that a block arrived, updating the rate, latency and target depth.
+    \param block The block.
+    \param now Arrival time.
+    \return False if it was not outstanding.
+*/
+bool RequestPipeline::onReceived(const BlockRequest &block, Clock::time_point now)
+{
+    auto it = std::find_if(queue.begin(), queue.end(), [&block](const Outstanding &entry)
+                           { return entry.request == block; });
+    if (it == queue.end())
+    {
+        return false;
+    }
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - it->sentAt);
+    queue.erase(it);
+
+    smoothedLatency = smoothedLatency.count() == 0 ? latency : (smoothedLatency * 7 + latency) / 8;
+    if (minLatency.count() == 0 || latency <= minLatency || now - minLatencyAt > LATENCY_MEMORY)
+    {
+        minLatency = latency;
+        minLatencyAt = now;
+    }
+
+    windowBytes += block.length;
+    auto elapsed = now - windowStart;
+    if (elapsed >= RATE_WINDOW)
+    {
+        double sample = static_cast<double>(windowBytes) / std::chrono::duration<double>(elapsed).count();
+        rate = rate == 0.0 ? sample : rate * 0.75 + sample * 0.25;
+        windowStart = now;
+        windowBytes = 0;
+    }
+
+    if (rate == 0.0)
+    {
+        targetDepth += 1.0; //!> Slow start until the first rate sample
+    }
+    else
+    {
+        double product = rate * std::chrono::duration<double>(minLatency).count();
+        targetDepth = std::ceil(product * HEADROOM / BLOCK_SIZE) + 1.0;
+    }
+    targetDepth = std::clamp(targetDepth, static_cast<double>(MIN_DEPTH), static_cast<double>(MAX_DEPTH));
+    return true;
+}
+
+/*!
+    \brief Record that the peer rejected a request (BEP 6).
+    \param block The block.
+    \return False if it was not outstanding.
+*/
+bool RequestPipeline::onRejected(const BlockRequest &block)
+{
+    auto it = std::find_if(queue.begin(), queue.end(), [&block](const Outstanding &entry)
+                           { return entry.request == block; });
+    if (it == queue.end())
+    {
+        return false;
+    }
+    queue.erase(it);
+    return true;
+}
+
+/*!
+    \brief Remove requests that have waited longer than timeout(), halving the target depth.
+    \param now Current time.
+    \param timedOut Receives the expired requests, to be sent elsewhere.
+    \return Number expired.
+*/
+size_t RequestPipeline::expire(Clock::time_point now, std::vector<BlockRequest> &timedOut)
+{
+    auto limit = timeout();
+    size_t expired = 0;
+    while (!queue.empty() && now - queue.front().sentAt >= limit)
+    {
+        timedOut.push_back(queue.front().request);
+        queue.pop_front();
+        expired++;
+    }
+    if (expired > 0)
+    {
+        targetDepth = std::max(static_cast<double>(MIN_DEPTH), std::floor(targetDepth / 2));
+    }
+    return expired;
+}
+
+/*!
+    \brief Remove every outstanding request.
+    \param abandoned Receives the requests.
+*/
+void RequestPipeline::clear(std::vector<BlockRequest> &abandoned)
+{
+    for (const Outstanding &entry : queue)
+    {
+        abandoned.push_back(entry.request);
+    }
+    queue.clear();
+}
+
+/*!
+    \brief When the oldest outstanding request times out.
+    \return The deadline, or Clock::time_point::max() if nothing is outstanding.
+*/
+RequestPipeline::Clock::time_point RequestPipeline::nextDeadline() const
+{
+    if (queue.empty())
+    {
+        return Clock::time_point::max();
+    }
+    return queue.front().sentAt + timeout();
+}
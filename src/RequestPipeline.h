@@ -0,0 +1,162 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\RequestPipeline.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 22:04:36
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef REQUEST_PIPELINE_H
+#define REQUEST_PIPELINE_H
+
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief One block of a piece, as named by request, piece, reject and cancel messages.
+*/
+struct BlockRequest
+{
+    uint32_t piece;  //!> Piece index.
+    uint32_t begin;  //!> Offset within the piece.
+    uint32_t length; //!> Block length.
+
+    bool operator==(const BlockRequest &other) const
+    {
+        return piece == other.piece && begin == other.begin && length == other.length;
+    }
+};
+
+/*!
+    \brief The block requests outstanding on one peer connection, and how many there should be.
+    The target depth tracks the bandwidth-delay product: the measured download rate times the
+    lowest block latency seen recently, with headroom so the rate can keep growing until the
+    link (not the pipeline) is the limit. New connections start at INITIAL_DEPTH and grow by one
+    request per block received until a rate has been measured. A timeout halves the depth.
+*/
+class RequestPipeline
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t BLOCK_SIZE = 16 * 1024;                 //!> Standard request size.
+    static constexpr size_t INITIAL_DEPTH = 4;                        //!> Requests in flight before anything is measured.
+    static constexpr size_t MIN_DEPTH = 2;                            //!> Floor after timeouts.
+    static constexpr size_t MAX_DEPTH = 250;                          //!> Most peers drop requests beyond ~250.
+    static constexpr double HEADROOM = 1.5;                           //!> Depth relative to the measured product.
+    static constexpr std::chrono::milliseconds RATE_WINDOW{1000};     //!> Rate sampling interval.
+    static constexpr std::chrono::milliseconds MIN_TIMEOUT{5000};     //!> Shortest request timeout.
+    static constexpr std::chrono::milliseconds MAX_TIMEOUT{30000};    //!> Longest request timeout.
+    static constexpr std::chrono::milliseconds LATENCY_MEMORY{10000}; //!> How long the lowest latency is trusted.
+
+    /*!
+        \brief Number of further requests that may be sent now.
+        \return Target depth minus outstanding requests (0 if full).
+    */
+    size_t room() const;
+
+    /*!
+        \brief Record that a request was sent.
+        \param request The block requested.
+        \param now Send time.
+    */
+    void onSent(const BlockRequest &request, Clock::time_point now);
+
+    /*!
+        \brief Check whether a block is still awaited on this connection.
+        \param block The block.
+        \return True if it was requested and has not arrived, expired or been rejected.
+    */
+    bool isOutstanding(const BlockRequest &block) const;
+
+    /*!
+        \brief Record that a block arrived.
+        \param block The block.
+        \param now Arrival time.
+        \return False if it was not outstanding (unsolicited, or already given up on).
+    */
+    bool onReceived(const BlockRequest &block, Clock::time_point now);
+
+    /*!
+        \brief Record that the peer rejected a request (BEP 6).
+        \param block The block.
+        \return False if it was not outstanding.
+    */
+    bool onRejected(const BlockRequest &block);
+
+    /*!
+        \brief Remove requests that have waited longer than timeout().
+        \param now Current time.
+        \param timedOut Receives the expired requests, to be sent elsewhere.
+        \return Number expired.
+    */
+    size_t expire(Clock::time_point now, std::vector<BlockRequest> &timedOut);
+
+    /*!
+        \brief Remove every outstanding request (choke, disconnect or hand-off).
+        \param abandoned Receives the requests.
+    */
+    void clear(std::vector<BlockRequest> &abandoned);
+
+    /*!
+        \brief Remove the outstanding requests a predicate selects, without touching the depth.
+        Used to withdraw requests for blocks another peer has already delivered.
+        \param unwanted Called as unwanted(const BlockRequest &) and returns true to remove it.
+        \param withdrawn Receives the removed requests, to be cancelled.
+        \return Number removed.
+    */
+    template <typename Predicate>
+    size_t withdrawIf(Predicate &&unwanted, std::vector<BlockRequest> &withdrawn)
+    {
+        size_t before = withdrawn.size();
+        for (auto it = queue.begin(); it != queue.end();)
+        {
+            if (unwanted(it->request))
+            {
+                withdrawn.push_back(it->request);
+                it = queue.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return withdrawn.size() - before;
+    }
+
+    /*!
+        \brief When the oldest outstanding request times out.
+        \return The deadline, or Clock::time_point::max() if nothing is outstanding.
+    */
+    Clock::time_point nextDeadline() const;
+
+    size_t outstanding() const { return queue.size(); }               //!> Requests in flight.
+    size_t depth() const { return static_cast<size_t>(targetDepth); } //!> Current target depth.
+    double bytesPerSecond() const { return rate; }                    //!> Smoothed download rate.
+    std::chrono::milliseconds timeout() const;                        //!> Current request timeout.
+
+private:
+    struct Outstanding
+    {
+        BlockRequest request;     //!> The block.
+        Clock::time_point sentAt; //!> When it was requested.
+    };
+
+    std::deque<Outstanding> queue;                //!> In send order; peers answer in order.
+    double targetDepth = INITIAL_DEPTH;           //!> Requests to keep in flight.
+    double rate = 0.0;                            //!> Smoothed bytes per second (0 until measured).
+    uint64_t windowBytes = 0;                     //!> Bytes received in the current rate window.
+    Clock::time_point windowStart;                //!> Start of the current rate window.
+    std::chrono::microseconds minLatency{0};      //!> Lowest block latency seen (0 = none).
+    Clock::time_point minLatencyAt;               //!> When it was seen.
+    std::chrono::microseconds smoothedLatency{0}; //!> Average block latency, queueing included.
+};
+
+#endif
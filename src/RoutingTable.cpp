@@ -0,0 +1,328 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\RoutingTable.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 13:21:12
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "RoutingTable.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+#define SNAPSHOT_MAGIC "DHTS"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_SIZE (4 + 1 + 20 + 4) //!> Magic, version, node ID, node count
+
+/*!
+    \brief Creates an empty table centred on our node ID.
+    \param self Our node ID.
+*/
+RoutingTable::RoutingTable(const NodeId &self) : selfId(self) {}
+
+/*!
+    \brief Find the bucket for an ID: the length of the prefix it shares with our ID.
+    \param id The node ID.
+    \return Bucket index, 0..159 (our own ID maps to 159).
+*/
+size_t RoutingTable::bucketIndex(const NodeId &id) const
+{
+    for (size_t i = 0; i < id.size(); ++i)
+    {
+        uint8_t diff = static_cast<uint8_t>(id[i] ^ selfId[i]);
+        if (diff != 0)
+        {
+            size_t bit = 0;
+            while ((diff & 0x80) == 0)
+            {
+                diff = static_cast<uint8_t>(diff << 1);
+                bit++;
+            }
+            return i * 8 + bit;
+        }
+    }
+    return buckets.size() - 1;
+}
+
+/*!
+    \brief Record that a node answered us, adding it if its bucket has room.
+    \param id The node's ID.
+    \param address The node's address.
+    \return True if the node is in the table afterwards.
+*/
+bool RoutingTable::insert(const NodeId &id, const sockaddr_in &address)
+{
+    if (id == selfId)
+    {
+        return false;
+    }
+
+    std::vector<RoutingEntry> &bucket = buckets[bucketIndex(id)];
+    auto now = std::chrono::steady_clock::now();
+
+    for (RoutingEntry &entry : bucket)
+    {
+        if (entry.id == id)
+        {
+            entry.address = address;
+            entry.lastSeen = now;
+            entry.failures = 0;
+            return true;
+        }
+    }
+
+    if (bucket.size() < K)
+    {
+        bucket.push_back({id, address, now, 0});
+        return true;
+    }
+
+    auto worst = std::max_element(bucket.begin(), bucket.end(), [](const RoutingEntry &a, const RoutingEntry &b)
+                                  { return a.failures < b.failures; });
+    if (worst->failures >= MAX_FAILURES)
+    {
+        *worst = {id, address, now, 0};
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+    \brief Record that a node did not answer.
+    \param address The node's address.
+*/
+void RoutingTable::markFailed(const sockaddr_in &address)
+{
+    for (auto &bucket : buckets)
+    {
+        for (RoutingEntry &entry : bucket)
+        {
+            if (entry.address.sin_addr.s_addr == address.sin_addr.s_addr && entry.address.sin_port == address.sin_port)
+            {
+                if (entry.failures < 0xFF)
+                {
+                    entry.failures++;
+                }
+                return;
+            }
+        }
+    }
+}
+
+/*!
+    \brief Get the known nodes closest to a target by XOR distance.
+    \param target The ID to measure against.
+    \param count How many nodes to return at most.
+    \return Nodes sorted nearest first.
+*/
+std::vector<RoutingEntry> RoutingTable::closest(const NodeId &target, size_t count) const
+{
+    std::vector<RoutingEntry> result;
+    for (const auto &bucket : buckets)
+    {
+        for (const RoutingEntry &entry : bucket)
+        {
+            if (entry.failures < MAX_FAILURES)
+            {
+                result.push_back(entry);
+            }
+        }
+    }
+
+    auto byDistance = [&target](const RoutingEntry &a, const RoutingEntry &b)
+    { return closer(target, a.id, b.id); };
+
+    if (result.size() > count)
+    {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), byDistance);
+        result.resize(count);
+    }
+    else
+    {
+        std::sort(result.begin(), result.end(), byDistance);
+    }
+    return result;
+}
+
+/*!
+    \brief Number of nodes in the table.
+    \return The node count.
+*/
+size_t RoutingTable::size() const
+{
+    size_t total = 0;
+    for (const auto &bucket : buckets)
+    {
+        total += bucket.size();
+    }
+    return total;
+}
+
+/*!
+    \brief Number of nodes below MAX_FAILURES.
+    \return The healthy node count.
+*/
+size_t RoutingTable::healthySize() const
+{
+    size_t total = 0;
+    for (const auto &bucket : buckets)
+    {
+        for (const RoutingEntry &entry : bucket)
+        {
+            total += entry.failures < MAX_FAILURES ? 1 : 0;
+        }
+    }
+    return total;
+}
+
+/*!
+    \brief Check whether `a` is closer to `target` than `b` is.
+    \param target The reference ID.
+    \param a First ID.
+    \param b Second ID.
+    \return True if a XOR target < b XOR target.
+*/
+bool RoutingTable::closer(const NodeId &target, const NodeId &a, const NodeId &b)
+{
+    for (size_t i = 0; i < target.size(); ++i)
+    {
+        uint8_t da = static_cast<uint8_t>(a[i] ^ target[i]);
+        uint8_t db = static_cast<uint8_t>(b[i] ^ target[i]);
+        if (da != db)
+        {
+            return da < db;
+        }
+    }
+    return false;
+}
+
+/*!
+    \brief Decode one 26-byte compact node record.
+    \param data Pointer to the record.
+    \param id Receives the node ID.
+    \param address Receives the IPv4 address and port.
+*/
+void RoutingTable::decodeCompactNode(const char *data, NodeId &id, sockaddr_in &address)
+{
+    std::memcpy(id.data(), data, id.size());
+    address = sockaddr_in{};
+    address.sin_family = AF_INET;
+    std::memcpy(&address.sin_addr, data + 20, 4); //!> Already network order
+    std::memcpy(&address.sin_port, data + 24, 2);
+}
+
+/*!
+    \brief Encode a node as a 26-byte compact record.
+    \param id The node ID.
+    \param address The node's IPv4 address and port.
+    \param out Destination for the 26 bytes.
+*/
+void RoutingTable::encodeCompactNode(const NodeId &id, const sockaddr_in &address, char *out)
+{
+    std::memcpy(out, id.data(), id.size());
+    std::memcpy(out + 20, &address.sin_addr, 4);
+    std::memcpy(out + 24, &address.sin_port, 2);
+}
+
+/*!
+    \brief Write our node ID and every responsive node to a small binary file.
+    \param path The snapshot file.
+    \return False if the file could not be written.
+*/
+bool RoutingTable::save(const std::string &path) const
+{
+    std::vector<char> snapshot(SNAPSHOT_HEADER_SIZE);
+    std::memcpy(snapshot.data(), SNAPSHOT_MAGIC, 4);
+    snapshot[4] = SNAPSHOT_VERSION;
+    std::memcpy(snapshot.data() + 5, selfId.data(), selfId.size());
+
+    uint32_t count = 0;
+    for (const auto &bucket : buckets)
+    {
+        for (const RoutingEntry &entry : bucket)
+        {
+            if (entry.failures == 0)
+            {
+                size_t offset = snapshot.size();
+                snapshot.resize(offset + COMPACT_NODE_SIZE);
+                encodeCompactNode(entry.id, entry.address, snapshot.data() + offset);
+                count++;
+            }
+        }
+    }
+
+    snapshot[25] = static_cast<char>(count >> 24);
+    snapshot[26] = static_cast<char>(count >> 16);
+    snapshot[27] = static_cast<char>(count >> 8);
+    snapshot[28] = static_cast<char>(count);
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+        file.write(snapshot.data(), static_cast<std::streamsize>(snapshot.size()));
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+/*!
+    \brief Read a snapshot written by save().
+    \param path The snapshot file.
+    \param self Receives the saved node ID.
+    \param nodes Receives the saved nodes (ID and address only).
+    \return False if the file is missing or malformed.
+*/
+bool RoutingTable::load(const std::string &path, NodeId &self, std::vector<RoutingEntry> &nodes)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::vector<char> snapshot((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (snapshot.size() < SNAPSHOT_HEADER_SIZE ||
+        std::memcmp(snapshot.data(), SNAPSHOT_MAGIC, 4) != 0 ||
+        snapshot[4] != SNAPSHOT_VERSION)
+    {
+        return false;
+    }
+
+    uint32_t count = (static_cast<uint32_t>(static_cast<uint8_t>(snapshot[25])) << 24) |
+                     (static_cast<uint32_t>(static_cast<uint8_t>(snapshot[26])) << 16) |
+                     (static_cast<uint32_t>(static_cast<uint8_t>(snapshot[27])) << 8) |
+                     static_cast<uint32_t>(static_cast<uint8_t>(snapshot[28]));
+    if (snapshot.size() != SNAPSHOT_HEADER_SIZE + static_cast<size_t>(count) * COMPACT_NODE_SIZE)
+    {
+        return false;
+    }
+
+    std::memcpy(self.data(), snapshot.data() + 5, self.size());
+
+    nodes.clear();
+    nodes.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        RoutingEntry entry{};
+        decodeCompactNode(snapshot.data() + SNAPSHOT_HEADER_SIZE + i * COMPACT_NODE_SIZE, entry.id, entry.address);
+        nodes.push_back(entry);
+    }
+    return true;
+}
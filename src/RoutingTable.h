@@ -0,0 +1,148 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\RoutingTable.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 13:20:54
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef ROUTING_TABLE_H
+#define ROUTING_TABLE_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+using NodeId = std::array<uint8_t, 20>;
+
+/*!
+    \brief A DHT node we know about.
+*/
+struct RoutingEntry
+{
+    NodeId id;                                      //!> The node's ID.
+    sockaddr_in address;                            //!> Where to reach it.
+    std::chrono::steady_clock::time_point lastSeen; //!> Last time it answered us.
+    uint8_t failures;                               //!> Consecutive unanswered queries.
+};
+
+class RoutingTable
+{
+public:
+    static constexpr size_t K = 8;                  //!> Bucket size and lookup width.
+    static constexpr uint8_t MAX_FAILURES = 2;      //!> A node this unreliable may be replaced.
+    static constexpr size_t COMPACT_NODE_SIZE = 26; //!> 20-byte ID, 4-byte IPv4, 2-byte port.
+
+    /*!
+        \brief Creates an empty table centred on our node ID.
+        \param self Our node ID.
+    */
+    explicit RoutingTable(const NodeId &self);
+
+    /*!
+        \brief Record that a node answered us, adding it if its bucket has room.
+        Full buckets evict a node that has repeatedly failed; otherwise the newcomer is dropped.
+        \param id The node's ID.
+        \param address The node's address.
+        \return True if the node is in the table afterwards.
+    */
+    bool insert(const NodeId &id, const sockaddr_in &address);
+
+    /*!
+        \brief Record that a node did not answer.
+        \param address The node's address.
+    */
+    void markFailed(const sockaddr_in &address);
+
+    /*!
+        \brief Get the known nodes closest to a target by XOR distance.
+        \param target The ID to measure against.
+        \param count How many nodes to return at most.
+        \return Nodes sorted nearest first.
+    */
+    std::vector<RoutingEntry> closest(const NodeId &target, size_t count) const;
+
+    /*!
+        \brief Number of nodes in the table.
+        \return The node count.
+    */
+    size_t size() const;
+
+    /*!
+        \brief Number of nodes closest() would return, i.e. those below MAX_FAILURES.
+        \return The healthy node count.
+    */
+    size_t healthySize() const;
+
+    /*!
+        \brief Get our node ID.
+        \return The ID the table is centred on.
+    */
+    const NodeId &self() const { return selfId; }
+
+    /*!
+        \brief Check whether `a` is closer to `target` than `b` is.
+        \param target The reference ID.
+        \param a First ID.
+        \param b Second ID.
+        \return True if a XOR target < b XOR target.
+    */
+    static bool closer(const NodeId &target, const NodeId &a, const NodeId &b);
+
+    /*!
+        \brief Decode one 26-byte compact node record.
+        \param data Pointer to the record.
+        \param id Receives the node ID.
+        \param address Receives the IPv4 address and port.
+    */
+    static void decodeCompactNode(const char *data, NodeId &id, sockaddr_in &address);
+
+    /*!
+        \brief Encode a node as a 26-byte compact record.
+        \param id The node ID.
+        \param address The node's IPv4 address and port.
+        \param out Destination for the 26 bytes.
+    */
+    static void encodeCompactNode(const NodeId &id, const sockaddr_in &address, char *out);
+
+    /*!
+        \brief Write our node ID and every responsive node to a small binary file.
+        The file is written to a temporary name and renamed, so a crash never leaves a torn snapshot.
+        \param path The snapshot file.
+        \return False if the file could not be written.
+    */
+    bool save(const std::string &path) const;
+
+    /*!
+        \brief Read a snapshot written by save().
+        \param path The snapshot file.
+        \param self Receives the saved node ID.
+        \param nodes Receives the saved nodes (ID and address only).
+        \return False if the file is missing or malformed.
+    */
+    static bool load(const std::string &path, NodeId &self, std::vector<RoutingEntry> &nodes);
+
+private:
+    NodeId selfId;                                      //!> Our node ID.
+    std::array<std::vector<RoutingEntry>, 160> buckets; //!> Bucket i holds nodes sharing exactly i leading bits with us.
+
+    size_t bucketIndex(const NodeId &id) const;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\ScrapeTable.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 18:31:40
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "ScrapeTable.h"
+#include <algorithm>
+
+/*!
+    \brief Creates a table of empty rows.
+    \param count Number of info hashes.
+*/
+ScrapeTable::ScrapeTable(size_t count) : rows(count) {}
+
+/*!
+    \brief Merge one tracker's counts into a row.
+    \param index Position of the info hash (ignored if outside the table).
+    \param seeders Seeders reported.
+    \param completed Completed downloads reported.
+    \param leechers Leechers reported.
+*/
+void ScrapeTable::record(size_t index, uint32_t seeders, uint32_t completed, uint32_t leechers)
+{
+    if (index >= rows.size())
+    {
+        return; //!> Not a row of this table
+    }
+    ScrapeCounts &row = rows[index];
+    if (row.replies == 0)
+    {
+        answeredRows++;
+    }
+    row.seeders = std::max(row.seeders, seeders);
+    row.completed = std::max(row.completed, completed);
+    row.leechers = std::max(row.leechers, leechers);
+    row.replies++;
+}
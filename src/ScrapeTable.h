@@ -0,0 +1,79 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\ScrapeTable.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 18:31:06
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef SCRAPE_TABLE_H
+#define SCRAPE_TABLE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief Swarm counts for one info hash, merged over every tracker that answered.
+*/
+struct ScrapeCounts
+{
+    uint32_t seeders = 0;   //!> Highest seeder count reported.
+    uint32_t completed = 0; //!> Highest completed-download count reported.
+    uint32_t leechers = 0;  //!> Highest leecher count reported.
+    uint32_t replies = 0;   //!> Trackers that reported on the hash.
+};
+
+/*!
+    \brief Fixed-size table of scrape results, one 16-byte row per info hash.
+    Rows are addressed by the hash's position in the caller's list, so no hash is stored or
+    looked up. Trackers overlap, so the highest count seen for each field is kept.
+    Not thread-safe; the scraper fills it from its own thread.
+*/
+class ScrapeTable
+{
+public:
+    /*!
+        \brief Creates a table of empty rows.
+        \param count Number of info hashes.
+    */
+    explicit ScrapeTable(size_t count);
+
+    /*!
+        \brief Merge one tracker's counts into a row.
+        \param index Position of the info hash (ignored if outside the table).
+        \param seeders Seeders reported.
+        \param completed Completed downloads reported.
+        \param leechers Leechers reported.
+    */
+    void record(size_t index, uint32_t seeders, uint32_t completed, uint32_t leechers);
+
+    /*!
+        \brief Get a row.
+        \param index Position of the info hash.
+        \return The merged counts.
+    */
+    const ScrapeCounts &at(size_t index) const { return rows[index]; }
+
+    /*!
+        \brief Number of rows.
+        \return The info hash count.
+    */
+    size_t size() const { return rows.size(); }
+
+    /*!
+        \brief Number of info hashes at least one tracker reported on.
+        \return The answered row count.
+    */
+    size_t answered() const { return answeredRows; }
+
+private:
+    std::vector<ScrapeCounts> rows; //!> One row per info hash.
+    size_t answeredRows = 0;        //!> Rows with replies > 0.
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\SocketPoller.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Sunday October 18th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sun October 18th 2026 1:31:52
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "SocketPoller.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#define MAX_EVENTS 64 //!> Events collected per epoll_wait
+
+/*!
+    \brief Creates an empty poller.
+*/
+SocketPoller::SocketPoller()
+{
+#ifdef __linux__
+    pollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (pollFd < 0)
+    {
+        throw std::runtime_error("Failed to create epoll instance");
+    }
+#endif
+}
+
+SocketPoller::~SocketPoller()
+{
+#ifdef __linux__
+    if (pollFd >= 0)
+    {
+        close(pollFd);
+    }
+#endif
+}
+
+/*!
+    \brief Start watching a socket.
+    \param socket The socket.
+*/
+void SocketPoller::add(SocketHandle socket)
+{
+    if (std::find(sockets.begin(), sockets.end(), socket) != sockets.end())
+    {
+        return;
+    }
+    sockets.push_back(socket);
+#ifdef __linux__
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = socket;
+    epoll_ctl(pollFd, EPOLL_CTL_ADD, socket, &event);
+#endif
+}
+
+/*!
+    \brief Stop watching a socket.
+    \param socket The socket.
+*/
+void SocketPoller::remove(SocketHandle socket)
+{
+    auto it = std::find(sockets.begin(), sockets.end(), socket);
+    if (it == sockets.end())
+    {
+        return;
+    }
+    sockets.erase(it);
+    writers.erase(std::remove(writers.begin(), writers.end(), socket), writers.end());
+#ifdef __linux__
+    epoll_ctl(pollFd, EPOLL_CTL_DEL, socket, nullptr);
+#endif
+}
+
+/*!
+    \brief Also report when a watched socket can take more data (or stop doing so).
+    \param socket The socket.
+    \param watch Whether to report writability.
+*/
+void SocketPoller::watchWrites(SocketHandle socket, bool watch)
+{
+    auto it = std::find(writers.begin(), writers.end(), socket);
+    if ((it != writers.end()) == watch || std::find(sockets.begin(), sockets.end(), socket) == sockets.end())
+    {
+        return;
+    }
+    if (watch)
+    {
+        writers.push_back(socket);
+    }
+    else
+    {
+        writers.erase(it);
+    }
+#ifdef __linux__
+    epoll_event event{};
+    event.events = watch ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.fd = socket;
+    epoll_ctl(pollFd, EPOLL_CTL_MOD, socket, &event);
+#endif
+}
+
+/*!
+    \brief Wait until at least one socket is readable (or closed) or writable.
+    \param timeout Longest wait.
+    \param ready Receives the readable sockets.
+    \param writable Receives the sockets watched for writes that can take more data.
+    \return Number of sockets reported (0 on timeout).
+*/
+size_t SocketPoller::wait(std::chrono::milliseconds timeout, std::vector<SocketHandle> &ready, std::vector<SocketHandle> &writable)
+{
+    ready.clear();
+    writable.clear();
+    int waitMs = static_cast<int>(std::max<int64_t>(0, timeout.count()));
+#ifdef __linux__
+    epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(pollFd, events, MAX_EVENTS, waitMs);
+    for (int i = 0; i < count; ++i)
+    {
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        {
+            ready.push_back(events[i].data.fd);
+        }
+        if (events[i].events & EPOLLOUT)
+        {
+            writable.push_back(events[i].data.fd);
+        }
+    }
+#else
+#ifdef _WIN32
+    std::vector<WSAPOLLFD> entries(sockets.size());
+#else
+    std::vector<pollfd> entries(sockets.size());
+#endif
+    for (size_t i = 0; i < sockets.size(); ++i)
+    {
+        entries[i].fd = sockets[i];
+        entries[i].events = POLLIN;
+        if (std::find(writers.begin(), writers.end(), sockets[i]) != writers.end())
+        {
+            entries[i].events |= POLLOUT;
+        }
+    }
+#ifdef _WIN32
+    int count = WSAPoll(entries.data(), static_cast<ULONG>(entries.size()), waitMs);
+#else
+    int count = ::poll(entries.data(), static_cast<nfds_t>(entries.size()), waitMs);
+#endif
+    for (size_t i = 0; count > 0 && i < entries.size(); ++i)
+    {
+        if (entries[i].revents & ~POLLOUT)
+        {
+            ready.push_back(sockets[i]);
+        }
+        if (entries[i].revents & POLLOUT)
+        {
+            writable.push_back(sockets[i]);
+        }
+    }
+#endif
+    return ready.size() + writable.size();
+}
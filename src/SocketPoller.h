@@ -0,0 +1,76 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\SocketPoller.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Sunday October 18th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sun October 18th 2026 1:24:10
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef SOCKET_POLLER_H
+#define SOCKET_POLLER_H
+
+#include <vector>
+#include <chrono>
+#include "PeerConnection.h"
+
+/*!
+    \brief Waits for any of a set of sockets to become readable, or writable where asked
+    (epoll on Linux, poll elsewhere).
+    Lets one thread serve every peer session instead of blocking a thread on each.
+*/
+class SocketPoller
+{
+public:
+    using SocketHandle = PeerConnection::SocketHandle;
+
+    /*!
+        \brief Creates an empty poller.
+        \throws std::runtime_error if the epoll instance cannot be created.
+    */
+    SocketPoller();
+    ~SocketPoller();
+
+    SocketPoller(const SocketPoller &) = delete;
+    SocketPoller &operator=(const SocketPoller &) = delete;
+
+    /*!
+        \brief Start watching a socket.
+        \param socket The socket.
+    */
+    void add(SocketHandle socket);
+
+    /*!
+        \brief Stop watching a socket (before it is closed).
+        \param socket The socket.
+    */
+    void remove(SocketHandle socket);
+
+    /*!
+        \brief Also report when a watched socket can take more data (or stop doing so).
+        \param socket The socket.
+        \param watch Whether to report writability.
+    */
+    void watchWrites(SocketHandle socket, bool watch);
+
+    /*!
+        \brief Wait until at least one socket is readable (or closed) or writable.
+        \param timeout Longest wait.
+        \param ready Receives the readable sockets.
+        \param writable Receives the sockets watched for writes that can take more data.
+        \return Number of sockets reported (0 on timeout).
+    */
+    size_t wait(std::chrono::milliseconds timeout, std::vector<SocketHandle> &ready, std::vector<SocketHandle> &writable);
+
+    size_t size() const { return sockets.size(); } //!> Sockets watched.
+
+private:
+    std::vector<SocketHandle> sockets; //!> Sockets watched.
+    std::vector<SocketHandle> writers; //!> Sockets also watched for writability.
+    int pollFd = -1;                   //!> epoll instance (Linux only).
+};
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\TorrentStorage.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Sunday October 18th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sun October 18th 2026 2:40:19
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "TorrentStorage.h"
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <sys/stat.h>
+#endif
+
+/*!
+    \brief Check that a torrent's file path stays inside the download directory.
+    \param path The '/'-separated path.
+    \return False for empty or absolute paths and ones with "." or ".." components.
+*/
+static bool isSafePath(const std::string &path)
+{
+    if (path.empty() || path.front() == '/' || path.find('\\') != std::string::npos || path.find(':') != std::string::npos)
+    {
+        return false;
+    }
+    size_t start = 0;
+    while (start <= path.size())
+    {
+        size_t end = std::min(path.find('/', start), path.size());
+        std::string_view component(path.data() + start, end - start);
+        if (component.empty() || component == "." || component == "..")
+        {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+/*!
+    \brief Describes the storage; nothing is touched on disk until allocate() or write().
+    \param directory The download directory.
+    \param files Every file in piece order.
+    \param pieceSize Length of every piece but the last.
+    \param maxOpen Most files kept open at once.
+*/
+TorrentStorage::TorrentStorage(std::string directory, std::vector<TorrentFile> files, uint32_t pieceSize, size_t maxOpen)
+    : directory(std::move(directory)), layout(std::move(files)), pieceSize(pieceSize),
+      maxOpen(std::max<size_t>(1, maxOpen)), cache(layout.size())
+{
+    for (const TorrentFile &file : layout)
+    {
+        if (!isSafePath(file.path))
+        {
+            throw std::runtime_error("Unsafe file path in torrent: " + file.path);
+        }
+        starts.push_back(total);
+        total += file.length;
+    }
+}
+
+/*!
+    \brief Closes the file.
+*/
+TorrentStorage::OpenFile::~OpenFile()
+{
+#ifdef _WIN32
+    CloseHandle(handle);
+#else
+    close(handle);
+#endif
+}
+
+/*!
+    \brief Full path of a file.
+    \param index The file's position in the layout.
+    \return The path under the download directory.
+*/
+std::string TorrentStorage::pathOf(size_t index) const
+{
+    return directory + "/" + layout[index].path;
+}
+
+/*!
+    \brief Get a file from the cache, opening it (and closing the least recently used one) if needed.
+    \param index The file's position in the layout.
+    \return The open file; it stays open while the caller holds it, even if evicted.
+    \throws std::runtime_error if the file cannot be opened.
+*/
+std::shared_ptr<TorrentStorage::OpenFile> TorrentStorage::open(size_t index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    CachedFile &slot = cache[index];
+    slot.lastUsed = ++uses;
+    if (slot.file)
+    {
+        return slot.file;
+    }
+
+    if (openCount >= maxOpen)
+    {
+        CachedFile *oldest = nullptr;
+        for (CachedFile &candidate : cache)
+        {
+            if (candidate.file && (oldest == nullptr || candidate.lastUsed < oldest->lastUsed))
+            {
+                oldest = &candidate;
+            }
+        }
+        if (oldest != nullptr)
+        {
+            oldest->file.reset();
+            openCount--;
+        }
+    }
+
+    std::string path = pathOf(index);
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+#else
+    int handle = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (handle < 0)
+#endif
+    {
+        throw std::runtime_error("Failed to open file for writing: " + path);
+    }
+    slot.file = std::make_shared<OpenFile>(handle);
+    openCount++;
+    return slot.file;
+}
+
+/*!
+    \brief Write a whole buffer at a file offset without moving any file position.
+    \param handle The file.
+    \param data The bytes.
+    \param length Number of bytes.
+    \param offset Offset in the file.
+    \return False if the write failed.
+*/
+bool TorrentStorage::writeAt(NativeFile handle, const char *data, size_t length, uint64_t offset)
+{
+    while (length > 0)
+    {
+#ifdef _WIN32
+        OVERLAPPED position{};
+        position.Offset = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD written = 0;
+        if (!WriteFile(handle, data, static_cast<DWORD>(std::min<size_t>(length, 1u << 30)), &written, &position) || written == 0)
+        {
+            return false;
+        }
+#else
+        ssize_t written = pwrite(handle, data, length, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return false;
+        }
+#endif
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+/*!
+    \brief Create every file (and its directories) at its full length.
+    \param sparse True to only set the length; otherwise reserve the blocks now.
+*/
+void TorrentStorage::allocate(bool sparse)
+{
+    std::filesystem::create_directories(directory);
+    for (size_t i = 0; i < layout.size(); ++i)
+    {
+        std::shared_ptr<OpenFile> file = open(i);
+        uint64_t length = layout[i].length;
+        bool reserved;
+#ifdef _WIN32
+        if (sparse)
+        {
+            DWORD unused = 0;
+            DeviceIoControl(file->handle, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &unused, nullptr);
+        }
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(length);
+        reserved = SetFilePointerEx(file->handle, size, nullptr, FILE_BEGIN) && SetEndOfFile(file->handle);
+#else
+        struct stat info;
+        if (sparse && fstat(file->handle, &info) == 0 && static_cast<uint64_t>(info.st_size) == length)
+        {
+            continue; //!> Already full size (an earlier run); keep what it wrote
+        }
+        if (sparse || length == 0)
+        {
+            reserved = ftruncate(file->handle, static_cast<off_t>(length)) == 0;
+        }
+        else
+        {
+#ifdef __linux__
+            reserved = fallocate(file->handle, 0, 0, static_cast<off_t>(length)) == 0;
+            if (!reserved && errno == EOPNOTSUPP)
+            {
+                reserved = posix_fallocate(file->handle, 0, static_cast<off_t>(length)) == 0; //!> Filesystem without fallocate: glibc writes zeros instead
+            }
+#else
+            reserved = ftruncate(file->handle, static_cast<off_t>(length)) == 0; //!> No portable way to reserve blocks here
+#endif
+        }
+#endif
+        if (!reserved)
+        {
+            throw std::runtime_error("Failed to allocate " + std::to_string(length) + " bytes for " + pathOf(i));
+        }
+    }
+}
+
+/*!
+    \brief Write data at its place in the torrent.
+    \param piece The piece index.
+    \param begin Offset within the piece.
+    \param data The bytes.
+*/
+void TorrentStorage::write(uint32_t piece, uint32_t begin, std::string_view data)
+{
+    uint64_t offset = static_cast<uint64_t>(piece) * pieceSize + begin;
+    if (offset > total || data.size() > total - offset)
+    {
+        throw std::runtime_error("Write past the end of the torrent at piece " + std::to_string(piece));
+    }
+
+    while (!data.empty())
+    {
+        //* Last file starting at or before the offset; zero-length files before it are skipped
+        size_t index = static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin()) - 1;
+        uint64_t within = offset - starts[index];
+        size_t length = static_cast<size_t>(std::min<uint64_t>(data.size(), layout[index].length - within));
+
+        std::shared_ptr<OpenFile> file = open(index);
+        if (!writeAt(file->handle, data.data(), length, within))
+        {
+            throw std::runtime_error("Failed to write to file: " + pathOf(index));
+        }
+        data.remove_prefix(length);
+        offset += length;
+    }
+}
+
+/*!
+    \brief Close every cached file.
+*/
+void TorrentStorage::closeAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (CachedFile &slot : cache)
+    {
+        slot.file.reset();
+    }
+    openCount = 0;
+}
+
+/*!
+    \brief Number of files open right now.
+    \return The count.
+*/
+size_t TorrentStorage::openFiles() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return openCount;
+}
@@ -0,0 +1,113 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\TorrentStorage.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Sunday October 18th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sun October 18th 2026 2:12:48
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef TORRENT_STORAGE_H
+#define TORRENT_STORAGE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "MagnetMetadata.h"
+
+/*!
+    \brief The torrent's files on disk, addressed by piece and offset.
+    The data of every piece is a contiguous range of the files laid end to end; a write is split
+    at file boundaries and each part is written in place with a positional write, so the
+    download needs no reassembly afterwards. Files are preallocated up front (or just sized,
+    leaving them sparse). Open files are cached, least recently used closed first, so at most
+    `maxOpen` stay open however many files the torrent has. Thread-safe.
+*/
+class TorrentStorage
+{
+public:
+    static constexpr size_t MAX_OPEN_FILES = 64; //!> Default bound on cached open files.
+
+    /*!
+        \brief Describes the storage; nothing is touched on disk until allocate() or write().
+        \param directory The download directory.
+        \param files Every file in piece order.
+        \param pieceSize Length of every piece but the last.
+        \param maxOpen Most files kept open at once.
+        \throws std::runtime_error if a path is absolute or leaves the directory.
+    */
+    TorrentStorage(std::string directory, std::vector<TorrentFile> files, uint32_t pieceSize, size_t maxOpen = MAX_OPEN_FILES);
+
+    TorrentStorage(const TorrentStorage &) = delete;
+    TorrentStorage &operator=(const TorrentStorage &) = delete;
+
+    /*!
+        \brief Create every file (and its directories) at its full length.
+        \param sparse True to only set the length, leaving unwritten ranges as holes; otherwise
+        the blocks are reserved now so the download cannot run out of space or fragment.
+        \throws std::runtime_error if a file cannot be created or space cannot be reserved.
+    */
+    void allocate(bool sparse);
+
+    /*!
+        \brief Write data at its place in the torrent.
+        \param piece The piece index.
+        \param begin Offset within the piece.
+        \param data The bytes (may span several files).
+        \throws std::runtime_error if the range is outside the torrent or a write fails.
+    */
+    void write(uint32_t piece, uint32_t begin, std::string_view data);
+
+    /*!
+        \brief Close every cached file (writes still in progress keep theirs open until they finish).
+    */
+    void closeAll();
+
+    const std::vector<TorrentFile> &files() const { return layout; } //!> Every file in piece order.
+    uint64_t totalSize() const { return total; }                     //!> Length of the torrent's data.
+    size_t openFiles() const;                                        //!> Files open right now.
+
+private:
+#ifdef _WIN32
+    using NativeFile = void *; //!> HANDLE.
+#else
+    using NativeFile = int; //!> File descriptor.
+#endif
+
+    struct OpenFile
+    {
+        NativeFile handle; //!> Closed when the last user lets go.
+        explicit OpenFile(NativeFile handle) : handle(handle) {}
+        ~OpenFile();
+    };
+
+    struct CachedFile
+    {
+        std::shared_ptr<OpenFile> file; //!> Null while closed.
+        uint64_t lastUsed = 0;          //!> Use counter value when last handed out.
+    };
+
+    std::string directory;           //!> The download directory.
+    std::vector<TorrentFile> layout; //!> Every file in piece order.
+    std::vector<uint64_t> starts;    //!> Torrent offset of each file's first byte.
+    uint64_t total = 0;              //!> Length of the torrent's data.
+    uint32_t pieceSize;              //!> Length of every piece but the last.
+    size_t maxOpen;                  //!> Most files kept open at once.
+    mutable std::mutex mutex;        //!> Guards the cache.
+    std::vector<CachedFile> cache;   //!> One slot per file.
+    size_t openCount = 0;            //!> Slots holding an open file.
+    uint64_t uses = 0;               //!> Use counter for least recently used.
+
+    std::shared_ptr<OpenFile> open(size_t index);
+    std::string pathOf(size_t index) const;
+    static bool writeAt(NativeFile handle, const char *data, size_t length, uint64_t offset);
+};
+
+#endif
@@ -11,10 +11,33 @@
  */
 
 #include "TorrentUtilities.h"
-#include <sstream>
+#include "BencodeDocument.h"
+#include "BencodeWriter.h"
 #include <stdexcept>
 #include <cctype>
-#include <iostream>
+#include <cstring>
+#include <random>
+
+/*!
+    \brief Converts a parsed value to the flattened string form used by the map/list helpers.
+    \param value The parsed value.
+    \return Strings as their bytes, integers as decimal text, containers as their raw encoding.
+*/
+static std::string flattenBencodedValue(const BencodeValue &value)
+{
+    switch (value.type())
+    {
+    case BencodeType::String:
+        return std::string(value.asString());
+    case BencodeType::Integer:
+    {
+        std::string_view raw = value.raw();
+        return std::string(raw.substr(1, raw.size() - 2)); //!> Strip 'i' and 'e'
+    }
+    default:
+        return std::string(value.raw()); //!> Nested containers keep their original encoding
+    }
+}
 
 /*!
     \brief Helper function to decode a bencoded dictionary.
@@ -24,47 +47,22 @@
 */
 std::unordered_map<std::string, std::string> TorrentUtilities::decodeBencodedData(const std::string &data, size_t &index)
 {
-    if (data[index] != 'd')
+    if (index >= data.length() || data[index] != 'd')
         throw std::runtime_error("Invalid dictionary format");
 
-    std::unordered_map<std::string, std::string> decoded;
-    index++; // Skip 'd'
+    BencodeDocument document;
+    document.parse(std::string_view(data).substr(index));
 
-    std::cout << "Decoding dictionary..." << std::endl;
+    BencodeValue root = document.root();
+    std::unordered_map<std::string, std::string> decoded;
+    decoded.reserve(root.size());
 
-    while (index < data.length() && data[index] != 'e')
+    for (auto it = root.begin(); it != root.end(); ++it)
     {
-        std::string key = decodeBencodedString(data, index);
-        std::cout << "Decoded Key: " << key << std::endl;
-
-        if (index >= data.length())
-            throw std::runtime_error("Unexpected end of dictionary");
-
-        if (std::isdigit(data[index]))
-        {
-            decoded[key] = decodeBencodedString(data, index);
-            std::cout << "Decoded Value: " << decoded[key] << std::endl;
-        }
-        else if (data[index] == 'd')
-        {
-            decoded[key] = encodeBencodedData(decodeBencodedData(data, index)); //!> Recursively decode dictionary
-            std::cout << "Decoded Dictionary for key: " << key << std::endl;
-        }
-        else if (data[index] == 'l')
-        {
-            decoded[key] = encodeBencodedList(decodeBencodedList(data, index)); //!> Recursively decode list
-            std::cout << "Decoded List for key: " << key << std::endl;
-        }
-        else
-        {
-            throw std::runtime_error("Unsupported bencoded format");
-        }
+        decoded.emplace(std::string(it.key()), flattenBencodedValue(*it));
     }
 
-    if (index >= data.length() || data[index] != 'e')
-        throw std::runtime_error("Dictionary not properly terminated");
-
-    index++; // Skip 'e'
+    index += document.bytesConsumed();
     return decoded;
 }
 
@@ -76,36 +74,22 @@ std::unordered_map<std::string, std::string> TorrentUtilities::decodeBencodedDat
 */
 std::vector<std::string> TorrentUtilities::decodeBencodedList(const std::string &data, size_t &index)
 {
-    if (data[index] != 'l')
+    if (index >= data.length() || data[index] != 'l')
         throw std::runtime_error("Invalid list format");
 
+    BencodeDocument document;
+    document.parse(std::string_view(data).substr(index));
+
+    BencodeValue root = document.root();
     std::vector<std::string> decodedList;
-    index++; //!> Skip 'l'
+    decodedList.reserve(root.size());
 
-    while (index < data.length() && data[index] != 'e')
+    for (BencodeValue item : root)
     {
-        if (std::isdigit(data[index]))
-        {
-            decodedList.push_back(decodeBencodedString(data, index));
-        }
-        else if (data[index] == 'd')
-        {
-            decodedList.push_back(encodeBencodedData(decodeBencodedData(data, index))); //!> decode dictionary
-        }
-        else if (data[index] == 'l')
-        {
-            decodedList.push_back(encodeBencodedList(decodeBencodedList(data, index))); //!> decode list
-        }
-        else
-        {
-            throw std::runtime_error("Invalid bencoded list format");
-        }
+        decodedList.push_back(flattenBencodedValue(item));
     }
 
-    if (index >= data.length() || data[index] != 'e')
-        throw std::runtime_error("List not properly terminated");
-
-    index++; //!> Skip 'e'
+    index += document.bytesConsumed();
     return decodedList;
 }
 
@@ -117,23 +101,14 @@ std::vector<std::string> TorrentUtilities::decodeBencodedList(const std::string
 */
 std::string TorrentUtilities::decodeBencodedString(const std::string &data, size_t &index)
 {
-    if (!std::isdigit(data[index]))
+    if (index >= data.length() || !std::isdigit(static_cast<unsigned char>(data[index])))
         throw std::runtime_error("Invalid string format");
 
-    size_t colonPos = data.find(':', index);
-    if (colonPos == std::string::npos)
-        throw std::runtime_error("Malformed bencoded string");
-
-    size_t strLen = std::stoul(data.substr(index, colonPos - index));
-    index = colonPos + 1;
-
-    if (index + strLen > data.length())
-        throw std::runtime_error("String length exceeds data size");
-
-    std::string value = data.substr(index, strLen);
-    index += strLen;
+    BencodeDocument document;
+    document.parse(std::string_view(data).substr(index));
 
-    return value;
+    index += document.bytesConsumed();
+    return std::string(document.root().asString());
 }
 
 /*!
@@ -148,23 +123,26 @@ std::unordered_map<std::string, std::string> TorrentUtilities::decodeBencodedDat
 }
 
 /*!
-    \brief Encodes a dictionary into bencoded format.
+    \brief Encodes a dictionary into bencoded format with keys in sorted order.
     \param data The dictionary to encode.
     \return The bencoded string.
 */
 std::string TorrentUtilities::encodeBencodedData(const std::unordered_map<std::string, std::string> &data)
 {
-    std::ostringstream encoded;
-    encoded << "d";
+    std::vector<std::pair<std::string_view, std::string_view>> items;
+    items.reserve(data.size());
 
+    size_t encodedSize = 2; //!> 'd' and 'e'
     for (const auto &pair : data)
     {
-        encoded << pair.first.length() << ":" << pair.first;
-        encoded << pair.second.length() << ":" << pair.second;
+        items.emplace_back(pair.first, pair.second);
+        encodedSize += BencodeWriter::encodedStringSize(pair.first.size()) + BencodeWriter::encodedStringSize(pair.second.size());
     }
 
-    encoded << "e";
-    return encoded.str();
+    std::string encoded(encodedSize, '\0');
+    BencodeWriter writer(encoded.data(), encoded.size());
+    writer.dictionary(items.data(), items.size());
+    return encoded;
 }
 
 /*!
@@ -174,14 +152,99 @@ std::string TorrentUtilities::encodeBencodedData(const std::unordered_map<std::s
 */
 std::string TorrentUtilities::encodeBencodedList(const std::vector<std::string> &data)
 {
-    std::ostringstream encoded;
-    encoded << "l";
+    size_t encodedSize = 2; //!> 'l' and 'e'
+    for (const auto &item : data)
+    {
+        encodedSize += BencodeWriter::encodedStringSize(item.size());
+    }
 
+    std::string encoded(encodedSize, '\0');
+    BencodeWriter writer(encoded.data(), encoded.size());
+    writer.beginList();
     for (const auto &item : data)
     {
-        encoded << item.length() << ":" << item;
+        writer.string(item);
     }
+    writer.end();
+    return encoded;
+}
 
-    encoded << "e";
-    return encoded.str();
+/*!
+    \brief Converts a magnet info hash (40 hex or 32 base32 characters) to its 20 raw bytes.
+    \param infoHash The info hash from the magnet link.
+    \return The raw info hash.
+*/
+std::array<uint8_t, 20> TorrentUtilities::infoHashToBytes(const std::string &infoHash)
+{
+    std::array<uint8_t, 20> bytes{};
+
+    if (infoHash.size() == 40)
+    {
+        auto nibble = [](char c) -> int
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            throw std::runtime_error("Invalid hex digit in info hash");
+        };
+
+        for (size_t i = 0; i < bytes.size(); ++i)
+        {
+            bytes[i] = static_cast<uint8_t>((nibble(infoHash[i * 2]) << 4) | nibble(infoHash[i * 2 + 1]));
+        }
+        return bytes;
+    }
+
+    if (infoHash.size() == 32)
+    {
+        uint32_t buffer = 0;
+        int bits = 0;
+        size_t out = 0;
+        for (char c : infoHash)
+        {
+            int value;
+            if (c >= 'A' && c <= 'Z')
+                value = c - 'A';
+            else if (c >= 'a' && c <= 'z')
+                value = c - 'a';
+            else if (c >= '2' && c <= '7')
+                value = c - '2' + 26;
+            else
+                throw std::runtime_error("Invalid base32 digit in info hash");
+
+            buffer = (buffer << 5) | static_cast<uint32_t>(value);
+            bits += 5;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                bytes[out++] = static_cast<uint8_t>(buffer >> bits);
+            }
+        }
+        return bytes;
+    }
+
+    throw std::runtime_error("Info hash must be 40 hex or 32 base32 characters");
+}
+
+/*!
+    \brief Our peer ID for this process.
+    \return The same 20 bytes on every call.
+*/
+const std::array<uint8_t, 20> &TorrentUtilities::localPeerId()
+{
+    static const std::array<uint8_t, 20> peerId = []()
+    {
+        std::array<uint8_t, 20> id{};
+        std::memcpy(id.data(), "-ML0100-", 8);
+        std::random_device rd;
+        for (size_t i = 8; i < id.size(); ++i)
+        {
+            id[i] = static_cast<uint8_t>(rd());
+        }
+        return id;
+    }();
+    return peerId;
 }
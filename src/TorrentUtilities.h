@@ -16,6 +16,8 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <array>
+#include <cstdint>
 
 class TorrentUtilities
 {
@@ -28,7 +30,7 @@ public:
     static std::unordered_map<std::string, std::string> decodeBencodedData(const std::string &data);
 
     /*!
-        \brief Encodes a dictionary into bencoded format.
+        \brief Encodes a dictionary into bencoded format with keys in sorted order.
         \param data The dictionary to encode.
         \return The bencoded string.
     */
@@ -64,6 +66,19 @@ public:
         \return The decoded string.
     */
     static std::string decodeBencodedString(const std::string &data, size_t &index);
+
+    /*!
+        \brief Converts a magnet info hash (40 hex or 32 base32 characters) to its 20 raw bytes.
+        \param infoHash The info hash from the magnet link.
+        \return The raw info hash.
+    */
+    static std::array<uint8_t, 20> infoHashToBytes(const std::string &infoHash);
+
+    /*!
+        \brief Our peer ID for this process (Azureus style, "-ML0100-" plus 12 random bytes).
+        \return The same 20 bytes on every call.
+    */
+    static const std::array<uint8_t, 20> &localPeerId();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,615 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\UdpTrackerClient.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 17:19:22
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "UdpTrackerClient.h"
+#include <stdexcept>
+#include <cstring>
+#include <random>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#endif
+
+#define UDP_TRACKER_PROTOCOL_ID 0x41727101980ULL
+#define ACTION_CONNECT 0
+#define ACTION_ANNOUNCE 1
+#define ACTION_SCRAPE 2
+#define ACTION_ERROR 3
+#define CONNECT_REQUEST_SIZE 16
+#define ANNOUNCE_REQUEST_SIZE 98
+#define ANNOUNCE_HEADER_SIZE 20
+#define SCRAPE_HEADER_SIZE 16
+#define SCRAPE_RECORD_SIZE 12
+#define RESOLVE_POLL_INTERVAL 50 //!> ms between checks while a tracker name resolves or a connect is shared
+
+/*!
+    \brief Write a big-endian integer.
+    \param out Destination.
+    \param value The value.
+    \param size Bytes to write (4 or 8).
+*/
+static void writeBigEndian(char *out, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        out[i] = static_cast<char>(value >> (8 * (size - 1 - i)));
+    }
+}
+
+/*!
+    \brief Read a big-endian integer.
+    \param data Source.
+    \param size Bytes to read (4 or 8).
+    \return The value.
+*/
+static uint64_t readBigEndian(const char *data, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        value = (value << 8) | static_cast<uint8_t>(data[i]);
+    }
+    return value;
+}
+
+/*!
+    \brief Creates the client and its socket.
+    \param initialTimeout Wait before the first resend.
+    \param maxAttempts Sends per request before the tracker is given up on.
+    \param resolver Resolver for tracker hostnames.
+*/
+UdpTrackerClient::UdpTrackerClient(std::chrono::milliseconds initialTimeout, int maxAttempts, HostResolver &resolver)
+    : initialTimeout(initialTimeout), maxAttempts(maxAttempts), resolver(resolver)
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        throw std::runtime_error("WSAStartup failed");
+    }
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock == INVALID_SOCKET)
+    {
+        WSACleanup();
+        throw std::runtime_error("Failed to create tracker socket");
+    }
+    u_long nonBlocking = 1;
+    ioctlsocket(sock, FIONBIO, &nonBlocking);
+#else
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0)
+    {
+        throw std::runtime_error("Failed to create tracker socket");
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    std::random_device rd;
+    nextTransaction = rd();
+}
+
+/*!
+    \brief Closes the socket.
+*/
+UdpTrackerClient::~UdpTrackerClient()
+{
+    closeSocket();
+}
+
+/*!
+    \brief The process-wide client, created on first use.
+    \return The shared client.
+*/
+UdpTrackerClient &UdpTrackerClient::shared()
+{
+    static UdpTrackerClient client;
+    return client;
+}
+
+/*!
+    \brief Closes the socket.
+*/
+void UdpTrackerClient::closeSocket()
+{
+#ifdef _WIN32
+    if (sock != INVALID_SOCKET)
+    {
+        closesocket(sock);
+        WSACleanup();
+        sock = INVALID_SOCKET;
+    }
+#else
+    if (sock >= 0)
+    {
+        close(sock);
+        sock = -1;
+    }
+#endif
+}
+
+/*!
+    \brief Pack an IPv4 address and port into one key.
+    \param address The address.
+    \return The key.
+*/
+uint64_t UdpTrackerClient::addressKey(const sockaddr_in &address)
+{
+    return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+/*!
+    \brief Wait until the socket is readable.
+    \param timeout Longest wait.
+    \return True if a datagram is waiting.
+*/
+bool UdpTrackerClient::waitReadable(std::chrono::milliseconds timeout)
+{
+    int waitMs = static_cast<int>(std::max<int64_t>(0, timeout.count()));
+#ifdef _WIN32
+    WSAPOLLFD entry{};
+    entry.fd = sock;
+    entry.events = POLLRDNORM;
+    return WSAPoll(&entry, 1, waitMs) > 0;
+#else
+    pollfd entry{};
+    entry.fd = sock;
+    entry.events = POLLIN;
+    return ::poll(&entry, 1, waitMs) > 0;
+#endif
+}
+
+/*!
+    \brief Mark an exchange finished.
+    \param exchange The exchange.
+    \param error Failure reason (empty on success).
+*/
+void UdpTrackerClient::finish(Exchange &exchange, const std::string &error)
+{
+    if (exchange.stage == Stage::Connecting)
+    {
+        connecting.erase(addressKey(exchange.address)); //!> Let a waiting exchange connect instead
+    }
+    exchange.stage = Stage::Done;
+    exchange.response.ok = error.empty();
+    exchange.response.error = error;
+}
+
+/*!
+    \brief Send (or resend) a connect request.
+    \param exchange The exchange.
+    \param now The current time.
+*/
+void UdpTrackerClient::sendConnect(Exchange &exchange, Clock::time_point now)
+{
+    if (exchange.stage != Stage::Connecting)
+    {
+        exchange.stage = Stage::Connecting;
+        exchange.attempts = 0;
+        connecting.insert(addressKey(exchange.address));
+    }
+    exchange.transaction = nextTransaction++;
+
+    char packet[CONNECT_REQUEST_SIZE];
+    writeBigEndian(packet, UDP_TRACKER_PROTOCOL_ID, 8);
+    writeBigEndian(packet + 8, ACTION_CONNECT, 4);
+    writeBigEndian(packet + 12, exchange.transaction, 4);
+
+    if (sendto(sock, packet, sizeof(packet), 0, reinterpret_cast<const sockaddr *>(&exchange.address), sizeof(exchange.address)) < 0)
+    {
+        finish(exchange, "Failed to send connect request");
+        return;
+    }
+    exchange.deadline = now + initialTimeout * (1 << exchange.attempts);
+    exchange.attempts++;
+}
+
+/*!
+    \brief Send (or resend) the exchange's announce or scrape request.
+    \param exchange The exchange.
+    \param now The current time.
+*/
+void UdpTrackerClient::sendRequest(Exchange &exchange, Clock::time_point now)
+{
+    if (exchange.stage != Stage::Requesting)
+    {
+        exchange.stage = Stage::Requesting;
+        exchange.attempts = 0;
+    }
+    exchange.transaction = nextTransaction++;
+
+    char packet[SCRAPE_HEADER_SIZE + SCRAPE_BATCH * 20];
+    size_t length;
+    writeBigEndian(packet, exchange.connectionId, 8);
+    writeBigEndian(packet + 12, exchange.transaction, 4);
+    if (exchange.announce != nullptr)
+    {
+        const TrackerAnnounce &request = *exchange.announce;
+        writeBigEndian(packet + 8, ACTION_ANNOUNCE, 4);
+        std::memcpy(packet + 16, request.infoHash.data(), 20);
+        std::memcpy(packet + 36, request.peerId.data(), 20);
+        writeBigEndian(packet + 56, request.downloaded, 8);
+        writeBigEndian(packet + 64, request.left, 8);
+        writeBigEndian(packet + 72, request.uploaded, 8);
+        writeBigEndian(packet + 80, request.event, 4);
+        writeBigEndian(packet + 84, 0, 4); //!> IP: let the tracker use the source address
+        writeBigEndian(packet + 88, static_cast<uint32_t>(request.peerId[19] | (request.peerId[18] << 8)), 4);
+        writeBigEndian(packet + 92, static_cast<uint32_t>(request.numWant), 4);
+        packet[96] = static_cast<char>(request.port >> 8);
+        packet[97] = static_cast<char>(request.port & 0xFF);
+        length = ANNOUNCE_REQUEST_SIZE;
+    }
+    else
+    {
+        writeBigEndian(packet + 8, ACTION_SCRAPE, 4);
+        std::memcpy(packet + SCRAPE_HEADER_SIZE, exchange.hashes, exchange.hashCount * 20);
+        length = SCRAPE_HEADER_SIZE + exchange.hashCount * 20;
+    }
+
+    if (sendto(sock, packet, static_cast<int>(length), 0, reinterpret_cast<const sockaddr *>(&exchange.address), sizeof(exchange.address)) < 0)
+    {
+        finish(exchange, "Failed to send request");
+        return;
+    }
+    exchange.deadline = now + initialTimeout * (1 << exchange.attempts);
+    exchange.attempts++;
+}
+
+/*!
+    \brief Move an exchange along: start it once its host resolves, and resend or give up on timeouts.
+    \param exchange The exchange.
+    \param now The current time.
+*/
+void UdpTrackerClient::advance(Exchange &exchange, Clock::time_point now)
+{
+    if (exchange.stage == Stage::Resolving)
+    {
+        if (exchange.resolved.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return;
+        }
+        const ResolvedHost &resolved = exchange.resolved.get();
+        if (resolved.addresses.empty())
+        {
+            finish(exchange, "Could not resolve tracker host");
+            return;
+        }
+        exchange.address = resolved.addresses.front();
+        exchange.address.sin_port = htons(exchange.port);
+    }
+    else if (exchange.stage == Stage::Done || (exchange.stage != Stage::Waiting && now < exchange.deadline))
+    {
+        return;
+    }
+    else if (exchange.stage != Stage::Waiting && exchange.attempts >= maxAttempts)
+    {
+        if (exchange.stage == Stage::Connecting)
+        {
+            unreachable.insert(addressKey(exchange.address));
+        }
+        finish(exchange, "Tracker timed out");
+        return;
+    }
+    else if (exchange.stage == Stage::Connecting)
+    {
+        sendConnect(exchange, now);
+        return;
+    }
+
+    //* (Re)send the request straight away while the tracker's connection ID is still fresh,
+    //* otherwise connect, unless another exchange is already connecting to the same tracker
+    uint64_t key = addressKey(exchange.address);
+    auto cached = connections.find(key);
+    if (unreachable.count(key) != 0)
+    {
+        finish(exchange, "Tracker timed out"); //!> Don't retry a dead tracker once per queued request
+    }
+    else if (cached != connections.end() && now - cached->second.obtained < CONNECTION_ID_LIFETIME)
+    {
+        exchange.connectionId = cached->second.id;
+        sendRequest(exchange, now);
+    }
+    else if (connecting.count(key) != 0)
+    {
+        exchange.stage = Stage::Waiting;
+    }
+    else
+    {
+        sendConnect(exchange, now);
+    }
+}
+
+/*!
+    \brief Match a datagram to its exchange and act on it.
+    \param data The datagram.
+    \param length Its size.
+    \param from The sender.
+    \param exchanges All exchanges.
+*/
+void UdpTrackerClient::handlePacket(const char *data, size_t length, const sockaddr_in &from, std::vector<Exchange> &exchanges)
+{
+    if (length < 8)
+    {
+        return;
+    }
+    uint32_t action = static_cast<uint32_t>(readBigEndian(data, 4));
+    uint32_t transaction = static_cast<uint32_t>(readBigEndian(data + 4, 4));
+
+    auto match = std::find_if(exchanges.begin(), exchanges.end(), [&](const Exchange &exchange)
+                              { return (exchange.stage == Stage::Connecting || exchange.stage == Stage::Requesting) &&
+                                       exchange.transaction == transaction &&
+                                       exchange.address.sin_addr.s_addr == from.sin_addr.s_addr &&
+                                       exchange.address.sin_port == from.sin_port; });
+    if (match == exchanges.end())
+    {
+        return; //!> Late reply to a resent request, or not from a tracker we asked
+    }
+    Exchange &exchange = *match;
+    Clock::time_point now = Clock::now();
+    bool isAnnounce = exchange.announce != nullptr;
+
+    if (action == ACTION_ERROR)
+    {
+        connections.erase(addressKey(exchange.address)); //!> Often a stale connection ID
+        finish(exchange, "Tracker error: " + std::string(data + 8, length - 8));
+    }
+    else if (action == ACTION_CONNECT && exchange.stage == Stage::Connecting && length >= 16)
+    {
+        exchange.connectionId = readBigEndian(data + 8, 8);
+        connections[addressKey(exchange.address)] = CachedConnection{exchange.connectionId, now};
+        connecting.erase(addressKey(exchange.address));
+        sendRequest(exchange, now);
+    }
+    else if (action == ACTION_ANNOUNCE && isAnnounce && exchange.stage == Stage::Requesting && length >= ANNOUNCE_HEADER_SIZE)
+    {
+        TrackerResponse &response = exchange.response;
+        response.interval = static_cast<uint32_t>(readBigEndian(data + 8, 4));
+        response.leechers = static_cast<uint32_t>(readBigEndian(data + 12, 4));
+        response.seeders = static_cast<uint32_t>(readBigEndian(data + 16, 4));
+        for (size_t offset = ANNOUNCE_HEADER_SIZE; offset + PeerEndpoint::COMPACT_V4_SIZE <= length; offset += PeerEndpoint::COMPACT_V4_SIZE)
+        {
+            response.peers.push_back(PeerEndpoint::fromCompact(std::string_view(data + offset, PeerEndpoint::COMPACT_V4_SIZE)));
+        }
+        finish(exchange, "");
+    }
+    else if (action == ACTION_SCRAPE && !isAnnounce && exchange.stage == Stage::Requesting)
+    {
+        //* One 12-byte record per hash, in request order: seeders, completed, leechers
+        for (size_t i = 0; i < exchange.hashCount && 8 + (i + 1) * SCRAPE_RECORD_SIZE <= length; ++i)
+        {
+            const char *record = data + 8 + i * SCRAPE_RECORD_SIZE;
+            exchange.table->record(exchange.firstIndex + i,
+                                   static_cast<uint32_t>(readBigEndian(record, 4)),
+                                   static_cast<uint32_t>(readBigEndian(record + 4, 4)),
+                                   static_cast<uint32_t>(readBigEndian(record + 8, 4)));
+        }
+        finish(exchange, "");
+    }
+}
+
+/*!
+    \brief Drive exchanges until every one is done.
+    \param exchanges The exchanges.
+    \param onDone Called once as each exchange finishes; it may reuse the slot for a new exchange.
+*/
+void UdpTrackerClient::run(std::vector<Exchange> &exchanges, const std::function<void(Exchange &exchange)> &onDone)
+{
+    unreachable.clear();
+    char packet[MAX_PACKET];
+    while (true)
+    {
+        Clock::time_point now = Clock::now();
+        Clock::time_point wakeAt = now + initialTimeout * (1 << maxAttempts);
+        bool pending = false;
+
+        for (Exchange &exchange : exchanges)
+        {
+            advance(exchange, now);
+            while (exchange.stage == Stage::Done && !exchange.reported)
+            {
+                exchange.reported = true;
+                onDone(exchange);
+                advance(exchange, now);
+            }
+
+            if (exchange.stage == Stage::Resolving || exchange.stage == Stage::Waiting)
+            {
+                wakeAt = std::min(wakeAt, now + std::chrono::milliseconds(RESOLVE_POLL_INTERVAL));
+            }
+            else if (exchange.stage != Stage::Done)
+            {
+                wakeAt = std::min(wakeAt, exchange.deadline);
+            }
+            pending = pending || exchange.stage != Stage::Done;
+        }
+        if (!pending)
+        {
+            break;
+        }
+
+        if (!waitReadable(std::chrono::duration_cast<std::chrono::milliseconds>(wakeAt - now) + std::chrono::milliseconds(1)))
+        {
+            continue;
+        }
+
+        while (true)
+        {
+            sockaddr_in from{};
+            socklen_t fromLen = sizeof(from);
+            int received = recvfrom(sock, packet, sizeof(packet), 0, reinterpret_cast<sockaddr *>(&from), &fromLen);
+            if (received < 0)
+            {
+                break; //!> Would block (or a transient ICMP error)
+            }
+            handlePacket(packet, static_cast<size_t>(received), from, exchanges);
+        }
+    }
+}
+
+/*!
+    \brief Announce to every udp:// tracker in the list at once and wait for all of them.
+    \param trackers Tracker URLs.
+    \param request The announce.
+    \return One response per udp:// tracker, in list order.
+*/
+std::vector<TrackerResponse> UdpTrackerClient::announce(const std::vector<std::string> &trackers, const TrackerAnnounce &request)
+{
+    std::lock_guard<std::mutex> lock(busy);
+    std::vector<Exchange> exchanges;
+    for (const std::string &url : trackers)
+    {
+        if (url.compare(0, 6, "udp://") != 0)
+        {
+            continue;
+        }
+
+        Exchange exchange;
+        exchange.response.tracker = url;
+        exchange.announce = &request;
+        std::string host;
+        if (!HostResolver::splitUrl(url, host, exchange.port))
+        {
+            finish(exchange, "Invalid tracker URL");
+        }
+        else
+        {
+            exchange.resolved = resolver.resolve(host);
+        }
+        exchanges.push_back(std::move(exchange));
+    }
+
+    run(exchanges, [](Exchange &) {});
+
+    std::vector<TrackerResponse> responses;
+    responses.reserve(exchanges.size());
+    for (Exchange &exchange : exchanges)
+    {
+        responses.push_back(std::move(exchange.response));
+    }
+    return responses;
+}
+
+/*!
+    \brief Scrape swarm counts for many info hashes from every udp:// tracker in the list.
+    \param trackers Tracker URLs; other schemes are skipped.
+    \param infoHashes The torrents.
+    \param table Receives the counts, indexed like infoHashes.
+    \param maxInFlight Scrape requests outstanding at once.
+    \return Number of scrape requests that failed.
+    \throws std::invalid_argument if the table has fewer rows than infoHashes.
+*/
+size_t UdpTrackerClient::scrape(const std::vector<std::string> &trackers, const std::vector<std::array<uint8_t, 20>> &infoHashes,
+                                ScrapeTable &table, size_t maxInFlight)
+{
+    if (table.size() < infoHashes.size())
+    {
+        throw std::invalid_argument("Scrape table has fewer rows than info hashes");
+    }
+    std::lock_guard<std::mutex> lock(busy);
+    struct Target
+    {
+        const std::string *url;
+        uint16_t port;
+        std::shared_future<ResolvedHost> resolved;
+    };
+
+    std::vector<Target> targets;
+    for (const std::string &url : trackers)
+    {
+        std::string host;
+        uint16_t port;
+        if (url.compare(0, 6, "udp://") == 0 && HostResolver::splitUrl(url, host, port))
+        {
+            targets.push_back(Target{&url, port, resolver.resolve(host)});
+        }
+    }
+    if (targets.empty() || infoHashes.empty())
+    {
+        return 0;
+    }
+
+    //* Batch-major order spreads consecutive requests over every tracker
+    size_t batches = (infoHashes.size() + SCRAPE_BATCH - 1) / SCRAPE_BATCH;
+    size_t total = batches * targets.size();
+    size_t nextRequest = 0;
+    auto assign = [&](Exchange &exchange)
+    {
+        if (nextRequest == total)
+        {
+            return false;
+        }
+        size_t batch = nextRequest / targets.size();
+        const Target &target = targets[nextRequest % targets.size()];
+        nextRequest++;
+
+        exchange = Exchange{};
+        exchange.response.tracker = *target.url;
+        exchange.port = target.port;
+        exchange.resolved = target.resolved;
+        exchange.firstIndex = batch * SCRAPE_BATCH;
+        exchange.hashCount = std::min(SCRAPE_BATCH, infoHashes.size() - exchange.firstIndex);
+        exchange.hashes = &infoHashes[exchange.firstIndex];
+        exchange.table = &table;
+        return true;
+    };
+
+    std::vector<Exchange> exchanges;
+    exchanges.reserve(std::min(std::max<size_t>(maxInFlight, 1), total));
+    while (exchanges.size() < std::max<size_t>(maxInFlight, 1))
+    {
+        Exchange exchange;
+        if (!assign(exchange))
+        {
+            break;
+        }
+        exchanges.push_back(std::move(exchange));
+    }
+
+    size_t failed = 0;
+    run(exchanges, [&](Exchange &exchange)
+        {
+        if (!exchange.response.ok)
+        {
+            failed++;
+        }
+        assign(exchange); });
+    return failed;
+}
+
+/*!
+    \brief Merge the peer lists of several responses, dropping duplicates.
+    \param responses The responses.
+    \return Each peer once.
+*/
+std::vector<PeerEndpoint> UdpTrackerClient::mergePeers(const std::vector<TrackerResponse> &responses)
+{
+    std::vector<PeerEndpoint> peers;
+    PeerEndpointSet seen;
+    for (const TrackerResponse &response : responses)
+    {
+        for (const PeerEndpoint &peer : response.peers)
+        {
+            if (seen.insert(peer))
+            {
+                peers.push_back(peer);
+            }
+        }
+    }
+    return peers;
+}
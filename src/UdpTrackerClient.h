@@ -0,0 +1,206 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\UdpTrackerClient.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Saturday October 17th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sat October 17th 2026 17:18:40
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef UDP_TRACKER_CLIENT_H
+#define UDP_TRACKER_CLIENT_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+#include <array>
+#include <string>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <cstdint>
+#include "HostResolver.h"
+#include "PeerEndpoint.h"
+#include "ScrapeTable.h"
+
+/*!
+    \brief What we tell trackers in an announce.
+*/
+struct TrackerAnnounce
+{
+    std::array<uint8_t, 20> infoHash{}; //!> The torrent.
+    std::array<uint8_t, 20> peerId{};   //!> Our peer ID.
+    uint16_t port = 0;                  //!> Port we accept peer connections on.
+    uint64_t downloaded = 0;            //!> Bytes downloaded so far.
+    uint64_t left = 0;                  //!> Bytes still needed.
+    uint64_t uploaded = 0;              //!> Bytes uploaded so far.
+    uint32_t event = 0;                 //!> 0 none, 1 completed, 2 started, 3 stopped.
+    int32_t numWant = -1;               //!> Peers wanted (-1 for the tracker's default).
+};
+
+/*!
+    \brief One tracker's answer to an announce.
+*/
+struct TrackerResponse
+{
+    std::string tracker;             //!> Tracker URL.
+    bool ok = false;                 //!> True if the tracker answered the announce.
+    std::string error;               //!> Failure reason when !ok.
+    uint32_t interval = 0;           //!> Seconds until the next regular announce.
+    uint32_t leechers = 0;           //!> Incomplete peers the tracker knows of.
+    uint32_t seeders = 0;            //!> Complete peers the tracker knows of.
+    std::vector<PeerEndpoint> peers; //!> Peers returned.
+};
+
+/*!
+    \brief UDP tracker client (BEP 15).
+    Announces to many trackers at once from a single socket: every tracker runs its own
+    connect/announce exchange and a request that goes unanswered is resent after
+    initialTimeout, doubling each time, up to maxAttempts sends. Connection IDs are cached
+    per tracker address for CONNECTION_ID_LIFETIME, so repeated announces skip the
+    connect round trip, and requests queued behind a connect to the same tracker wait for
+    its connection ID rather than each sending their own. Thread-safe: concurrent announces
+    and scrapes take turns on the socket.
+*/
+class UdpTrackerClient
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::seconds CONNECTION_ID_LIFETIME{60}; //!> How long a connection ID may be reused.
+    static constexpr size_t MAX_PACKET = 2048;                        //!> Largest datagram read (~330 peers).
+    static constexpr size_t SCRAPE_BATCH = 74;                        //!> Info hashes per scrape request (protocol maximum).
+
+    /*!
+        \brief Creates the client and its socket.
+        \param initialTimeout Wait before the first resend.
+        \param maxAttempts Sends per request before the tracker is given up on.
+        \param resolver Resolver for tracker hostnames.
+        \throws std::runtime_error if the socket cannot be created.
+    */
+    explicit UdpTrackerClient(std::chrono::milliseconds initialTimeout = std::chrono::milliseconds(3000), int maxAttempts = 4,
+                              HostResolver &resolver = HostResolver::shared());
+
+    /*!
+        \brief Closes the socket.
+    */
+    ~UdpTrackerClient();
+
+    UdpTrackerClient(const UdpTrackerClient &) = delete;
+    UdpTrackerClient &operator=(const UdpTrackerClient &) = delete;
+
+    /*!
+        \brief The process-wide client, created on first use.
+        Every torrent announces through it, so re-announces and other torrents reuse its
+        cached connection IDs.
+        \return The shared client.
+    */
+    static UdpTrackerClient &shared();
+
+    /*!
+        \brief Announce to every udp:// tracker in the list at once and wait for all of them.
+        Other schemes are skipped.
+        \param trackers Tracker URLs.
+        \param request The announce.
+        \return One response per udp:// tracker, in list order.
+    */
+    std::vector<TrackerResponse> announce(const std::vector<std::string> &trackers, const TrackerAnnounce &request);
+
+    /*!
+        \brief Scrape swarm counts for many info hashes from every udp:// tracker in the list.
+        Hashes go out SCRAPE_BATCH per request; requests for all trackers are interleaved and
+        at most maxInFlight are outstanding at once. Each reply is merged into the table as it
+        arrives.
+        \param trackers Tracker URLs; other schemes are skipped.
+        \param infoHashes The torrents.
+        \param table Receives the counts, indexed like infoHashes (must have at least as many rows).
+        \param maxInFlight Scrape requests outstanding at once.
+        \return Number of scrape requests that failed.
+        \throws std::invalid_argument if the table has fewer rows than infoHashes.
+    */
+    size_t scrape(const std::vector<std::string> &trackers, const std::vector<std::array<uint8_t, 20>> &infoHashes,
+                  ScrapeTable &table, size_t maxInFlight = 64);
+
+    /*!
+        \brief Merge the peer lists of several responses, dropping duplicates.
+        \param responses The responses.
+        \return Each peer once.
+    */
+    static std::vector<PeerEndpoint> mergePeers(const std::vector<TrackerResponse> &responses);
+
+private:
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+#else
+    using SocketHandle = int;
+#endif
+
+    enum class Stage : uint8_t
+    {
+        Resolving,
+        Waiting,
+        Connecting,
+        Requesting,
+        Done
+    };
+
+    struct Exchange
+    {
+        TrackerResponse response;                        //!> Announce result, or the failure reason.
+        const TrackerAnnounce *announce = nullptr;       //!> Announce to send, or nullptr for a scrape.
+        const std::array<uint8_t, 20> *hashes = nullptr; //!> First info hash of a scrape batch.
+        size_t firstIndex = 0;                           //!> Table row of the first hash.
+        size_t hashCount = 0;                            //!> Hashes in the scrape batch.
+        ScrapeTable *table = nullptr;                    //!> Destination for scrape counts.
+        std::shared_future<ResolvedHost> resolved;       //!> Hostname resolution.
+        uint16_t port = 0;                               //!> Tracker port.
+        sockaddr_in address{};                           //!> Tracker address once resolved.
+        Stage stage = Stage::Resolving;                  //!> Where the exchange is.
+        uint32_t transaction = 0;                        //!> Transaction ID of the outstanding request.
+        uint64_t connectionId = 0;                       //!> Connection ID for requests.
+        int attempts = 0;                                //!> Sends of the current request.
+        Clock::time_point deadline;                      //!> When to resend.
+        bool reported = false;                           //!> Completion already handed to run()'s callback.
+    };
+
+    struct CachedConnection
+    {
+        uint64_t id;                //!> Connection ID.
+        Clock::time_point obtained; //!> When the tracker issued it.
+    };
+
+    SocketHandle sock;                                          //!> The one UDP socket.
+    std::chrono::milliseconds initialTimeout;                   //!> First resend delay.
+    int maxAttempts;                                            //!> Sends per request.
+    HostResolver &resolver;                                     //!> Tracker hostname resolver.
+    std::unordered_map<uint64_t, CachedConnection> connections; //!> Connection IDs by tracker address.
+    std::unordered_set<uint64_t> connecting;                    //!> Tracker addresses with a connect outstanding.
+    std::unordered_set<uint64_t> unreachable;                   //!> Trackers whose connect timed out during this run.
+    uint32_t nextTransaction;                                   //!> Transaction ID counter.
+    std::mutex busy;                                            //!> Held by announce() and scrape() for their whole run.
+
+    void run(std::vector<Exchange> &exchanges, const std::function<void(Exchange &exchange)> &onDone);
+    void advance(Exchange &exchange, Clock::time_point now);
+    void sendConnect(Exchange &exchange, Clock::time_point now);
+    void sendRequest(Exchange &exchange, Clock::time_point now);
+    void handlePacket(const char *data, size_t length, const sockaddr_in &from, std::vector<Exchange> &exchanges);
+    void finish(Exchange &exchange, const std::string &error);
+    bool waitReadable(std::chrono::milliseconds timeout);
+    void closeSocket();
+
+    static uint64_t addressKey(const sockaddr_in &address);
+};
+
+#endif
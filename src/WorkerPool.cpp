@@ -0,0 +1,201 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\WorkerPool.cpp
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Sunday October 18th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sun October 18th 2026 1:09:43
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#include "WorkerPool.h"
+#include <algorithm>
+#include <iostream>
+#include <exception>
+
+static thread_local const WorkerPool *currentPool = nullptr; //!> Pool the calling thread works for, if any
+static thread_local size_t currentWorker = 0;                //!> Its index in that pool
+
+/*!
+    \brief Starts the workers.
+    \param threads Number of workers (0 picks defaultThreads()).
+    \param capacity Most tasks waiting at once (0 picks four per worker).
+*/
+WorkerPool::WorkerPool(size_t threads, size_t capacity)
+{
+    size_t count = threads != 0 ? threads : defaultThreads();
+    this->capacity = capacity != 0 ? capacity : count * 4;
+    for (size_t i = 0; i < count; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        workers[i]->thread = std::thread([this, i]()
+                                         { run(i); });
+    }
+}
+
+/*!
+    \brief Runs every queued task, then stops the workers.
+*/
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    roomReady.notify_all();
+    for (auto &worker : workers)
+    {
+        worker->thread.join();
+    }
+}
+
+/*!
+    \brief Worker count that matches the machine.
+    \return The number of hardware threads (at least 1).
+*/
+size_t WorkerPool::defaultThreads()
+{
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+/*!
+    \brief Queue a task, waiting for room if the pool is at capacity.
+    Workers never wait (they would be waiting on themselves); their tasks go on their own deque.
+    \param task The work.
+*/
+void WorkerPool::submit(Task task)
+{
+    bool fromWorker = currentPool == this;
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!fromWorker && queued >= capacity)
+    {
+        counters.blockedSubmits++;
+        roomReady.wait(lock, [this]()
+                       { return queued < capacity || stopping; });
+    }
+
+    size_t target = fromWorker ? currentWorker : nextWorker++ % workers.size();
+    {
+        std::lock_guard<std::mutex> workerLock(workers[target]->mutex);
+        workers[target]->tasks.push_back(std::move(task));
+    }
+    queued++;
+    counters.peakQueued = std::max(counters.peakQueued, queued);
+    lock.unlock();
+    workReady.notify_one();
+}
+
+/*!
+    \brief Block until every submitted task has finished.
+*/
+void WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this]()
+                 { return queued == 0 && running == 0; });
+}
+
+/*!
+    \brief Get the queue and throughput counters.
+    \return A snapshot.
+*/
+WorkerPoolStats WorkerPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    WorkerPoolStats snapshot = counters;
+    snapshot.threads = workers.size();
+    snapshot.queued = queued;
+    return snapshot;
+}
+
+/*!
+    \brief Take the newest task from our own deque, or else steal the oldest from another.
+    \param self This worker's index.
+    \param task Receives the task.
+    \param stolen Set to true if it came from another worker.
+    \return False if every deque is empty.
+*/
+bool WorkerPool::take(size_t self, Task &task, bool &stolen)
+{
+    {
+        std::lock_guard<std::mutex> lock(workers[self]->mutex);
+        if (!workers[self]->tasks.empty())
+        {
+            task = std::move(workers[self]->tasks.back());
+            workers[self]->tasks.pop_back();
+            stolen = false;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers.size(); ++i)
+    {
+        Worker &victim = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+    \brief Worker loop: run tasks until the pool stops and the queues are empty.
+    \param self This worker's index.
+*/
+void WorkerPool::run(size_t self)
+{
+    currentPool = this;
+    currentWorker = self;
+
+    while (true)
+    {
+        Task task;
+        bool stolen = false;
+        if (take(self, task, stolen))
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queued--;
+                running++;
+                counters.executed++;
+                counters.stolen += stolen ? 1 : 0;
+            }
+            roomReady.notify_one();
+
+            try
+            {
+                task();
+            }
+            catch (const std::exception &ex)
+            {
+                std::cerr << "Worker task failed: " << ex.what() << std::endl;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+            if (queued == 0 && running == 0)
+            {
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping && queued == 0)
+        {
+            break;
+        }
+        workReady.wait(lock, [this]()
+                       { return queued > 0 || stopping; });
+    }
+}
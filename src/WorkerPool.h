@@ -0,0 +1,114 @@
+/*
+ * File: c:\Users\tonyw\Desktop\New folder (2)\src\WorkerPool.h
+ * Project: c:\Users\tonyw\Desktop\New folder (2)\src
+ * Created Date: Sunday October 18th 2026
+ * Author: Tony Wiedman
+ * -----
+ * Last Modified: Sun October 18th 2026 1:02:16
+ * Modified By: Tony Wiedman
+ * -----
+ * Copyright (c) 2026 MolexWorks
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+    \brief Queue and throughput counters for a WorkerPool.
+*/
+struct WorkerPoolStats
+{
+    size_t threads = 0;          //!> Worker threads.
+    size_t queued = 0;           //!> Tasks waiting right now.
+    size_t peakQueued = 0;       //!> Most tasks ever waiting at once.
+    uint64_t executed = 0;       //!> Tasks run.
+    uint64_t stolen = 0;         //!> Tasks run by a worker other than the one they were queued on.
+    uint64_t blockedSubmits = 0; //!> Submits that had to wait for room in the queue.
+};
+
+/*!
+    \brief Fixed set of threads for CPU and disk work (hashing, writing pieces).
+    Each worker has its own deque: it takes its newest task first, and an idle worker steals the
+    oldest task from another worker's deque, so one slow task never holds up the ones queued
+    behind it. Tasks are spread round robin; tasks submitted from a worker stay on its deque.
+    At most `capacity` tasks may wait at once; submit() blocks beyond that, which slows the
+    producer down to the speed of the disk instead of buffering without limit.
+*/
+class WorkerPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /*!
+        \brief Starts the workers.
+        \param threads Number of workers (0 picks defaultThreads()).
+        \param capacity Most tasks waiting at once (0 picks four per worker).
+    */
+    explicit WorkerPool(size_t threads = 0, size_t capacity = 0);
+
+    /*!
+        \brief Runs every queued task, then stops the workers.
+    */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /*!
+        \brief Queue a task, waiting for room if the pool is at capacity.
+        \param task The work; exceptions it throws are caught and logged.
+    */
+    void submit(Task task);
+
+    /*!
+        \brief Block until every submitted task has finished.
+    */
+    void wait();
+
+    /*!
+        \brief Get the queue and throughput counters.
+        \return A snapshot.
+    */
+    WorkerPoolStats stats() const;
+
+    /*!
+        \brief Worker count that matches the machine.
+        \return The number of hardware threads (at least 1).
+    */
+    static size_t defaultThreads();
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;       //!> Guards tasks.
+        std::deque<Task> tasks; //!> Newest at the back.
+        std::thread thread;     //!> The worker thread.
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers; //!> One deque and thread each.
+    size_t capacity;                              //!> Most tasks waiting at once.
+    mutable std::mutex mutex;                     //!> Guards the counters below and the wake-ups.
+    std::condition_variable workReady;            //!> Signalled when a task is queued or on shutdown.
+    std::condition_variable roomReady;            //!> Signalled when a task is taken off a queue.
+    std::condition_variable allDone;              //!> Signalled when the last running task finishes.
+    size_t queued = 0;                            //!> Tasks waiting.
+    size_t running = 0;                           //!> Tasks being run.
+    size_t nextWorker = 0;                        //!> Round-robin target for outside submits.
+    bool stopping = false;                        //!> Set by the destructor.
+    WorkerPoolStats counters;                     //!> Totals (queued and threads filled in by stats()).
+
+    void run(size_t self);
+    bool take(size_t self, Task &task, bool &stolen);
+};
+
+#endif